@@ -24,6 +24,7 @@ import { Font } from "project-editor/features/font/font";
 import { Bitmap } from "project-editor/features/bitmap/bitmap";
 import { Action } from "project-editor/features/action/action";
 import { Variable } from "project-editor/features/variable/variable";
+import type { TextResource } from "project-editor/features/texts";
 import { Flow } from "project-editor/flow/flow";
 import {
     Component,
@@ -62,6 +63,7 @@ import {
 } from "project-editor/build/themes";
 import { buildWidget } from "project-editor/build/widgets";
 import { FlowValue, getValueType } from "project-editor/build/values";
+import { getCanonicalValueKey } from "project-editor/build/value-types";
 import {
     getClassInfo,
     getObjectPathAsString,
@@ -84,7 +86,11 @@ import {
     FIRST_LVGL_WIDGET_COMPONENT_TYPE
 } from "project-editor/flow/components/component-types";
 
-import { DummyDataBuffer, DataBuffer } from "project-editor/build/data-buffer";
+import {
+    DummyDataBuffer,
+    DataBuffer,
+    buildSectionedContainer
+} from "project-editor/build/data-buffer";
 
 import { LVGLBuild } from "project-editor/lvgl/build";
 import { ProjectEditor } from "project-editor/project-editor-interface";
@@ -148,10 +154,7 @@ export class Assets {
     jsonValues: any[] = [];
 
     constants: FlowValue[] = [];
-    constantsMap = new Map<
-        undefined | boolean | number | string | object,
-        number
-    >();
+    constantsMap = new Map<string, number>();
 
     map: AssetsMap = {
         flows: [],
@@ -1061,12 +1064,13 @@ export class Assets {
     }
 
     registerJSONValue(value: any) {
+        // JSON values are mutable at runtime, so they are never shared
         this.jsonValues.push(value);
         return this.jsonValues.length;
     }
 
     getConstantIndex(value: any, valueType: ValueType) {
-        const key = `${valueType}:${value}`;
+        const key = `${valueType}:${getCanonicalValueKey(value)}`;
 
         let index = this.constantsMap.get(key);
         if (index == undefined) {
@@ -1428,16 +1432,25 @@ export class Assets {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+const ASSETS_SECTION_CORE = 0;
+const ASSETS_SECTION_FLOWS = 1;
+const ASSETS_SECTION_TRANSLATIONS = 2;
+const ASSETS_SECTION_LANGUAGE_TRANSLATIONS = 0x100;
+
 function buildHeaderData(
     assets: Assets,
     uncompressedSize: number,
     dataBuffer: DataBuffer,
-    uncompressed: boolean
+    uncompressed: boolean,
+    sectioned: boolean = false
 ) {
     // tag
     // HEADER_TAG = 0x5A45457E
     // HEADER_TAG_COMPRESSED = 0x7A65657E
-    const tag = new TextEncoder().encode(uncompressed ? "~EEZ" : "~eez");
+    // HEADER_TAG_SECTIONED = 0x535A457E
+    const tag = new TextEncoder().encode(
+        uncompressed ? "~EEZ" : sectioned ? "~EZS" : "~eez"
+    );
     dataBuffer.writeUint8Array(tag);
 
     // projectMajorVersion
@@ -1465,28 +1478,50 @@ function buildHeaderData(
     dataBuffer.finalize();
 }
 
-function buildLanguages(assets: Assets, dataBuffer: DataBuffer) {
+function buildLanguages(
+    assets: Assets,
+    dataBuffer: DataBuffer,
+    sectioned: boolean
+) {
     dataBuffer.writeArray(
         assets.projectStore.project.texts?.languages ?? [],
-        language => {
+        (language, languageIndex) => {
             dataBuffer.writeObjectOffset(() => {
                 dataBuffer.writeString(language.languageID);
             });
 
-            dataBuffer.writeArray(
-                assets.projectStore.project.texts.resources,
-                textResource => {
-                    const translation = textResource.translations.find(
-                        translation =>
-                            translation.languageID == language.languageID
-                    );
-                    if (translation) {
-                        dataBuffer.writeString(translation.text ?? "");
-                    } else {
-                        dataBuffer.writeString("");
-                    }
+            const textResources = assets.projectStore.project.texts.resources;
+
+            const buildTranslation = (textResource: TextResource) => {
+                const translation = textResource.translations.find(
+                    translation =>
+                        translation.languageID == language.languageID
+                );
+                if (translation) {
+                    dataBuffer.writeString(translation.text ?? "");
+                } else {
+                    dataBuffer.writeString("");
                 }
-            );
+            };
+
+            if (sectioned && textResources.length > 0) {
+                // translations of each language are in its own lazy section,
+                // so only the selected language is decompressed
+                dataBuffer.writeUint32(textResources.length);
+                dataBuffer.writeSectionObjectOffset(
+                    ASSETS_SECTION_LANGUAGE_TRANSLATIONS + languageIndex,
+                    true,
+                    () => {
+                        for (const textResource of textResources) {
+                            dataBuffer.writeObjectOffset(() =>
+                                buildTranslation(textResource)
+                            );
+                        }
+                    }
+                );
+            } else {
+                dataBuffer.writeArray(textResources, buildTranslation);
+            }
         },
         8
     );
@@ -1498,10 +1533,28 @@ export async function buildGuiAssetsData(
 ) {
     const dataBuffer = new DataBuffer(assets.utf8Support);
 
-    // settings
-    dataBuffer.writeObjectOffset(() => {
-        dataBuffer.writeUint16(assets.map.displayWidth);
-        dataBuffer.writeUint16(assets.map.displayHeight);
+    // Eez-gui pages can add constants and component inputs while they are
+    // written, so only LVGL assets are split into sections.
+    const sectioned = assets.projectStore.projectTypeTraits.isLVGL;
+
+    const writeSection = (
+        id: number,
+        lazy: boolean,
+        callback: () => void
+    ) => {
+        if (sectioned) {
+            dataBuffer.writeSection(id, lazy, callback);
+        } else {
+            callback();
+        }
+    };
+
+    writeSection(ASSETS_SECTION_CORE, false, () => {
+        // settings
+        dataBuffer.writeObjectOffset(() => {
+            dataBuffer.writeUint16(assets.map.displayWidth);
+            dataBuffer.writeUint16(assets.map.displayHeight);
+        });
     });
 
     if (!assets.projectStore.projectTypeTraits.isLVGL) {
@@ -1514,16 +1567,25 @@ export async function buildGuiAssetsData(
         // bitmaps
         await buildGuiBitmapsData(assets, dataBuffer, option);
     }
-    // colorsDefinition
-    buildGuiColors(assets, dataBuffer);
-    // actionNames
-    buildActionNames(assets, dataBuffer);
-    // variableNames
-    buildVariableNames(assets, dataBuffer);
-    // flowDefinition
-    buildFlowData(assets, dataBuffer);
-    // languages
-    buildLanguages(assets, dataBuffer);
+
+    writeSection(ASSETS_SECTION_CORE, false, () => {
+        // colorsDefinition
+        buildGuiColors(assets, dataBuffer);
+        // actionNames
+        buildActionNames(assets, dataBuffer);
+        // variableNames
+        buildVariableNames(assets, dataBuffer);
+    });
+
+    writeSection(ASSETS_SECTION_FLOWS, false, () => {
+        // flowDefinition
+        buildFlowData(assets, dataBuffer);
+    });
+
+    writeSection(ASSETS_SECTION_TRANSLATIONS, false, () => {
+        // languages
+        buildLanguages(assets, dataBuffer, sectioned);
+    });
 
     dataBuffer.finalize();
 
@@ -1591,7 +1653,45 @@ export async function buildGuiAssetsData(
         "Compressed size: " + compressedSize
     );
 
-    return { uncompressedData, compressedData };
+    let sectionedData: Buffer | undefined;
+    if (sectioned) {
+        sectionedData = await buildSectionedData(
+            assets,
+            dataBuffer,
+            uncompressedSize,
+            COMPRESSION_LEVEL_DEFAULT
+        );
+    }
+
+    return { uncompressedData, compressedData, sectionedData };
+}
+
+async function buildSectionedData(
+    assets: Assets,
+    dataBuffer: DataBuffer,
+    uncompressedSize: number,
+    compressionLevel: number
+) {
+    const compressedSections = await dataBuffer.compressSections(
+        compressionLevel
+    );
+
+    const headerBuffer = new DataBuffer(assets.utf8Support);
+    buildHeaderData(assets, uncompressedSize, headerBuffer, false, true);
+
+    const sectionedData = buildSectionedContainer(
+        headerBuffer.buffer.subarray(0, headerBuffer.size),
+        compressedSections,
+        dataBuffer.buildRelocationTable()
+    );
+
+    assets.projectStore.outputSectionsStore.write(
+        Section.OUTPUT,
+        MessageType.INFO,
+        "Sectioned size: " + sectionedData.length
+    );
+
+    return sectionedData;
 }
 
 export async function buildAssets(
@@ -1703,9 +1803,8 @@ export async function buildAssets(
         buildAssetsDataMap
     ) {
         // build all assets as single data chunk
-        const { uncompressedData, compressedData } = await buildGuiAssetsData(
-            assets, option
-        );
+        const { uncompressedData, compressedData, sectionedData } =
+            await buildGuiAssetsData(assets, option);
 
         if (option != "buildAssets") {
             if (
@@ -1722,7 +1821,7 @@ export async function buildAssets(
                 if (buildAssetsDecl) {
                     result.GUI_ASSETS_DECL = buildGuiAssetsDecl(
                         lvglCompressFlowDefinition
-                            ? compressedData
+                            ? sectionedData ?? compressedData
                             : uncompressedData
                     );
                 }
@@ -1735,7 +1834,7 @@ export async function buildAssets(
                 if (buildAssetsDef) {
                     result.GUI_ASSETS_DEF = await buildGuiAssetsDef(
                         lvglCompressFlowDefinition
-                            ? compressedData
+                            ? sectionedData ?? compressedData
                             : uncompressedData
                     );
                 }
@@ -0,0 +1,201 @@
+import { test } from "node:test";
+import assert from "node:assert/strict";
+
+import {
+    DataBuffer,
+    buildSectionedContainer,
+    ASSETS_SECTION_RELOCATIONS,
+    ASSETS_SECTION_FLAG_LAZY,
+    ASSETS_SECTION_FLAG_RELOCATIONS,
+    SECTION_ENTRY_SIZE
+} from "project-editor/build/data-buffer";
+
+function readObjectOffset(dataBuffer: DataBuffer, fieldOffset: number) {
+    return fieldOffset + dataBuffer.buffer.readInt32LE(fieldOffset);
+}
+
+// root fields: core string at 0, flows array at 4 (count) and 8 (items),
+// translations at 12
+function buildSectionedDataBuffer() {
+    const dataBuffer = new DataBuffer(false);
+
+    dataBuffer.writeSection(0, false, () => {
+        dataBuffer.writeObjectOffset(() => dataBuffer.writeString("core"));
+    });
+
+    dataBuffer.writeSection(1, false, () => {
+        dataBuffer.writeArray(["first", "second"], item =>
+            dataBuffer.writeString(item)
+        );
+    });
+
+    dataBuffer.writeSectionObjectOffset(2, true, () => {
+        dataBuffer.writeArray(["a", "b", "c"], item =>
+            dataBuffer.writeString(item)
+        );
+    });
+
+    dataBuffer.finalize();
+
+    return dataBuffer;
+}
+
+test("places every section in its own contiguous range", () => {
+    const dataBuffer = buildSectionedDataBuffer();
+    const sections = dataBuffer.sections;
+
+    assert.deepEqual(sections.map(section => section.id), [0, 1, 2]);
+    assert.equal(sections[0].offset, 0);
+    for (let i = 1; i < sections.length; i++) {
+        assert.equal(sections[i].offset % 8, 0);
+        assert.ok(
+            sections[i].offset >=
+                sections[i - 1].offset + sections[i - 1].size
+        );
+    }
+
+    // items of the flows array are written inside the flows section
+    const flows = sections[1];
+    const itemsOffset = readObjectOffset(dataBuffer, 8);
+    assert.ok(itemsOffset >= flows.offset);
+    for (let i = 0; i < 2; i++) {
+        const itemOffset = readObjectOffset(dataBuffer, itemsOffset + 4 * i);
+        assert.ok(itemOffset >= flows.offset);
+        assert.ok(itemOffset < flows.offset + flows.size);
+    }
+});
+
+test("points the root field of a lazy section at the section", () => {
+    const dataBuffer = buildSectionedDataBuffer();
+    const translations = dataBuffer.sections[2];
+
+    assert.equal(translations.lazy, true);
+    assert.equal(translations.rootFieldOffset, 12);
+    assert.equal(
+        readObjectOffset(dataBuffer, translations.rootFieldOffset),
+        translations.offset
+    );
+    assert.equal(dataBuffer.sections[0].rootFieldOffset, 0);
+});
+
+test("rejects a lazy section with more than one root object", () => {
+    const dataBuffer = new DataBuffer(false);
+    assert.throws(() =>
+        dataBuffer.writeSection(2, true, () => {
+            dataBuffer.writeObjectOffset(() => dataBuffer.writeUint32(1));
+            dataBuffer.writeObjectOffset(() => dataBuffer.writeUint32(2));
+        })
+    );
+});
+
+test("round trips the sectioned container", async () => {
+    const dataBuffer = buildSectionedDataBuffer();
+    const compressedSections = await dataBuffer.compressSections(9);
+    const relocationTable = dataBuffer.buildRelocationTable();
+    const header = Buffer.from("~EZS0123456789ab");
+
+    const data = buildSectionedContainer(
+        header,
+        compressedSections,
+        relocationTable
+    );
+
+    assert.equal(data.length % 4, 0);
+    assert.deepEqual(data.subarray(0, header.length), header);
+
+    const numSections = data.readUInt32LE(header.length);
+    assert.equal(numSections, compressedSections.length + 1);
+
+    const entries = [];
+    for (let i = 0; i < numSections; i++) {
+        const offset = header.length + 4 + i * SECTION_ENTRY_SIZE;
+        entries.push({
+            id: data.readUInt16LE(offset),
+            flags: data.readUInt16LE(offset + 2),
+            offset: data.readUInt32LE(offset + 4),
+            size: data.readUInt32LE(offset + 8),
+            compressedOffset: data.readUInt32LE(offset + 12),
+            compressedSize: data.readUInt32LE(offset + 16),
+            rootFieldOffset: data.readUInt32LE(offset + 20)
+        });
+    }
+
+    compressedSections.forEach(({ section, compressedBuffer }, i) => {
+        const entry = entries[i];
+        assert.equal(entry.id, section.id);
+        assert.equal(entry.flags, section.lazy ? ASSETS_SECTION_FLAG_LAZY : 0);
+        assert.equal(entry.offset, section.offset);
+        assert.equal(entry.size, section.size);
+        assert.equal(entry.rootFieldOffset, section.rootFieldOffset);
+        assert.equal(entry.compressedOffset % 4, 0);
+        assert.deepEqual(
+            data.subarray(
+                entry.compressedOffset,
+                entry.compressedOffset + entry.compressedSize
+            ),
+            compressedBuffer
+        );
+    });
+
+    const relocations = entries[entries.length - 1];
+    assert.equal(relocations.id, ASSETS_SECTION_RELOCATIONS);
+    assert.equal(relocations.flags, ASSETS_SECTION_FLAG_RELOCATIONS);
+    assert.equal(relocations.compressedOffset % 4, 0);
+    assert.deepEqual(
+        data.subarray(
+            relocations.compressedOffset,
+            relocations.compressedOffset + relocations.compressedSize
+        ),
+        relocationTable
+    );
+});
+
+function decodeRelocationTable(table: Buffer) {
+    const count = table.readUInt32LE(0);
+    const offsets: number[] = [];
+    let i = 4;
+    let offset = 0;
+    while (offsets.length < count) {
+        let delta = 0;
+        let shift = 0;
+        let byte;
+        do {
+            byte = table[i++];
+            delta |= (byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        offset += delta * 4;
+        offsets.push(offset);
+    }
+    assert.equal(i, table.length);
+    return offsets;
+}
+
+test("encodes relocations as sorted LEB128 deltas", () => {
+    const dataBuffer = new DataBuffer(false);
+    dataBuffer.relocations = [8, 0, 8, 8 + 4 * 200];
+
+    const table = dataBuffer.buildRelocationTable();
+
+    assert.deepEqual(table, Buffer.from([3, 0, 0, 0, 0x00, 0x02, 0xc8, 0x01]));
+    assert.deepEqual(decodeRelocationTable(table), [0, 8, 808]);
+});
+
+test("records every written object offset field", () => {
+    const dataBuffer = buildSectionedDataBuffer();
+
+    const offsets = decodeRelocationTable(dataBuffer.buildRelocationTable());
+
+    assert.deepEqual(
+        offsets,
+        [...new Set(dataBuffer.relocations)].sort((a, b) => a - b)
+    );
+    // three root fields, the items field of the translations array and
+    // one field per array item
+    assert.equal(offsets.length, 3 + 1 + 2 + 3);
+    for (const offset of offsets) {
+        const target = readObjectOffset(dataBuffer, offset);
+        assert.ok(target > offset);
+        assert.ok(target < dataBuffer.size);
+    }
+});
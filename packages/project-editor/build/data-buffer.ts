@@ -1,4 +1,25 @@
-import { load_lz4_module, compress } from "project-editor/build/lz4";
+import {
+    load_lz4_module,
+    compress,
+    compressBlocks
+} from "project-editor/build/lz4";
+
+const ASSETS_BLOCK_SIZE = 64 * 1024;
+
+export const ASSETS_SECTION_RELOCATIONS = 3;
+
+export const ASSETS_SECTION_FLAG_LAZY = 1 << 0;
+export const ASSETS_SECTION_FLAG_RELOCATIONS = 1 << 1;
+
+export const SECTION_ENTRY_SIZE = 24;
+
+export interface AssetsSection {
+    id: number;
+    lazy: boolean;
+    offset: number;
+    size: number;
+    rootFieldOffset: number;
+}
 
 export class DataBuffer {
     buffer = Buffer.alloc(32 * 1024 * 1024);
@@ -9,6 +30,7 @@ export class DataBuffer {
         currentOffset: number;
         callback: () => void;
         padding: number;
+        flat?: boolean;
     }[] = [];
 
     futureArrayList: {
@@ -16,6 +38,21 @@ export class DataBuffer {
         callback: () => void;
     }[] = [];
 
+    sectionList: {
+        id: number;
+        lazy: boolean;
+        objectList: {
+            currentOffset: number;
+            callback: () => void;
+            padding: number;
+        }[];
+    }[] = [];
+
+    sections: AssetsSection[] = [];
+
+    // offsets of all written AssetsPtr fields
+    relocations: number[] = [];
+
     constructor(public utf8Support: boolean) {}
 
     writeInt8(value: number) {
@@ -140,6 +177,36 @@ export class DataBuffer {
         }
     }
 
+    // Like writeArray, but items are placed in the given order and each item
+    // is immediately followed by all the objects it references.
+    writeFlatArray<T>(
+        arr: T[],
+        order: number[],
+        callback: (item: T, i: number) => void
+    ) {
+        if (this.currentOffset % 4) {
+            throw "invalid offset 14";
+        }
+        if (arr.length > 0) {
+            this.writeUint32(arr.length);
+            this.writeObjectOffset(() => {
+                const itemsOffset = this.currentOffset;
+                for (let i = 0; i < arr.length; i++) {
+                    this.writeUint32(0);
+                }
+                const currentOffset = this.currentOffset;
+                for (const i of order) {
+                    this.currentOffset = itemsOffset + 4 * i;
+                    this.writeObjectOffset(() => callback(arr[i], i), 4, true);
+                }
+                this.currentOffset = currentOffset;
+            });
+        } else {
+            this.writeUint32(0);
+            this.writeUint32(0);
+        }
+    }
+
     writeFutureArray(callback: () => void) {
         if (this.currentOffset % 4) {
             throw "invalid offset 11";
@@ -170,13 +237,22 @@ export class DataBuffer {
         }
     }
 
-    writeObjectOffset(callback: () => void, padding: number = 4) {
+    writeObjectOffset(
+        callback: () => void,
+        padding: number = 4,
+        flat: boolean = false
+    ) {
         if (this.currentOffset % 4) {
             throw "invalid offset 13";
         }
         const currentOffset = this.currentOffset;
         this.writeUint32(0);
-        this.writeLaterObjectList.push({ currentOffset, callback, padding });
+        this.writeLaterObjectList.push({
+            currentOffset,
+            callback,
+            padding,
+            flat
+        });
     }
 
     addPadding() {
@@ -203,34 +279,87 @@ export class DataBuffer {
 
     finalizeObjectList() {
         for (let i = 0; i < this.writeLaterObjectList.length; i++) {
-            const writeLater = this.writeLaterObjectList[i];
+            this.finalizeObject(this.writeLaterObjectList[i]);
+        }
 
-            if (writeLater.padding == 8) {
-                this.addPadding8();
-            }
+        this.writeLaterObjectList = [];
+    }
 
-            const currentOffset = this.currentOffset;
+    finalizeObject(writeLater: {
+        currentOffset: number;
+        callback: () => void;
+        padding: number;
+        flat?: boolean;
+    }) {
+        const firstChild = this.writeLaterObjectList.length;
 
-            writeLater.callback();
+        if (writeLater.padding == 8) {
+            this.addPadding8();
+        }
 
-            if (writeLater.padding == 8) {
-                this.addPadding8();
-            } else {
-                this.addPadding();
-            }
+        const currentOffset = this.currentOffset;
+
+        writeLater.callback();
 
-            this.buffer.writeInt32LE(
-                currentOffset - writeLater.currentOffset,
-                writeLater.currentOffset
-            );
+        if (writeLater.padding == 8) {
+            this.addPadding8();
+        } else {
+            this.addPadding();
         }
 
-        this.writeLaterObjectList = [];
+        this.buffer.writeInt32LE(
+            currentOffset - writeLater.currentOffset,
+            writeLater.currentOffset
+        );
+
+        this.relocations.push(writeLater.currentOffset);
+
+        if (writeLater.flat) {
+            // depth first, instead of appending to the end of the list
+            const children = this.writeLaterObjectList.splice(firstChild);
+            for (const child of children) {
+                child.flat = true;
+                this.finalizeObject(child);
+            }
+        }
     }
 
-    finalize() {
-        this.addPadding();
+    // Objects referenced from the root fields written inside callback are
+    // finalized together, so the section ends up as one contiguous range.
+    // A lazy section must be referenced by exactly one root field, because
+    // runtime loads it into a separate buffer and patches only that field.
+    writeSection(id: number, lazy: boolean, callback: () => void) {
+        const firstObject = this.writeLaterObjectList.length;
+        callback();
+        const objectList = this.writeLaterObjectList.splice(firstObject);
+        const lastSection = this.sectionList[this.sectionList.length - 1];
+        if (lastSection && lastSection.id == id) {
+            lastSection.objectList.push(...objectList);
+        } else {
+            this.sectionList.push({ id, lazy, objectList });
+        }
+        if (lazy && this.sectionList[this.sectionList.length - 1].objectList.length > 1) {
+            throw "lazy section must have single root object";
+        }
+    }
 
+    // Object written by callback, together with all the objects it
+    // references, is placed in its own section. Unlike writeSection, this
+    // can be used for nested objects, with this field as the section root.
+    writeSectionObjectOffset(id: number, lazy: boolean, callback: () => void) {
+        if (this.currentOffset % 4) {
+            throw "invalid offset 15";
+        }
+        const currentOffset = this.currentOffset;
+        this.writeUint32(0);
+        this.sectionList.push({
+            id,
+            lazy,
+            objectList: [{ currentOffset, callback, padding: 4 }]
+        });
+    }
+
+    finalizeObjects() {
         this.finalizeObjectList();
 
         let currentOffset = this.currentOffset;
@@ -239,20 +368,174 @@ export class DataBuffer {
             this.currentOffset = this.futureArrayList[i].currentOffset;
             this.futureArrayList[i].callback();
         }
+        this.futureArrayList = [];
 
         this.currentOffset = currentOffset;
 
         this.finalizeObjectList();
+    }
+
+    finalizeSections() {
+        for (let i = 0; i < this.sectionList.length; i++) {
+            const section = this.sectionList[i];
+
+            if (section.objectList.length == 0) {
+                continue;
+            }
+
+            this.addPadding8();
+
+            const offset =
+                this.sections.length == 0 ? 0 : this.currentOffset;
+
+            this.writeLaterObjectList = section.objectList;
+            this.finalizeObjects();
+
+            this.sections.push({
+                id: section.id,
+                lazy: section.lazy,
+                offset,
+                size: this.currentOffset - offset,
+                rootFieldOffset: section.lazy
+                    ? section.objectList[0].currentOffset
+                    : 0
+            });
+        }
+
+        this.sectionList = [];
+    }
+
+    finalize() {
+        this.addPadding();
+
+        if (this.sectionList.length > 0) {
+            this.finalizeSections();
+        } else {
+            this.finalizeObjects();
+        }
 
         const buffer = Buffer.alloc(this.size);
         this.buffer.copy(buffer, 0, 0, this.size);
         this.buffer = buffer;
     }
 
+    // Relocation table is a count followed by the sorted field offsets,
+    // delta encoded (in 4 byte units) as unsigned LEB128.
+    buildRelocationTable() {
+        const relocations = [...new Set(this.relocations)].sort(
+            (a, b) => a - b
+        );
+
+        const bytes: number[] = [];
+        let previousOffset = 0;
+        for (const offset of relocations) {
+            let delta = (offset - previousOffset) / 4;
+            previousOffset = offset;
+            while (delta >= 0x80) {
+                bytes.push((delta & 0x7f) | 0x80);
+                delta >>>= 7;
+            }
+            bytes.push(delta);
+        }
+
+        const table = Buffer.alloc(4 + bytes.length);
+        table.writeUInt32LE(relocations.length, 0);
+        table.set(bytes, 4);
+        return table;
+    }
+
     async compress(compressionLevel: number) {
         await load_lz4_module();
         return compress(this.buffer, compressionLevel, true);
     }
+
+    async compressSections(compressionLevel: number) {
+        await load_lz4_module();
+        return this.sections.map(section => ({
+            section,
+            ...compressBlocks(
+                this.buffer.subarray(
+                    section.offset,
+                    section.offset + section.size
+                ),
+                ASSETS_BLOCK_SIZE,
+                compressionLevel,
+                true
+            )
+        }));
+    }
+}
+
+// Layout: header, number of sections, section table, then each compressed
+// section and finally the relocation table, all aligned to 4 bytes.
+export function buildSectionedContainer(
+    header: Buffer,
+    compressedSections: {
+        section: AssetsSection;
+        compressedBuffer: Buffer;
+        compressedSize: number;
+    }[],
+    relocationTable: Buffer
+) {
+    const tableSize =
+        4 + (compressedSections.length + 1) * SECTION_ENTRY_SIZE;
+
+    let compressedOffset = header.length + tableSize;
+    const compressedOffsets = compressedSections.map(compressedSection => {
+        const offset = compressedOffset;
+        compressedOffset += compressedSection.compressedSize;
+        compressedOffset = (compressedOffset + 3) & ~3;
+        return offset;
+    });
+
+    const relocationTableOffset = compressedOffset;
+    compressedOffset += relocationTable.length;
+    compressedOffset = (compressedOffset + 3) & ~3;
+
+    const sectionedData = Buffer.alloc(compressedOffset);
+
+    header.copy(sectionedData, 0);
+
+    let offset = header.length;
+    sectionedData.writeUInt32LE(compressedSections.length + 1, offset);
+    offset += 4;
+
+    compressedSections.forEach((compressedSection, i) => {
+        const section = compressedSection.section;
+        sectionedData.writeUInt16LE(section.id, offset);
+        sectionedData.writeUInt16LE(
+            section.lazy ? ASSETS_SECTION_FLAG_LAZY : 0,
+            offset + 2
+        );
+        sectionedData.writeUInt32LE(section.offset, offset + 4);
+        sectionedData.writeUInt32LE(section.size, offset + 8);
+        sectionedData.writeUInt32LE(compressedOffsets[i], offset + 12);
+        sectionedData.writeUInt32LE(
+            compressedSection.compressedSize,
+            offset + 16
+        );
+        sectionedData.writeUInt32LE(section.rootFieldOffset, offset + 20);
+        offset += SECTION_ENTRY_SIZE;
+
+        compressedSection.compressedBuffer.copy(
+            sectionedData,
+            compressedOffsets[i],
+            0,
+            compressedSection.compressedSize
+        );
+    });
+
+    // stored uncompressed, runtime reads it directly from the assets data
+    sectionedData.writeUInt16LE(ASSETS_SECTION_RELOCATIONS, offset);
+    sectionedData.writeUInt16LE(ASSETS_SECTION_FLAG_RELOCATIONS, offset + 2);
+    sectionedData.writeUInt32LE(0, offset + 4);
+    sectionedData.writeUInt32LE(relocationTable.length, offset + 8);
+    sectionedData.writeUInt32LE(relocationTableOffset, offset + 12);
+    sectionedData.writeUInt32LE(relocationTable.length, offset + 16);
+    sectionedData.writeUInt32LE(0, offset + 20);
+    relocationTable.copy(sectionedData, relocationTableOffset);
+
+    return sectionedData;
 }
 
 export class DummyDataBuffer {
@@ -264,6 +547,7 @@ export class DummyDataBuffer {
         currentOffset: number;
         callback: () => void;
         padding: number;
+        flat?: boolean;
     }[] = [];
 
     futureArrayList: {
@@ -271,6 +555,20 @@ export class DummyDataBuffer {
         callback: () => void;
     }[] = [];
 
+    sectionList: {
+        id: number;
+        lazy: boolean;
+        objectList: {
+            currentOffset: number;
+            callback: () => void;
+            padding: number;
+        }[];
+    }[] = [];
+
+    sections: AssetsSection[] = [];
+
+    relocations: number[] = [];
+
     constructor(public utf8Support: boolean) {}
 
     writeInt8(value: number) {}
@@ -317,11 +615,33 @@ export class DummyDataBuffer {
         callback();
     }
 
+    writeFlatArray<T>(
+        arr: T[],
+        order: number[],
+        callback: (item: T, i: number) => void
+    ) {
+        for (const i of order) {
+            callback(arr[i], i);
+        }
+    }
+
     writeNumberArray<T>(arr: T[], callback: (item: T, i: number) => void) {
         arr.forEach((item, i) => callback(item, i));
     }
 
-    writeObjectOffset(callback: () => void, padding: number = 4) {
+    writeObjectOffset(
+        callback: () => void,
+        padding: number = 4,
+        flat: boolean = false
+    ) {
+        callback();
+    }
+
+    writeSection(id: number, lazy: boolean, callback: () => void) {
+        callback();
+    }
+
+    writeSectionObjectOffset(id: number, lazy: boolean, callback: () => void) {
         callback();
     }
 
@@ -331,8 +651,23 @@ export class DummyDataBuffer {
 
     finalizeObjectList() {}
 
+    finalizeObject(writeLater: {
+        currentOffset: number;
+        callback: () => void;
+        padding: number;
+        flat?: boolean;
+    }) {}
+
+    finalizeObjects() {}
+
+    finalizeSections() {}
+
     finalize() {}
 
+    buildRelocationTable() {
+        return Buffer.alloc(4);
+    }
+
     get size() {
         return 0;
     }
@@ -340,4 +675,8 @@ export class DummyDataBuffer {
     async compress(compressionLevel: number) {
         return { compressedBuffer: this.buffer, compressedSize: 0 };
     }
+
+    async compressSections(compressionLevel: number) {
+        return [];
+    }
 }
@@ -91,6 +91,54 @@ function getFlowComponents(flow: Flow) {
     return components;
 }
 
+// Components reachable from the flow entry points, in the order they are
+// expected to be executed, followed by the unreachable ones.
+function getComponentsExecutionOrder(flow: Flow, components: Component[]) {
+    const componentIndexes = new Map<Component, number>();
+    components.forEach((component, i) => componentIndexes.set(component, i));
+
+    const targets = new Map<Component, Component[]>();
+    const hasInputConnection = new Set<Component>();
+    for (const connectionLine of flow.connectionLines) {
+        const sourceComponent = connectionLine.sourceComponent;
+        const targetComponent = connectionLine.targetComponent;
+        if (connectionLine.disabled || !sourceComponent || !targetComponent) {
+            continue;
+        }
+        let sourceTargets = targets.get(sourceComponent);
+        if (!sourceTargets) {
+            sourceTargets = [];
+            targets.set(sourceComponent, sourceTargets);
+        }
+        sourceTargets.push(targetComponent);
+        hasInputConnection.add(targetComponent);
+    }
+
+    const queue = components.filter(
+        component => !hasInputConnection.has(component)
+    );
+    const visited = new Set<number>();
+    const order: number[] = [];
+
+    for (let i = 0; i < queue.length; i++) {
+        const componentIndex = componentIndexes.get(queue[i]);
+        if (componentIndex == undefined || visited.has(componentIndex)) {
+            continue;
+        }
+        visited.add(componentIndex);
+        order.push(componentIndex);
+        queue.push(...(targets.get(queue[i]) ?? []));
+    }
+
+    components.forEach((_, i) => {
+        if (!visited.has(i)) {
+            order.push(i);
+        }
+    });
+
+    return order;
+}
+
 function getComponentIdOfComponent(assets: Assets, component: Component) {
     const classInfo = getClassInfo(component);
     let flowComponentId = classInfo.flowComponentId;
@@ -379,9 +427,17 @@ function buildFlow(assets: Assets, dataBuffer: DataBuffer, flow: Flow) {
     components.sort(
         (a, b) => assets.getComponentIndex(a) - assets.getComponentIndex(b)
     );
-    dataBuffer.writeArray(components, component =>
-        buildComponent(assets, dataBuffer, flow, component)
-    );
+    if (assets.projectStore.project.settings.build.flatComponentLayout) {
+        dataBuffer.writeFlatArray(
+            components,
+            getComponentsExecutionOrder(flow, components),
+            component => buildComponent(assets, dataBuffer, flow, component)
+        );
+    } else {
+        dataBuffer.writeArray(components, component =>
+            buildComponent(assets, dataBuffer, flow, component)
+        );
+    }
 
     // localVariables
     assets.map.flows[flowIndex].localVariables =
@@ -464,6 +520,17 @@ function buildFlow(assets: Assets, dataBuffer: DataBuffer, flow: Flow) {
     });
 }
 
+// Stable across builds as long as the variable is not renamed, so the runtime
+// can carry global variable values over a hot swap of the assets.
+function getGlobalVariableId(name: string) {
+    const bytes = Buffer.from(name, "utf8");
+    let hash = 0x811c9dc5;
+    for (let i = 0; i < bytes.length; i++) {
+        hash = Math.imul(hash ^ bytes[i], 0x01000193);
+    }
+    return hash >>> 0;
+}
+
 export function buildFlowData(assets: Assets, dataBuffer: DataBuffer) {
     if (assets.projectStore.projectTypeTraits.hasFlowSupport) {
         dataBuffer.writeObjectOffset(() => {
@@ -492,19 +559,27 @@ export function buildFlowData(assets: Assets, dataBuffer: DataBuffer) {
                     type: globalVariable.type
                 })
             );
+            const globalVariables = assets.globalVariables.filter(
+                globalVariable =>
+                    !(
+                        (assets.option == "buildFiles" ||
+                            globalVariable.id != undefined) &&
+                        globalVariable.native
+                    ) // only non-native variables
+            );
             dataBuffer.writeArray(
-                assets.globalVariables.filter(
-                    globalVariable =>
-                        !(
-                            (assets.option == "buildFiles" ||
-                                globalVariable.id != undefined) &&
-                            globalVariable.native
-                        ) // only non-native variables
-                ),
+                globalVariables,
                 globalVariable =>
                     buildVariableFlowValue(assets, dataBuffer, globalVariable),
                 8
             );
+
+            // globalVariableIds
+            dataBuffer.writeNumberArray(globalVariables, globalVariable =>
+                dataBuffer.writeUint32(
+                    getGlobalVariableId(globalVariable.fullName)
+                )
+            );
         });
     } else {
         dataBuffer.writeUint32(0);
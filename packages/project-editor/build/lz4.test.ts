@@ -0,0 +1,125 @@
+import { test, before } from "node:test";
+import assert from "node:assert/strict";
+
+import {
+    load_lz4_module,
+    compress,
+    compressBlocks
+} from "project-editor/build/lz4";
+
+// reference LZ4 block decoder, the wasm module only exports the encoder
+function decompressBlock(input: Buffer) {
+    const output: number[] = [];
+    let i = 0;
+
+    const readLength = (length: number) => {
+        if (length == 15) {
+            let byte;
+            do {
+                byte = input[i++];
+                length += byte;
+            } while (byte == 255);
+        }
+        return length;
+    };
+
+    while (i < input.length) {
+        const token = input[i++];
+
+        const literalLength = readLength(token >> 4);
+        for (let j = 0; j < literalLength; j++) {
+            output.push(input[i++]);
+        }
+
+        if (i >= input.length) {
+            break;
+        }
+
+        const matchOffset = input[i] | (input[i + 1] << 8);
+        i += 2;
+
+        const matchLength = readLength(token & 15) + 4;
+        const matchStart = output.length - matchOffset;
+        for (let j = 0; j < matchLength; j++) {
+            output.push(output[matchStart + j]);
+        }
+    }
+
+    return Buffer.from(output);
+}
+
+function createTestData(size: number) {
+    const buffer = Buffer.alloc(size);
+    let seed = 1;
+    for (let i = 0; i < size; i++) {
+        seed = (seed * 1103515245 + 12345) >>> 0;
+        // mostly repeating text with some noise, so matches are found
+        buffer[i] = i % 64 < 48 ? 0x41 + (i % 13) : seed >>> 24;
+    }
+    return buffer;
+}
+
+before(async () => {
+    await load_lz4_module();
+});
+
+test("compresses a single block", () => {
+    const data = createTestData(10000);
+    const { compressedBuffer, compressedSize } = compress(data, 9, true);
+
+    assert.equal(compressedBuffer.length, compressedSize);
+    assert.ok(compressedSize < data.length);
+    assert.deepEqual(decompressBlock(compressedBuffer), data);
+});
+
+test("splits the buffer into independent blocks", () => {
+    const blockSize = 64 * 1024;
+    const data = createTestData(2 * blockSize + 1000);
+
+    const { compressedBuffer, compressedSize } = compressBlocks(
+        data,
+        blockSize,
+        9,
+        true
+    );
+
+    assert.equal(compressedBuffer.length, compressedSize);
+    assert.equal(compressedBuffer.readUInt32LE(0), blockSize);
+
+    const numBlocks = compressedBuffer.readUInt32LE(4);
+    assert.equal(numBlocks, 3);
+
+    let expectedOffset = 8 + numBlocks * 8;
+    const blocks = [];
+    for (let i = 0; i < numBlocks; i++) {
+        const offset = compressedBuffer.readUInt32LE(8 + i * 8);
+        const size = compressedBuffer.readUInt32LE(12 + i * 8);
+        assert.equal(offset, expectedOffset);
+        expectedOffset += size;
+
+        const block = decompressBlock(
+            compressedBuffer.subarray(offset, offset + size)
+        );
+        assert.equal(
+            block.length,
+            Math.min(blockSize, data.length - i * blockSize)
+        );
+        blocks.push(block);
+    }
+    assert.equal(expectedOffset, compressedSize);
+
+    assert.deepEqual(Buffer.concat(blocks), data);
+});
+
+test("writes only the index for an empty buffer", () => {
+    const { compressedBuffer, compressedSize } = compressBlocks(
+        Buffer.alloc(0),
+        1024,
+        9,
+        true
+    );
+
+    assert.equal(compressedSize, 8);
+    assert.equal(compressedBuffer.readUInt32LE(0), 1024);
+    assert.equal(compressedBuffer.readUInt32LE(4), 0);
+});
@@ -63,6 +63,60 @@ export function compress(buffer: Buffer, compressionLevel: number, with_hc: bool
     return { compressedBuffer, compressedSize };
 }
 
+// Compresses buffer as a sequence of independent LZ4 blocks, so they can be
+// decompressed in parallel. Layout: blockSize, numBlocks, then for each block
+// its compressed offset (from the start of the result) and compressed size,
+// followed by the compressed blocks.
+export function compressBlocks(
+    buffer: Buffer,
+    blockSize: number,
+    compressionLevel: number,
+    with_hc: boolean
+) {
+    const numBlocks = Math.ceil(buffer.length / blockSize);
+
+    const blocks = [];
+    for (let i = 0; i < numBlocks; i++) {
+        blocks.push(
+            compress(
+                buffer.subarray(
+                    i * blockSize,
+                    Math.min((i + 1) * blockSize, buffer.length)
+                ),
+                compressionLevel,
+                with_hc
+            )
+        );
+    }
+
+    const indexSize = 8 + numBlocks * 8;
+
+    const compressedSize = blocks.reduce(
+        (size, block) => size + block.compressedSize,
+        indexSize
+    );
+
+    const compressedBuffer = Buffer.alloc(compressedSize);
+
+    compressedBuffer.writeUInt32LE(blockSize, 0);
+    compressedBuffer.writeUInt32LE(numBlocks, 4);
+
+    let offset = indexSize;
+    blocks.forEach((block, i) => {
+        compressedBuffer.writeUInt32LE(offset, 8 + i * 8);
+        compressedBuffer.writeUInt32LE(block.compressedSize, 12 + i * 8);
+        block.compressedBuffer.copy(
+            compressedBuffer,
+            offset,
+            0,
+            block.compressedSize
+        );
+        offset += block.compressedSize;
+    });
+
+    return { compressedBuffer, compressedSize };
+}
+
 export function compress_sync(buffer: Buffer) {
     if (!lz4_module) {
         throw "lz4 wasm module not loaded";
@@ -0,0 +1,64 @@
+import { test } from "node:test";
+import assert from "node:assert/strict";
+
+import { getCanonicalValueKey } from "project-editor/build/value-types";
+
+test("ignores the order of object properties", () => {
+    assert.equal(
+        getCanonicalValueKey({ a: 1, b: { c: "x", d: [1, 2] } }),
+        getCanonicalValueKey({ b: { d: [1, 2], c: "x" }, a: 1 })
+    );
+});
+
+test("keeps primitives of different types apart", () => {
+    assert.notEqual(getCanonicalValueKey(1), getCanonicalValueKey("1"));
+    assert.notEqual(
+        getCanonicalValueKey([1, "2"]),
+        getCanonicalValueKey([1, 2])
+    );
+    assert.notEqual(getCanonicalValueKey(true), getCanonicalValueKey("true"));
+    assert.notEqual(getCanonicalValueKey(null), getCanonicalValueKey("null"));
+    assert.notEqual(
+        getCanonicalValueKey(undefined),
+        getCanonicalValueKey("undefined")
+    );
+});
+
+test("keeps negative zero apart from zero", () => {
+    assert.notEqual(getCanonicalValueKey(-0), getCanonicalValueKey(0));
+    assert.equal(getCanonicalValueKey(0), getCanonicalValueKey(0));
+});
+
+test("does not collide different structs", () => {
+    assert.notEqual(
+        getCanonicalValueKey({ a: 1 }),
+        getCanonicalValueKey({ a: 2 })
+    );
+    assert.notEqual(
+        getCanonicalValueKey({ a: 1 }),
+        getCanonicalValueKey({ b: 1 })
+    );
+    assert.notEqual(getCanonicalValueKey({}), getCanonicalValueKey([]));
+});
+
+test("keys dates by their time", () => {
+    assert.equal(
+        getCanonicalValueKey(new Date(1000)),
+        getCanonicalValueKey(new Date(1000))
+    );
+    assert.notEqual(
+        getCanonicalValueKey(new Date(1000)),
+        getCanonicalValueKey(new Date(2000))
+    );
+});
+
+test("escapes strings and property names", () => {
+    assert.notEqual(
+        getCanonicalValueKey(['a","b']),
+        getCanonicalValueKey(["a", "b"])
+    );
+    assert.notEqual(
+        getCanonicalValueKey({ 'a":1,"b': 1 }),
+        getCanonicalValueKey({ a: 1, b: 1 })
+    );
+});
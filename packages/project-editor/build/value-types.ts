@@ -39,6 +39,9 @@ export const FLOW_VALUE_TYPE_JSON = 35;
 export const FLOW_VALUE_TYPE_JSON_MEMBER_VALUE = 36;
 export const FLOW_VALUE_TYPE_EVENT = 37;
 
+// value is immutable and can be shared instead of cloned when variable is initialized
+export const FLOW_VALUE_OPTIONS_SHARED = 1 << 15;
+
 export const basicFlowValueTypes: ValueType[] = [
     "undefined", // FLOW_VALUE_TYPE_UNDEFINED: 0
     "null", // FLOW_VALUE_TYPE_NULL: 1
@@ -79,3 +82,36 @@ export const basicFlowValueTypes: ValueType[] = [
     "_t13" as any, // FLOW_VALUE_TYPE_JSON_MEMBER_VALUE: 36
     "event" // FLOW_VALUE_TYPE_EVENT: 37
 ];
+
+// Structurally identical values get the same key, regardless of the order of
+// object properties, so they can share a single constant.
+export function getCanonicalValueKey(value: any): string {
+    if (value === undefined) {
+        return "undefined";
+    }
+    if (value === null) {
+        return "null";
+    }
+    if (value instanceof Date) {
+        return `date:${value.getTime()}`;
+    }
+    if (Array.isArray(value)) {
+        return `[${value.map(getCanonicalValueKey).join(",")}]`;
+    }
+    if (typeof value == "object") {
+        return `{${Object.keys(value)
+            .sort()
+            .map(
+                key =>
+                    `${JSON.stringify(key)}:${getCanonicalValueKey(value[key])}`
+            )
+            .join(",")}}`;
+    }
+    if (typeof value == "string") {
+        return JSON.stringify(value);
+    }
+    if (typeof value == "number" && Object.is(value, -0)) {
+        return "number:-0";
+    }
+    return `${typeof value}:${value}`;
+}
@@ -13,6 +13,7 @@ import { evalConstantExpression } from "project-editor/flow/expression";
 import { Section } from "project-editor/store";
 import { MessageType } from "project-editor/core/object";
 import {
+    FLOW_VALUE_OPTIONS_SHARED,
     FLOW_VALUE_TYPE_ARRAY_ASSET,
     FLOW_VALUE_TYPE_BOOLEAN,
     FLOW_VALUE_TYPE_DATE,
@@ -194,7 +195,11 @@ function buildFlowValue(
     } else {
         dataBuffer.writeUint8(flowValue.type); // type_
         dataBuffer.writeUint8(0); // unit_
-        dataBuffer.writeUint16(0); // options_
+        dataBuffer.writeUint16(
+            flowValue.type == FLOW_VALUE_TYPE_STRING_ASSET
+                ? FLOW_VALUE_OPTIONS_SHARED
+                : 0
+        ); // options_
         dataBuffer.writeUint32(0); // reserved_
         // union
         if (flowValue.type == FLOW_VALUE_TYPE_BOOLEAN) {
@@ -335,6 +335,20 @@ export const NativeVariableImplementationInfoPropertyUI = observer(
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// flags of the native variable are only used by the LVGL native_vars table
+function isNativeVariableFlagDisabled(variable: Variable) {
+    return (
+        !isLVGLProject(variable) ||
+        !variable.native ||
+        isPropertyDisabled(
+            variable,
+            findPropertyByNameInObject(variable, "native")!
+        )
+    );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 export class Variable extends EezObject {
     id: number | undefined;
     name: string;
@@ -346,6 +360,8 @@ export class Variable extends EezObject {
     usedIn?: string[];
     persistent: boolean;
     native: boolean;
+    nativeTickStable: boolean;
+    nativeCoalesceWrites: boolean;
 
     constructor() {
         super();
@@ -368,7 +384,9 @@ export class Variable extends EezObject {
             defaultValueList: observable,
             usedIn: observable,
             persistent: observable,
-            native: observable
+            native: observable,
+            nativeTickStable: observable,
+            nativeCoalesceWrites: observable
         });
     }
 
@@ -453,6 +471,20 @@ export class Variable extends EezObject {
                     ProjectEditor.getProject(variable).masterProject != null,
                 checkboxStyleSwitch: true
             },
+            {
+                name: "nativeTickStable",
+                displayName: "Read once per tick",
+                type: PropertyType.Boolean,
+                disabled: isNativeVariableFlagDisabled,
+                checkboxStyleSwitch: true
+            },
+            {
+                name: "nativeCoalesceWrites",
+                displayName: "Write once per tick",
+                type: PropertyType.Boolean,
+                disabled: isNativeVariableFlagDisabled,
+                checkboxStyleSwitch: true
+            },
             {
                 name: "nativeImplementationInfo",
                 type: PropertyType.Any,
@@ -68,7 +68,11 @@ export enum MessagesToDebugger {
     MESSAGE_TO_DEBUGGER_PAGE_CHANGED, // PAGE_ID
 
     MESSAGE_TO_DEBUGGER_COMPONENT_EXECUTION_STATE_CHANGED, // FLOW_STATE_INDEX, COMPONENT_INDEX, STATE
-    MESSAGE_TO_DEBUGGER_COMPONENT_ASYNC_STATE_CHANGED // FLOW_STATE_INDEX, COMPONENT_INDEX, STATE
+    MESSAGE_TO_DEBUGGER_COMPONENT_ASYNC_STATE_CHANGED, // FLOW_STATE_INDEX, COMPONENT_INDEX, STATE
+
+    MESSAGE_TO_DEBUGGER_ALLOC_TAG_INFO, // ALLOC_ID (hex), LIVE_COUNT, PEAK_COUNT, LIVE_BYTES, PEAK_BYTES, TOTAL_COUNT, CUMULATIVE_BYTES
+
+    MESSAGE_TO_DEBUGGER_TRACE // OFFSET, TOTAL_SIZE, CHUNK (hex)
 }
 
 enum MessagesFromDebugger {
@@ -81,7 +85,14 @@ enum MessagesFromDebugger {
     MESSAGE_FROM_DEBUGGER_ENABLE_BREAKPOINT, // FLOW_INDEX, COMPONENT_INDEX
     MESSAGE_FROM_DEBUGGER_DISABLE_BREAKPOINT, // FLOW_INDEX, COMPONENT_INDEX
 
-    MESSAGE_FROM_DEBUGGER_MODE // MODE (0:RUN | 1:DEBUG)
+    MESSAGE_FROM_DEBUGGER_MODE, // MODE (0:RUN | 1:DEBUG)
+
+    MESSAGE_FROM_DEBUGGER_VALUE_RATE_LIMIT, // INTERVAL_MS, GLOBAL_VARIABLE_INDEX (-1 - ALL)
+    MESSAGE_FROM_DEBUGGER_COMPONENT_RATE_LIMIT, // INTERVAL_MS, FLOW_INDEX (-1 - ALL), COMPONENT_INDEX
+
+    MESSAGE_FROM_DEBUGGER_GET_ALLOC_TAG_INFO, // no params
+
+    MESSAGE_FROM_DEBUGGER_GET_TRACE // no params
 }
 
 const DEBUGGER_STATE_RESUMED = 0;
@@ -408,6 +419,24 @@ export class RemoteRuntime extends RuntimeBase {
         }
     }
 
+    sendDebuggerRateLimits() {
+        if (this.debuggerConnection) {
+            const build = this.projectStore.project.settings.build;
+
+            this.debuggerConnection.sendMessageFromDebugger(
+                `${MessagesFromDebugger.MESSAGE_FROM_DEBUGGER_VALUE_RATE_LIMIT}\t${
+                    build.debuggerValueRateLimit ?? 0
+                }\t-1\n`
+            );
+
+            this.debuggerConnection.sendMessageFromDebugger(
+                `${
+                    MessagesFromDebugger.MESSAGE_FROM_DEBUGGER_COMPONENT_RATE_LIMIT
+                }\t${build.debuggerComponentRateLimit ?? 0}\t-1\t0\n`
+            );
+        }
+    }
+
     runSingleStep(singleStepMode?: SingleStepMode) {
         if (this.debuggerConnection) {
             if (singleStepMode != undefined) {
@@ -772,6 +801,7 @@ export abstract class DebuggerConnectionBase {
 
     onConnected() {
         this.runtime.onDebuggerActiveChanged();
+        this.runtime.sendDebuggerRateLimits();
     }
 
     counter = 0;
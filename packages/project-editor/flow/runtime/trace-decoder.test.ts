@@ -0,0 +1,148 @@
+import { test } from "node:test";
+import assert from "node:assert/strict";
+
+import {
+    decodeTrace,
+    decodeTraceEvents
+} from "project-editor/flow/runtime/trace-decoder";
+
+// mirrors TraceDumpHeader and TraceEvent from eez-flow.h
+const HEADER_SIZE = 20;
+const EVENT_SIZE = 20;
+
+interface RawTraceEvent {
+    timestamp: number;
+    type: number;
+    flowStateIndex?: number;
+    componentIndex?: number;
+    queueDepth?: number;
+    data?: number;
+}
+
+function encodeTraceDump(
+    timestampFrequency: number,
+    events: RawTraceEvent[],
+    numDroppedEvents: number = 0
+) {
+    const buffer = new Uint8Array(HEADER_SIZE + events.length * EVENT_SIZE);
+    const dataView = new DataView(buffer.buffer);
+
+    dataView.setUint32(0, 0x52545a45, true);
+    dataView.setUint16(4, 2, true);
+    dataView.setUint16(6, EVENT_SIZE, true);
+    dataView.setUint32(8, timestampFrequency, true);
+    dataView.setUint32(12, events.length, true);
+    dataView.setUint32(16, numDroppedEvents, true);
+
+    events.forEach((event, i) => {
+        const offset = HEADER_SIZE + i * EVENT_SIZE;
+        dataView.setUint32(offset, event.timestamp >>> 0, true);
+        dataView.setUint32(
+            offset + 4,
+            event.flowStateIndex ?? 0xffffffff,
+            true
+        );
+        dataView.setUint16(offset + 8, event.componentIndex ?? 0xffff, true);
+        dataView.setUint8(offset + 10, event.type);
+        dataView.setUint16(offset + 12, event.queueDepth ?? 0, true);
+        dataView.setUint32(offset + 16, event.data ?? 0, true);
+    });
+
+    return buffer;
+}
+
+test("decodes events written in the runtime layout", () => {
+    const dump = encodeTraceDump(
+        1000,
+        [
+            { timestamp: 100, type: 0 },
+            {
+                timestamp: 102,
+                type: 2,
+                flowStateIndex: 0x12345678,
+                componentIndex: 7,
+                queueDepth: 3,
+                data: 42
+            },
+            {
+                timestamp: 110,
+                type: 3,
+                flowStateIndex: 0x12345678,
+                componentIndex: 7,
+                data: 42
+            },
+            { timestamp: 120, type: 1, data: 1 }
+        ],
+        5
+    );
+
+    const { timestampFrequency, numDroppedEvents, firstTimestamp, events } =
+        decodeTraceEvents(dump);
+
+    assert.equal(timestampFrequency, 1000);
+    assert.equal(numDroppedEvents, 5);
+    assert.equal(firstTimestamp, 100);
+    assert.deepEqual(
+        events.map(event => event.type),
+        ["tick-start", "task-start", "task-end", "tick-end"]
+    );
+    assert.equal(events[0].flowStateIndex, undefined);
+    assert.equal(events[0].componentIndex, undefined);
+    assert.equal(events[1].flowStateIndex, 0x12345678);
+    assert.equal(events[1].componentIndex, 7);
+    assert.equal(events[1].queueDepth, 3);
+    assert.equal(events[1].data, 42);
+    assert.equal(events[3].time, 0.02);
+});
+
+test("groups tasks into ticks", () => {
+    const dump = encodeTraceDump(1000, [
+        { timestamp: 0, type: 0 },
+        { timestamp: 1, type: 2, flowStateIndex: 64, componentIndex: 1 },
+        { timestamp: 2, type: 2, flowStateIndex: 128, componentIndex: 0 },
+        { timestamp: 3, type: 5, flowStateIndex: 128, componentIndex: 0 },
+        { timestamp: 4, type: 3, flowStateIndex: 128, componentIndex: 0 },
+        { timestamp: 5, type: 3, flowStateIndex: 64, componentIndex: 1 },
+        { timestamp: 6, type: 1, data: 2 }
+    ]);
+
+    const { ticks } = decodeTrace(dump);
+
+    assert.equal(ticks.length, 1);
+    assert.equal(ticks[0].numTasks, 2);
+    assert.equal(ticks[0].end, 0.006);
+    assert.equal(ticks[0].tasks.length, 2);
+    assert.equal(ticks[0].tasks[0].end, 0.005);
+    assert.equal(ticks[0].tasks[0].error, false);
+    assert.equal(ticks[0].tasks[1].start, 0.002);
+    assert.equal(ticks[0].tasks[1].end, 0.004);
+    assert.equal(ticks[0].tasks[1].error, true);
+});
+
+test("survives a timestamp counter wrap around", () => {
+    const dump = encodeTraceDump(1000, [
+        { timestamp: 0xfffffff0, type: 0 },
+        { timestamp: 0x10, type: 1 }
+    ]);
+
+    const { events } = decodeTraceEvents(dump);
+
+    assert.equal(events[1].time, 0.032);
+});
+
+test("rejects malformed dumps", () => {
+    assert.throws(() => decodeTraceEvents(new Uint8Array(4)));
+
+    const badMagic = encodeTraceDump(1000, []);
+    badMagic[0] ^= 0xff;
+    assert.throws(() => decodeTraceEvents(badMagic));
+
+    const truncated = encodeTraceDump(1000, [{ timestamp: 0, type: 0 }]);
+    assert.throws(() => decodeTraceEvents(truncated.subarray(0, 30)));
+
+    const zeroFrequency = encodeTraceDump(0, [{ timestamp: 0, type: 0 }]);
+    assert.throws(
+        () => decodeTraceEvents(zeroFrequency),
+        /timestamp frequency/
+    );
+});
@@ -0,0 +1,236 @@
+// Decoder for the binary dumps produced by eez::flow::dumpTrace()
+
+const TRACE_DUMP_MAGIC = 0x52545a45;
+const TRACE_DUMP_VERSION = 2;
+const TRACE_DUMP_HEADER_SIZE = 20;
+
+const TRACE_EVENT_TICK_START = 0;
+const TRACE_EVENT_TICK_END = 1;
+const TRACE_EVENT_TASK_START = 2;
+const TRACE_EVENT_TASK_END = 3;
+const TRACE_EVENT_ADD_TO_QUEUE = 4;
+const TRACE_EVENT_ERROR = 5;
+
+const NO_FLOW_STATE_INDEX = 0xffffffff;
+const NO_COMPONENT_INDEX = 0xffff;
+
+export type TraceEventType =
+    | "tick-start"
+    | "tick-end"
+    | "task-start"
+    | "task-end"
+    | "add-to-queue"
+    | "error"
+    | "unknown";
+
+export interface TraceEvent {
+    type: TraceEventType;
+    time: number; // seconds since the first event in the dump
+    flowStateIndex: number | undefined;
+    componentIndex: number | undefined;
+    queueDepth: number;
+    data: number;
+}
+
+export interface TraceTask {
+    flowStateIndex: number | undefined;
+    componentIndex: number | undefined;
+    componentType: number;
+    start: number;
+    end: number | undefined;
+    queueDepth: number;
+    error: boolean;
+}
+
+export interface TraceTick {
+    start: number;
+    end: number | undefined;
+    numTasks: number;
+    tasks: TraceTask[];
+}
+
+export interface TraceTimeline {
+    timestampFrequency: number;
+    numDroppedEvents: number;
+    events: TraceEvent[];
+    ticks: TraceTick[];
+}
+
+function getEventType(type: number): TraceEventType {
+    switch (type) {
+        case TRACE_EVENT_TICK_START:
+            return "tick-start";
+        case TRACE_EVENT_TICK_END:
+            return "tick-end";
+        case TRACE_EVENT_TASK_START:
+            return "task-start";
+        case TRACE_EVENT_TASK_END:
+            return "task-end";
+        case TRACE_EVENT_ADD_TO_QUEUE:
+            return "add-to-queue";
+        case TRACE_EVENT_ERROR:
+            return "error";
+    }
+    return "unknown";
+}
+
+export function decodeTraceEvents(buffer: Uint8Array) {
+    const dataView = new DataView(
+        buffer.buffer,
+        buffer.byteOffset,
+        buffer.byteLength
+    );
+
+    if (buffer.byteLength < TRACE_DUMP_HEADER_SIZE) {
+        throw new Error("Trace dump is too short");
+    }
+
+    const magic = dataView.getUint32(0, true);
+    if (magic != TRACE_DUMP_MAGIC) {
+        throw new Error("Not a flow trace dump");
+    }
+
+    const version = dataView.getUint16(4, true);
+    if (version != TRACE_DUMP_VERSION) {
+        throw new Error(`Unsupported trace dump version ${version}`);
+    }
+
+    const eventSize = dataView.getUint16(6, true);
+    const timestampFrequency = dataView.getUint32(8, true);
+    const numEvents = dataView.getUint32(12, true);
+    const numDroppedEvents = dataView.getUint32(16, true);
+
+    if (timestampFrequency == 0) {
+        throw new Error("Invalid trace timestamp frequency");
+    }
+
+    if (TRACE_DUMP_HEADER_SIZE + numEvents * eventSize > buffer.byteLength) {
+        throw new Error("Trace dump is truncated");
+    }
+
+    const events: TraceEvent[] = [];
+
+    let firstTimestamp = 0;
+    let elapsed = 0;
+    let previousTimestamp = 0;
+
+    for (let i = 0; i < numEvents; i++) {
+        const offset = TRACE_DUMP_HEADER_SIZE + i * eventSize;
+
+        // timestamps are free running 32-bit counters, so accumulate deltas to survive a wrap around
+        const timestamp = dataView.getUint32(offset, true);
+        if (i == 0) {
+            firstTimestamp = timestamp;
+        } else {
+            elapsed += (timestamp - previousTimestamp) >>> 0;
+        }
+        previousTimestamp = timestamp;
+
+        const flowStateIndex = dataView.getUint32(offset + 4, true);
+        const componentIndex = dataView.getUint16(offset + 8, true);
+
+        events.push({
+            type: getEventType(dataView.getUint8(offset + 10)),
+            time: elapsed / timestampFrequency,
+            flowStateIndex:
+                flowStateIndex == NO_FLOW_STATE_INDEX
+                    ? undefined
+                    : flowStateIndex,
+            componentIndex:
+                componentIndex == NO_COMPONENT_INDEX
+                    ? undefined
+                    : componentIndex,
+            queueDepth: dataView.getUint16(offset + 12, true),
+            data: dataView.getUint32(offset + 16, true)
+        });
+    }
+
+    return {
+        timestampFrequency,
+        numDroppedEvents,
+        firstTimestamp,
+        events
+    };
+}
+
+export function decodeTrace(buffer: Uint8Array): TraceTimeline {
+    const { timestampFrequency, numDroppedEvents, events } =
+        decodeTraceEvents(buffer);
+
+    const ticks: TraceTick[] = [];
+
+    let tick: TraceTick | undefined;
+    const openTasks: TraceTask[] = [];
+
+    for (const event of events) {
+        if (event.type == "tick-start") {
+            tick = {
+                start: event.time,
+                end: undefined,
+                numTasks: 0,
+                tasks: []
+            };
+            ticks.push(tick);
+            openTasks.length = 0;
+        } else if (event.type == "tick-end") {
+            if (tick) {
+                tick.end = event.time;
+                tick.numTasks = event.data;
+            }
+            tick = undefined;
+        } else if (event.type == "task-start") {
+            const task: TraceTask = {
+                flowStateIndex: event.flowStateIndex,
+                componentIndex: event.componentIndex,
+                componentType: event.data,
+                start: event.time,
+                end: undefined,
+                queueDepth: event.queueDepth,
+                error: false
+            };
+            if (!tick) {
+                // dump started in the middle of a tick
+                tick = {
+                    start: event.time,
+                    end: undefined,
+                    numTasks: 0,
+                    tasks: []
+                };
+                ticks.push(tick);
+            }
+            tick.tasks.push(task);
+            openTasks.push(task);
+        } else if (event.type == "task-end") {
+            // tasks can nest when an action flow is executed inline
+            for (let i = openTasks.length - 1; i >= 0; i--) {
+                const task = openTasks[i];
+                if (
+                    task.flowStateIndex == event.flowStateIndex &&
+                    task.componentIndex == event.componentIndex
+                ) {
+                    task.end = event.time;
+                    openTasks.splice(i, 1);
+                    break;
+                }
+            }
+        } else if (event.type == "error") {
+            for (let i = openTasks.length - 1; i >= 0; i--) {
+                const task = openTasks[i];
+                if (
+                    task.flowStateIndex == event.flowStateIndex &&
+                    task.componentIndex == event.componentIndex
+                ) {
+                    task.error = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    return {
+        timestampFrequency,
+        numDroppedEvents,
+        events,
+        ticks
+    };
+}
@@ -2765,6 +2765,16 @@ extern ext_font_desc_t fonts[];
                 !this.assets.projectStore.projectTypeTraits.hasFlowSupport ||
                 variable.native
             ) {
+                // flags field is omitted when not used, so the table still
+                // compiles with older eez-framework versions
+                const flags = [];
+                if (variable.nativeTickStable) {
+                    flags.push("NATIVE_VAR_FLAG_TICK_STABLE");
+                }
+                if (variable.nativeCoalesceWrites) {
+                    flags.push("NATIVE_VAR_FLAG_COALESCE_WRITES");
+                }
+
                 build.line(
                     `{ NATIVE_VAR_TYPE_${
                         isEnumType(variable.type)
@@ -2772,7 +2782,7 @@ extern ext_font_desc_t fonts[];
                             : variable.type.toUpperCase()
                     }, ${this.getVariableGetterFunctionName(variable.name)}, ${this.getVariableSetterFunctionName(
                         variable.name
-                    )} }, `
+                    )}${flags.length > 0 ? ", " + flags.join(" | ") : ""} }, `
                 );
             }
         }
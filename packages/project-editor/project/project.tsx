@@ -279,8 +279,11 @@ export class Build extends EezObject {
     screensLifetimeSupport: boolean;
     generateSourceCodeForEezFramework: boolean;
     compressFlowDefinition: boolean;
+    flatComponentLayout: boolean;
     executionQueueSize: number;
     expressionEvaluatorStackSize: number;
+    debuggerValueRateLimit: number;
+    debuggerComponentRateLimit: number;
     imageExportMode: "source" | "binary";
     fontExportMode: "source" | "binary";
     fileSystemPath: string;
@@ -394,6 +397,13 @@ export class Build extends EezObject {
                     !getProject(object).projectTypeTraits.hasFlowSupport ||
                     !object.generateSourceCodeForEezFramework
             },
+            {
+                name: "flatComponentLayout",
+                type: PropertyType.Boolean,
+                checkboxStyleSwitch: true,
+                disabled: (object: Build) =>
+                    !getProject(object).projectTypeTraits.hasFlowSupport
+            },
             {
                 name: "executionQueueSize",
                 type: PropertyType.Number,
@@ -409,6 +419,20 @@ export class Build extends EezObject {
                     isNotLVGLProject(object) ||
                     !getProject(object).projectTypeTraits.hasFlowSupport ||
                     !object.generateSourceCodeForEezFramework
+            },
+            {
+                name: "debuggerValueRateLimit",
+                displayName: "Debugger value update interval (ms)",
+                type: PropertyType.Number,
+                disabled: (object: Build) =>
+                    !getProject(object).projectTypeTraits.hasFlowSupport
+            },
+            {
+                name: "debuggerComponentRateLimit",
+                displayName: "Debugger component update interval (ms)",
+                type: PropertyType.Number,
+                disabled: (object: Build) =>
+                    !getProject(object).projectTypeTraits.hasFlowSupport
             }
         ],
 
@@ -425,6 +449,10 @@ export class Build extends EezObject {
                 jsObject.compressFlowDefinition = false;
             }
 
+            if (jsObject.flatComponentLayout == undefined) {
+                jsObject.flatComponentLayout = false;
+            }
+
             if (jsObject.executionQueueSize == undefined) {
                 jsObject.executionQueueSize = 1000;
             }
@@ -433,6 +461,14 @@ export class Build extends EezObject {
                 jsObject.expressionEvaluatorStackSize = 20;
             }
 
+            if (jsObject.debuggerValueRateLimit == undefined) {
+                jsObject.debuggerValueRateLimit = 0;
+            }
+
+            if (jsObject.debuggerComponentRateLimit == undefined) {
+                jsObject.debuggerComponentRateLimit = 0;
+            }
+
             if (jsObject.separateFolderForImagesAndFonts == undefined) {
                 jsObject.separateFolderForImagesAndFonts = false;
             }
@@ -483,8 +519,11 @@ export class Build extends EezObject {
             useDockerDesktop: observable,
             generateSourceCodeForEezFramework: observable,
             compressFlowDefinition: observable,
+            flatComponentLayout: observable,
             executionQueueSize: observable,
-            expressionEvaluatorStackSize: observable
+            expressionEvaluatorStackSize: observable,
+            debuggerValueRateLimit: observable,
+            debuggerComponentRateLimit: observable
         });
     }
 }
@@ -37,37 +37,180 @@ void executeActionFunction(int actionId) {
 #include <emscripten/heap.h>
 #include <unistd.h>
 #endif
+#if EEZ_ALLOC_TRACKING && EEZ_OPTION_THREADS
+#include <atomic>
+#endif
 namespace eez {
 uint32_t g_freeMemoryAtStart;
 uint32_t g_allocMemoryAtStart;
+#if EEZ_ALLOC_TRACKING
+static_assert((EEZ_ALLOC_TRACKING_TABLE_SIZE & (EEZ_ALLOC_TRACKING_TABLE_SIZE - 1)) == 0, "EEZ_ALLOC_TRACKING_TABLE_SIZE must be a power of two");
+struct alignas(8) AllocHeader {
+    uint32_t tagIndex;
+    uint32_t size;
+};
+static const uint32_t OVERFLOW_ALLOC_TAG_INDEX = EEZ_ALLOC_TRACKING_TABLE_SIZE - 1;
+static AllocTagInfo g_allocTags[EEZ_ALLOC_TRACKING_TABLE_SIZE];
+#if EEZ_OPTION_THREADS
+static std::atomic_flag g_allocTagsLock = ATOMIC_FLAG_INIT;
+#endif
+static inline void lockAllocTags() {
+#if EEZ_OPTION_THREADS
+    while (g_allocTagsLock.test_and_set(std::memory_order_acquire)) {
+    }
+#endif
+}
+static inline void unlockAllocTags() {
+#if EEZ_OPTION_THREADS
+    g_allocTagsLock.clear(std::memory_order_release);
+#endif
+}
+static uint32_t findAllocTag(uint32_t id) {
+    uint32_t tagIndex = (id * 2654435761u) % OVERFLOW_ALLOC_TAG_INDEX;
+    for (uint32_t i = 0; i < OVERFLOW_ALLOC_TAG_INDEX; i++) {
+        auto &tagInfo = g_allocTags[tagIndex];
+        if (tagInfo.totalCount == 0) {
+            tagInfo.id = id;
+            return tagIndex;
+        }
+        if (tagInfo.id == id) {
+            return tagIndex;
+        }
+        tagIndex = (tagIndex + 1) % OVERFLOW_ALLOC_TAG_INDEX;
+    }
+    g_allocTags[OVERFLOW_ALLOC_TAG_INDEX].id = ALLOC_TAG_OVERFLOW;
+    return OVERFLOW_ALLOC_TAG_INDEX;
+}
+static uint32_t trackAlloc(uint32_t id, uint32_t size) {
+    lockAllocTags();
+    auto tagIndex = findAllocTag(id);
+    auto &tagInfo = g_allocTags[tagIndex];
+    tagInfo.liveCount++;
+    tagInfo.liveBytes += size;
+    tagInfo.totalCount++;
+    tagInfo.cumulativeBytes += size;
+    if (tagInfo.liveCount > tagInfo.peakCount) {
+        tagInfo.peakCount = tagInfo.liveCount;
+    }
+    if (tagInfo.liveBytes > tagInfo.peakBytes) {
+        tagInfo.peakBytes = tagInfo.liveBytes;
+    }
+    unlockAllocTags();
+    return tagIndex;
+}
+static void trackFree(uint32_t tagIndex, uint32_t size) {
+    lockAllocTags();
+    auto &tagInfo = g_allocTags[tagIndex];
+    tagInfo.liveCount--;
+    tagInfo.liveBytes -= size;
+    unlockAllocTags();
+}
+uint32_t getAllocInfo(AllocTagInfo *tagInfos, uint32_t maxTagInfos, uint32_t firstTagInfo) {
+    uint32_t numTagInfos = 0;
+    lockAllocTags();
+    for (uint32_t i = 0; i < EEZ_ALLOC_TRACKING_TABLE_SIZE && numTagInfos < maxTagInfos; i++) {
+        if (g_allocTags[i].totalCount > 0) {
+            if (firstTagInfo > 0) {
+                firstTagInfo--;
+            } else {
+                tagInfos[numTagInfos++] = g_allocTags[i];
+            }
+        }
+    }
+    unlockAllocTags();
+    return numTagInfos;
+}
+void resetAllocTagPeaks() {
+    lockAllocTags();
+    for (uint32_t i = 0; i < EEZ_ALLOC_TRACKING_TABLE_SIZE; i++) {
+        g_allocTags[i].peakCount = g_allocTags[i].liveCount;
+        g_allocTags[i].peakBytes = g_allocTags[i].liveBytes;
+    }
+    unlockAllocTags();
+}
+#endif
 void initAllocHeap(uint8_t *heap, size_t heapSize) {
     EEZ_UNUSED(heap);
     EEZ_UNUSED(heapSize);
 	getAllocInfo(g_freeMemoryAtStart, g_allocMemoryAtStart);
 }
-void *alloc(size_t size, uint32_t id) {
-    EEZ_UNUSED(id);
+static void *allocDefaultMemory(size_t size) {
 #if LVGL_VERSION_MAJOR >= 9
     return lv_malloc(size);
 #else
     return lv_mem_alloc(size);
 #endif
 }
-void free(void *ptr) {
+static void freeDefaultMemory(void *ptr) {
 #if LVGL_VERSION_MAJOR >= 9
     lv_free(ptr);
 #else
     lv_mem_free(ptr);
 #endif
 }
-template<typename T> void freeObject(T *ptr) {
-	ptr->~T();
-#if LVGL_VERSION_MAJOR >= 9
-    lv_free(ptr);
+#if EEZ_FLOW_MULTI_INSTANCE
+struct alignas(8) AllocOwner {
+    void (*freeHook)(void *ptr);
+};
+#endif
+static void *allocMemory(size_t size, uint32_t id) {
+    EEZ_UNUSED(id);
+#if EEZ_FLOW_MULTI_INSTANCE
+    auto runtimeContext = flow::g_runtimeContext;
+    auto owner = (AllocOwner *)(runtimeContext->allocHook ? runtimeContext->allocHook(sizeof(AllocOwner) + size, id) : allocDefaultMemory(sizeof(AllocOwner) + size));
+    if (!owner) {
+        return nullptr;
+    }
+    owner->freeHook = runtimeContext->allocHook ? runtimeContext->freeHook : nullptr;
+    return owner + 1;
+#else
+    return allocDefaultMemory(size);
+#endif
+}
+static void freeMemory(void *ptr) {
+#if EEZ_FLOW_MULTI_INSTANCE
+    if (!ptr) {
+        return;
+    }
+    auto owner = (AllocOwner *)ptr - 1;
+    if (owner->freeHook) {
+        owner->freeHook(owner);
+    } else {
+        freeDefaultMemory(owner);
+    }
+#else
+    freeDefaultMemory(ptr);
+#endif
+}
+void *alloc(size_t size, uint32_t id) {
+#if EEZ_ALLOC_TRACKING
+    auto header = (AllocHeader *)allocMemory(sizeof(AllocHeader) + size, id);
+    if (!header) {
+        return nullptr;
+    }
+    header->size = (uint32_t)size;
+    header->tagIndex = trackAlloc(id, (uint32_t)size);
+    return header + 1;
+#else
+    return allocMemory(size, id);
+#endif
+}
+void free(void *ptr) {
+#if EEZ_ALLOC_TRACKING
+    if (!ptr) {
+        return;
+    }
+    auto header = (AllocHeader *)ptr - 1;
+    trackFree(header->tagIndex, header->size);
+    freeMemory(header);
 #else
-	lv_mem_free(ptr);
+    freeMemory(ptr);
 #endif
 }
+template<typename T> void freeObject(T *ptr) {
+	ptr->~T();
+	free(ptr);
+}
 void getAllocInfo(uint32_t &free, uint32_t &alloc) {
 #if defined(__EMSCRIPTEN__) && LV_USE_STDLIB_MALLOC == LV_STDLIB_CLIB
 	size_t total_heap = emscripten_get_heap_size();
@@ -90,17 +233,329 @@ void getAllocInfo(uint32_t &free, uint32_t &alloc) {
 #include <string.h>
 #if EEZ_FOR_LVGL_LZ4_OPTION
 #endif
+#if EEZ_FOR_LVGL_LZ4_OPTION && EEZ_OPTION_THREADS
+#include <atomic>
+#endif
 #define SCPI_ERROR_OUT_OF_DEVICE_MEMORY -321
 #define SCPI_ERROR_INVALID_BLOCK_DATA -161
 namespace eez {
-Assets *g_mainAssets;
-bool g_mainAssetsAreMutable;
 void fixOffsets(Assets *assets);
+static const uint32_t MAX_LAZY_ASSETS_SECTIONS = EEZ_MAX_LAZY_ASSETS_SECTIONS;
+#if EEZ_FOR_LVGL_LZ4_OPTION && EEZ_OPTION_THREADS
+static std::atomic_flag g_lazyAssetsSectionsLock = ATOMIC_FLAG_INIT;
+#endif
+static uint32_t getDecompressedDataOffset() {
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+#endif
+	return offsetof(Assets, settings);
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+}
+static const AssetsSection *getAssetsSections(const uint8_t *assetsData, uint32_t &numSections) {
+    numSections = *(const uint32_t *)(assetsData + sizeof(Header));
+    return (const AssetsSection *)(assetsData + sizeof(Header) + sizeof(uint32_t));
+}
+static bool isImageAssetsSection(const AssetsSection &section) {
+    return !(section.flags & ASSETS_SECTION_FLAG_RELOCATIONS);
+}
+static bool isLazyAssetsSection(const AssetsSection *sections, uint32_t sectionIndex) {
+    if (!(sections[sectionIndex].flags & ASSETS_SECTION_FLAG_LAZY)) {
+        return false;
+    }
+    uint32_t lazySectionIndex = 0;
+    for (uint32_t i = 0; i < sectionIndex; i++) {
+        if (sections[i].flags & ASSETS_SECTION_FLAG_LAZY) {
+            lazySectionIndex++;
+        }
+    }
+    return lazySectionIndex < MAX_LAZY_ASSETS_SECTIONS;
+}
+static uint32_t getEagerAssetsSectionsSize(const uint8_t *assetsData) {
+    uint32_t numSections;
+    auto sections = getAssetsSections(assetsData, numSections);
+    uint32_t size = 0;
+    for (uint32_t i = 0; i < numSections; i++) {
+        if (isImageAssetsSection(sections[i]) && !isLazyAssetsSection(sections, i) && sections[i].offset + sections[i].size > size) {
+            size = sections[i].offset + sections[i].size;
+        }
+    }
+    return size;
+}
+void (*parallelForHook)(uint32_t count, void (*task)(void *context, uint32_t index), void *context) = nullptr;
+#if EEZ_FOR_LVGL_LZ4_OPTION
+struct DecompressAssetsBlocksContext {
+    const uint8_t *compressedData;
+    uint32_t compressedSize;
+    const AssetsBlock *blocks;
+    uint32_t blockSize;
+    uint32_t size;
+    uint8_t *decompressedData;
+#if EEZ_OPTION_THREADS
+    std::atomic<bool> failed;
+#else
+    bool failed;
+#endif
+};
+static void decompressAssetsBlock(void *context, uint32_t blockIndex) {
+    auto blocksContext = (DecompressAssetsBlocksContext *)context;
+    auto &block = blocksContext->blocks[blockIndex];
+    uint32_t offset = blockIndex * blocksContext->blockSize;
+    uint32_t size = blocksContext->size - offset < blocksContext->blockSize ? blocksContext->size - offset : blocksContext->blockSize;
+    if (block.compressedOffset > blocksContext->compressedSize || block.compressedSize > blocksContext->compressedSize - block.compressedOffset) {
+        blocksContext->failed = true;
+        return;
+    }
+    int decompressResult = LZ4_decompress_safe(
+		(const char *)(blocksContext->compressedData + block.compressedOffset),
+		(char *)(blocksContext->decompressedData + offset),
+		(int)block.compressedSize,
+		(int)size
+	);
+    if (decompressResult != (int)size) {
+        blocksContext->failed = true;
+    }
+}
+static bool decompressAssetsSection(const uint8_t *assetsData, uint32_t assetsDataSize, const AssetsSection &section, uint8_t *decompressedData) {
+    if (section.compressedOffset > assetsDataSize || section.compressedSize > assetsDataSize - section.compressedOffset || section.compressedSize < 2 * sizeof(uint32_t)) {
+        return false;
+    }
+    auto compressedData = assetsData + section.compressedOffset;
+    uint32_t blockSize = ((const uint32_t *)compressedData)[0];
+    uint32_t numBlocks = ((const uint32_t *)compressedData)[1];
+    if (blockSize == 0 || numBlocks != section.size / blockSize + (section.size % blockSize ? 1 : 0) || numBlocks > (section.compressedSize - 2 * sizeof(uint32_t)) / sizeof(AssetsBlock)) {
+        return false;
+    }
+    DecompressAssetsBlocksContext context;
+    context.compressedData = compressedData;
+    context.compressedSize = section.compressedSize;
+    context.blocks = (const AssetsBlock *)(compressedData + 2 * sizeof(uint32_t));
+    context.blockSize = blockSize;
+    context.size = section.size;
+    context.decompressedData = decompressedData;
+    context.failed = false;
+    if (parallelForHook && numBlocks > 1) {
+        parallelForHook(numBlocks, decompressAssetsBlock, &context);
+    } else {
+        for (uint32_t blockIndex = 0; blockIndex < numBlocks; blockIndex++) {
+            decompressAssetsBlock(&context, blockIndex);
+        }
+    }
+    return !context.failed;
+}
+#if EEZ_OPTION_ASSETS_ABSOLUTE_POINTERS
+static bool relocateAssetsSection(const uint8_t *assetsData, uint32_t assetsDataSize, const AssetsSection &section, uint8_t *decompressedData) {
+    uint32_t numSections;
+    auto sections = getAssetsSections(assetsData, numSections);
+    for (uint32_t i = 0; i < numSections; i++) {
+        auto &relocations = sections[i];
+        if (isImageAssetsSection(relocations)) {
+            continue;
+        }
+        if (relocations.compressedOffset > assetsDataSize || relocations.compressedSize > assetsDataSize - relocations.compressedOffset || relocations.compressedSize < sizeof(uint32_t)) {
+            return false;
+        }
+        auto table = assetsData + relocations.compressedOffset;
+        auto tableEnd = table + relocations.compressedSize;
+        uint32_t numRelocations = *(const uint32_t *)table;
+        table += sizeof(uint32_t);
+        uint32_t offset = 0;
+        for (uint32_t relocationIndex = 0; relocationIndex < numRelocations; relocationIndex++) {
+            uint32_t delta = 0;
+            for (uint32_t shift = 0; ; shift += 7) {
+                if (table == tableEnd || shift > 28) {
+                    return false;
+                }
+                uint8_t byte = *table++;
+                delta |= (uint32_t)(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) {
+                    break;
+                }
+            }
+            offset += delta << 2;
+            if (offset >= section.offset + section.size) {
+                break;
+            }
+            if (offset >= section.offset) {
+                auto field = (int32_t *)(decompressedData + offset - section.offset);
+                if (*field) {
+                    *field = (int32_t)(uintptr_t)((uint8_t *)field + *field);
+                }
+            }
+        }
+        return true;
+    }
+    return false;
+}
+#endif
+static bool decompressAssetsSections(const uint8_t *assetsData, uint32_t assetsDataSize, Assets *decompressedAssets, uint32_t maxDecompressedAssetsSize, bool skipLazySections, int *err) {
+    auto header = (Header *)assetsData;
+    decompressedAssets->projectMajorVersion = header->projectMajorVersion;
+    decompressedAssets->projectMinorVersion = header->projectMinorVersion;
+    decompressedAssets->assetsType = header->assetsType;
+    auto decompressedData = (uint8_t *)decompressedAssets + getDecompressedDataOffset();
+    uint32_t numSections;
+    auto sections = getAssetsSections(assetsData, numSections);
+    for (uint32_t i = 0; i < numSections; i++) {
+        auto &section = sections[i];
+        if (!isImageAssetsSection(section) || (skipLazySections && isLazyAssetsSection(sections, i))) {
+            continue;
+        }
+        if (getDecompressedDataOffset() + section.offset + section.size > maxDecompressedAssetsSize) {
+            if (err) {
+                *err = SCPI_ERROR_OUT_OF_DEVICE_MEMORY;
+            }
+            return false;
+        }
+        if (!decompressAssetsSection(assetsData, assetsDataSize, section, decompressedData + section.offset)) {
+            if (err) {
+                *err = SCPI_ERROR_INVALID_BLOCK_DATA;
+            }
+            return false;
+        }
+#if EEZ_OPTION_ASSETS_ABSOLUTE_POINTERS
+        if (!relocateAssetsSection(assetsData, assetsDataSize, section, decompressedData + section.offset)) {
+            if (err) {
+                *err = SCPI_ERROR_INVALID_BLOCK_DATA;
+            }
+            return false;
+        }
+#endif
+    }
+    return true;
+}
+static void registerLazyAssetsSections(const uint8_t *assetsData, uint32_t assetsDataSize) {
+    auto runtimeContext = flow::g_runtimeContext;
+    auto decompressedData = (uint8_t *)runtimeContext->loadedAssets + getDecompressedDataOffset();
+    uint32_t numSections;
+    auto sections = getAssetsSections(assetsData, numSections);
+    runtimeContext->numLazyAssetsSections = 0;
+    for (uint32_t i = 0; i < numSections; i++) {
+        if (isLazyAssetsSection(sections, i)) {
+            auto rootField = (int32_t *)(decompressedData + sections[i].rootFieldOffset);
+            auto &lazySection = runtimeContext->lazyAssetsSections[runtimeContext->numLazyAssetsSections++];
+            lazySection.assetsData = assetsData;
+            lazySection.assetsDataSize = assetsDataSize;
+            lazySection.section = &sections[i];
+#if EEZ_OPTION_ASSETS_ABSOLUTE_POINTERS
+            lazySection.rootFieldValue = (int32_t)((uintptr_t)*rootField - (uintptr_t)rootField);
+#else
+            lazySection.rootFieldValue = *rootField;
+#endif
+            lazySection.buffer = nullptr;
+            *rootField = 0;
+        }
+    }
+}
+static bool loadLazyAssetsSection(LazyAssetsSection &lazySection) {
+    auto &section = *lazySection.section;
+    auto buffer = (uint8_t *)alloc(section.size, 0x6d1e4a37);
+    if (!buffer) {
+        return false;
+    }
+    if (!decompressAssetsSection(lazySection.assetsData, lazySection.assetsDataSize, section, buffer)) {
+        free(buffer);
+        return false;
+    }
+    auto decompressedData = (uint8_t *)flow::g_runtimeContext->loadedAssets + getDecompressedDataOffset();
+    auto rootField = (int32_t *)(decompressedData + section.rootFieldOffset);
+    auto target = buffer + ((int64_t)section.rootFieldOffset + lazySection.rootFieldValue - section.offset);
+#if EEZ_OPTION_ASSETS_ABSOLUTE_POINTERS
+    if (!relocateAssetsSection(lazySection.assetsData, lazySection.assetsDataSize, section, buffer)) {
+        free(buffer);
+        return false;
+    }
+    *rootField = (int32_t)(uintptr_t)target;
+    lazySection.buffer = buffer;
+    return true;
+#else
+    auto offset = (int64_t)(target - (uint8_t *)rootField);
+    if (offset < INT32_MIN || offset > INT32_MAX) {
+        free(buffer);
+        return false;
+    }
+    *rootField = (int32_t)offset;
+    lazySection.buffer = buffer;
+    return true;
+#endif
+}
+#endif
+bool loadAssetsSection(Assets *assets, uint16_t sectionId) {
+#if EEZ_FOR_LVGL_LZ4_OPTION
+    auto runtimeContext = flow::g_runtimeContext;
+    if (assets != runtimeContext->loadedAssets) {
+        return assets != runtimeContext->releasedAssets;
+    }
+#if EEZ_OPTION_THREADS
+    while (g_lazyAssetsSectionsLock.test_and_set(std::memory_order_acquire)) {
+    }
+#endif
+    bool result = true;
+    for (uint32_t i = 0; i < runtimeContext->numLazyAssetsSections; i++) {
+        auto &lazySection = runtimeContext->lazyAssetsSections[i];
+        if (lazySection.section->id == sectionId) {
+            if (!lazySection.buffer) {
+                result = loadLazyAssetsSection(lazySection);
+            }
+            break;
+        }
+    }
+#if EEZ_OPTION_THREADS
+    g_lazyAssetsSectionsLock.clear(std::memory_order_release);
+#endif
+    return result;
+#else
+    EEZ_UNUSED(assets);
+    EEZ_UNUSED(sectionId);
+    return true;
+#endif
+}
+void unloadAssetsSection(Assets *assets, uint16_t sectionId) {
+#if EEZ_FOR_LVGL_LZ4_OPTION
+    auto runtimeContext = flow::g_runtimeContext;
+    if (assets != runtimeContext->loadedAssets) {
+        return;
+    }
+#if EEZ_OPTION_THREADS
+    while (g_lazyAssetsSectionsLock.test_and_set(std::memory_order_acquire)) {
+    }
+#endif
+    for (uint32_t i = 0; i < runtimeContext->numLazyAssetsSections; i++) {
+        auto &lazySection = runtimeContext->lazyAssetsSections[i];
+        if (lazySection.section->id == sectionId) {
+            if (lazySection.buffer) {
+                auto decompressedData = (uint8_t *)runtimeContext->loadedAssets + getDecompressedDataOffset();
+                *(int32_t *)(decompressedData + lazySection.section->rootFieldOffset) = 0;
+                eez::free(lazySection.buffer);
+                lazySection.buffer = nullptr;
+            }
+            break;
+        }
+    }
+#if EEZ_OPTION_THREADS
+    g_lazyAssetsSectionsLock.clear(std::memory_order_release);
+#endif
+#else
+    EEZ_UNUSED(assets);
+    EEZ_UNUSED(sectionId);
+#endif
+}
 bool decompressAssetsData(const uint8_t *assetsData, uint32_t assetsDataSize, Assets *decompressedAssets, uint32_t maxDecompressedAssetsSize, int *err) {
 #if EEZ_FOR_LVGL_LZ4_OPTION
 	uint32_t compressedDataOffset;
 	uint32_t decompressedSize;
 	auto header = (Header *)assetsData;
+	if (header->tag == HEADER_TAG_SECTIONED) {
+		return decompressAssetsSections(assetsData, assetsDataSize, decompressedAssets, maxDecompressedAssetsSize, false, err);
+	}
+#if EEZ_OPTION_ASSETS_ABSOLUTE_POINTERS
+    if (err) {
+        *err = SCPI_ERROR_INVALID_BLOCK_DATA;
+    }
+    return false;
+#endif
 	if (header->tag == HEADER_TAG_COMPRESSED) {
 		decompressedAssets->projectMajorVersion = header->projectMajorVersion;
 		decompressedAssets->projectMinorVersion = header->projectMinorVersion;
@@ -162,35 +617,143 @@ static void allocMemoryForDecompressedAssets(const uint8_t *assetsData, uint32_t
 #pragma GCC diagnostic pop
 #endif
     auto header = (Header *)assetsData;
-    assert (header->tag == HEADER_TAG_COMPRESSED);
-    uint32_t decompressedSize = header->decompressedSize;
+    assert (header->tag == HEADER_TAG_COMPRESSED || header->tag == HEADER_TAG_SECTIONED);
+    uint32_t decompressedSize = header->tag == HEADER_TAG_SECTIONED ? getEagerAssetsSectionsSize(assetsData) : header->decompressedSize;
     decompressedAssetsMemoryBufferSize = decompressedDataOffset + decompressedSize;
     decompressedAssetsMemoryBuffer = (uint8_t *)eez::alloc(decompressedAssetsMemoryBufferSize, 0x587da194);
 }
-void loadMainAssets(const uint8_t *assets, uint32_t assetsSize) {
+bool loadMainAssets(const uint8_t *assets, uint32_t assetsSize) {
+    auto runtimeContext = flow::g_runtimeContext;
     auto header = (Header *)assets;
+    unloadMainAssets();
+#if EEZ_OPTION_ASSETS_ABSOLUTE_POINTERS
+    if (header->tag != HEADER_TAG_SECTIONED) {
+        ErrorTrace("Assets must be built as sectioned when EEZ_OPTION_ASSETS_ABSOLUTE_POINTERS is enabled\n");
+        return false;
+    }
+#endif
+#if EEZ_FLOW_SNAPSHOT
+    runtimeContext->loadedAssetsCrc32 = crc32(assets, assetsSize);
+#endif
     if (header->tag == HEADER_TAG) {
-        g_mainAssets = (Assets *)(assets + sizeof(uint32_t));
-		g_mainAssetsAreMutable = false;
+        // executed in place, only an unaligned image is copied to RAM because asset structures are read with word loads
+        if ((uintptr_t)assets & 3) {
+            auto alignedAssets = (uint8_t *)eez::alloc(assetsSize, 0x2f8c61d4);
+            if (!alignedAssets) {
+                ErrorTrace("Not enough memory for the aligned assets copy\n");
+                return false;
+            }
+            memcpy(alignedAssets, assets, assetsSize);
+            assets = alignedAssets;
+            runtimeContext->loadedAssetsMemory = alignedAssets;
+        }
+        runtimeContext->loadedAssets = (Assets *)(assets + sizeof(uint32_t));
+		runtimeContext->loadedAssetsAreMutable = false;
     } else {
         uint8_t *DECOMPRESSED_ASSETS_START_ADDRESS = 0;
         uint32_t MAX_DECOMPRESSED_ASSETS_SIZE = 0;
         allocMemoryForDecompressedAssets(assets, assetsSize, DECOMPRESSED_ASSETS_START_ADDRESS, MAX_DECOMPRESSED_ASSETS_SIZE);
-        g_mainAssets = (Assets *)DECOMPRESSED_ASSETS_START_ADDRESS;
-		g_mainAssetsAreMutable = true;
-        g_mainAssets->external = false;
-        auto decompressedSize = decompressAssetsData(assets, assetsSize, g_mainAssets, MAX_DECOMPRESSED_ASSETS_SIZE, nullptr);
-        assert(decompressedSize);
+        if (!DECOMPRESSED_ASSETS_START_ADDRESS) {
+            ErrorTrace("Not enough memory for the decompressed assets\n");
+            return false;
+        }
+        runtimeContext->loadedAssets = (Assets *)DECOMPRESSED_ASSETS_START_ADDRESS;
+		runtimeContext->loadedAssetsAreMutable = true;
+        runtimeContext->loadedAssetsMemory = DECOMPRESSED_ASSETS_START_ADDRESS;
+        runtimeContext->loadedAssets->external = false;
+        bool result;
+#if EEZ_FOR_LVGL_LZ4_OPTION
+        if (header->tag == HEADER_TAG_SECTIONED) {
+            result = decompressAssetsSections(assets, assetsSize, runtimeContext->loadedAssets, MAX_DECOMPRESSED_ASSETS_SIZE, true, nullptr);
+            if (result) {
+                registerLazyAssetsSections(assets, assetsSize);
+            }
+        } else
+#endif
+        result = decompressAssetsData(assets, assetsSize, runtimeContext->loadedAssets, MAX_DECOMPRESSED_ASSETS_SIZE, nullptr);
+        if (!result) {
+            ErrorTrace("Invalid assets data\n");
+            unloadMainAssets();
+            return false;
+        }
+    }
+    return true;
+}
+Assets *loadAssets(const uint8_t *assetsData, uint32_t assetsDataSize, uint8_t *&assetsMemory) {
+    assetsMemory = nullptr;
+    auto header = (Header *)assetsData;
+#if EEZ_OPTION_ASSETS_ABSOLUTE_POINTERS
+    if (header->tag != HEADER_TAG_SECTIONED) {
+        return nullptr;
+    }
+#endif
+    if (header->tag == HEADER_TAG) {
+        if ((uintptr_t)assetsData & 3) {
+            assetsMemory = (uint8_t *)eez::alloc(assetsDataSize, 0x2f8c61d4);
+            if (!assetsMemory) {
+                return nullptr;
+            }
+            memcpy(assetsMemory, assetsData, assetsDataSize);
+            assetsData = assetsMemory;
+        }
+        return (Assets *)(assetsData + sizeof(uint32_t));
+    }
+    if (header->tag != HEADER_TAG_COMPRESSED && header->tag != HEADER_TAG_SECTIONED) {
+        return nullptr;
+    }
+    uint32_t assetsMemorySize = getDecompressedDataOffset() + header->decompressedSize;
+    assetsMemory = (uint8_t *)eez::alloc(assetsMemorySize, 0x5c0e7b21);
+    if (!assetsMemory) {
+        return nullptr;
+    }
+    auto assets = (Assets *)assetsMemory;
+    assets->external = false;
+    int err;
+    if (!decompressAssetsData(assetsData, assetsDataSize, assets, assetsMemorySize, &err)) {
+        eez::free(assetsMemory);
+        assetsMemory = nullptr;
+        return nullptr;
+    }
+    return assets;
+}
+void unloadAssets(uint8_t *assetsMemory) {
+    auto runtimeContext = flow::g_runtimeContext;
+    if (assetsMemory) {
+        if (assetsMemory == runtimeContext->releasedAssetsMemory) {
+            runtimeContext->releasedAssets = nullptr;
+            runtimeContext->releasedAssetsMemory = nullptr;
+        }
+        eez::free(assetsMemory);
+    }
+}
+uint8_t *releaseMainAssetsMemory() {
+    auto runtimeContext = flow::g_runtimeContext;
+    if (runtimeContext->numLazyAssetsSections > 0) {
+        runtimeContext->releasedAssets = runtimeContext->loadedAssets;
+        runtimeContext->releasedAssetsMemory = runtimeContext->loadedAssetsMemory;
     }
+    for (uint32_t i = 0; i < runtimeContext->numLazyAssetsSections; i++) {
+        if (runtimeContext->lazyAssetsSections[i].buffer) {
+            eez::free(runtimeContext->lazyAssetsSections[i].buffer);
+        }
+    }
+    runtimeContext->numLazyAssetsSections = 0;
+    auto assetsMemory = runtimeContext->loadedAssetsMemory;
+    runtimeContext->loadedAssetsMemory = nullptr;
+    return assetsMemory;
+}
+void unloadMainAssets() {
+    unloadAssets(releaseMainAssetsMemory());
+    flow::g_runtimeContext->loadedAssets = nullptr;
 }
 int getThemesCount() {
-	return (int)g_mainAssets->colorsDefinition->themes.count;
+	return (int)flow::g_runtimeContext->loadedAssets->colorsDefinition->themes.count;
 }
 static Theme *getTheme(int i) {
-    if (i < 0 || i >= (int)g_mainAssets->colorsDefinition->themes.count) {
+    if (i < 0 || i >= (int)flow::g_runtimeContext->loadedAssets->colorsDefinition->themes.count) {
         return nullptr;
     }
-    return g_mainAssets->colorsDefinition->themes[i];
+    return flow::g_runtimeContext->loadedAssets->colorsDefinition->themes[i];
 }
 const char *getThemeName(int i) {
     auto theme = getTheme(i);
@@ -215,7 +778,7 @@ const uint16_t *getThemeColors(int themeIndex) {
 	return static_cast<uint16_t *>(theme->colors.items);
 }
 const uint16_t *getColors() {
-	return static_cast<uint16_t *>(g_mainAssets->colorsDefinition->colors.items);
+	return static_cast<uint16_t *>(flow::g_runtimeContext->loadedAssets->colorsDefinition->colors.items);
 }
 } 
 // -----------------------------------------------------------------------------
@@ -520,6 +1083,9 @@ Unit getSmallestUnit(Unit unit, float min, float precision) {
 #include <stdio.h>
 #include <ctype.h>
 #include <string.h>
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
 namespace eez {
 float remap(float x, float x1, float y1, float x2, float y2) {
     return y1 + (x - x1) * (y2 - y1) / (x2 - x1);
@@ -659,18 +1225,326 @@ void stringAppendLoad(char *str, size_t maxStrLength, float value) {
         snprintf(str + n, maxStrLength - n, "%g Mohm", value / 1000000);
     }
 }
-uint32_t crc32(const uint8_t *mem_block, size_t block_size) {
-    uint32_t crc = 0xFFFFFFFF;
-    for (size_t i = 0; i < block_size; ++i) {
-        uint32_t byte = mem_block[i]; 
-        crc = crc ^ byte;
-        for (int j = 0; j < 8; ++j) { 
-            uint32_t mask = -((int32_t)crc & 1);
-            crc = (crc >> 1) ^ (0xEDB88320 & mask);
-        }
+static const uint32_t CRC32_TABLE[8][256] = {
+    {
+        0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F, 0xE963A535, 0x9E6495A3,
+        0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988, 0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91,
+        0x1DB71064, 0x6AB020F2, 0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7,
+        0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC, 0x14015C4F, 0x63066CD9, 0xFA0F3D63, 0x8D080DF5,
+        0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172, 0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B,
+        0x35B5A8FA, 0x42B2986C, 0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
+        0x26D930AC, 0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423, 0xCFBA9599, 0xB8BDA50F,
+        0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924, 0x2F6F7C87, 0x58684C11, 0xC1611DAB, 0xB6662D3D,
+        0x76DC4190, 0x01DB7106, 0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F, 0x9FBFE4A5, 0xE8B8D433,
+        0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB, 0x086D3D2D, 0x91646C97, 0xE6635C01,
+        0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E, 0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457,
+        0x65B0D9C6, 0x12B7E950, 0x8BBEB8EA, 0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65,
+        0x4DB26158, 0x3AB551CE, 0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7, 0xA4D1C46D, 0xD3D6F4FB,
+        0x4369E96A, 0x346ED9FC, 0xAD678846, 0xDA60B8D0, 0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9,
+        0x5005713C, 0x270241AA, 0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409, 0xCE61E49F,
+        0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81, 0xB7BD5C3B, 0xC0BA6CAD,
+        0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A, 0xEAD54739, 0x9DD277AF, 0x04DB2615, 0x73DC1683,
+        0xE3630B12, 0x94643B84, 0x0D6D6A3E, 0x7A6A5AA8, 0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1,
+        0xF00F9344, 0x8708A3D2, 0x1E01F268, 0x6906C2FE, 0xF762575D, 0x806567CB, 0x196C3671, 0x6E6B06E7,
+        0xFED41B76, 0x89D32BE0, 0x10DA7A5A, 0x67DD4ACC, 0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5,
+        0xD6D6A3E8, 0xA1D1937E, 0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
+        0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55, 0x316E8EEF, 0x4669BE79,
+        0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236, 0xCC0C7795, 0xBB0B4703, 0x220216B9, 0x5505262F,
+        0xC5BA3BBE, 0xB2BD0B28, 0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7, 0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D,
+        0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A, 0x9C0906A9, 0xEB0E363F, 0x72076785, 0x05005713,
+        0x95BF4A82, 0xE2B87A14, 0x7BB12BAE, 0x0CB61B38, 0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21,
+        0x86D3D2D4, 0xF1D4E242, 0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777,
+        0x88085AE6, 0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69, 0x616BFFD3, 0x166CCF45,
+        0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2, 0xA7672661, 0xD06016F7, 0x4969474D, 0x3E6E77DB,
+        0xAED16A4A, 0xD9D65ADC, 0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5, 0x47B2CF7F, 0x30B5FFE9,
+        0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693, 0x54DE5729, 0x23D967BF,
+        0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94, 0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
+    },
+    {
+        0x00000000, 0x191B3141, 0x32366282, 0x2B2D53C3, 0x646CC504, 0x7D77F445, 0x565AA786, 0x4F4196C7,
+        0xC8D98A08, 0xD1C2BB49, 0xFAEFE88A, 0xE3F4D9CB, 0xACB54F0C, 0xB5AE7E4D, 0x9E832D8E, 0x87981CCF,
+        0x4AC21251, 0x53D92310, 0x78F470D3, 0x61EF4192, 0x2EAED755, 0x37B5E614, 0x1C98B5D7, 0x05838496,
+        0x821B9859, 0x9B00A918, 0xB02DFADB, 0xA936CB9A, 0xE6775D5D, 0xFF6C6C1C, 0xD4413FDF, 0xCD5A0E9E,
+        0x958424A2, 0x8C9F15E3, 0xA7B24620, 0xBEA97761, 0xF1E8E1A6, 0xE8F3D0E7, 0xC3DE8324, 0xDAC5B265,
+        0x5D5DAEAA, 0x44469FEB, 0x6F6BCC28, 0x7670FD69, 0x39316BAE, 0x202A5AEF, 0x0B07092C, 0x121C386D,
+        0xDF4636F3, 0xC65D07B2, 0xED705471, 0xF46B6530, 0xBB2AF3F7, 0xA231C2B6, 0x891C9175, 0x9007A034,
+        0x179FBCFB, 0x0E848DBA, 0x25A9DE79, 0x3CB2EF38, 0x73F379FF, 0x6AE848BE, 0x41C51B7D, 0x58DE2A3C,
+        0xF0794F05, 0xE9627E44, 0xC24F2D87, 0xDB541CC6, 0x94158A01, 0x8D0EBB40, 0xA623E883, 0xBF38D9C2,
+        0x38A0C50D, 0x21BBF44C, 0x0A96A78F, 0x138D96CE, 0x5CCC0009, 0x45D73148, 0x6EFA628B, 0x77E153CA,
+        0xBABB5D54, 0xA3A06C15, 0x888D3FD6, 0x91960E97, 0xDED79850, 0xC7CCA911, 0xECE1FAD2, 0xF5FACB93,
+        0x7262D75C, 0x6B79E61D, 0x4054B5DE, 0x594F849F, 0x160E1258, 0x0F152319, 0x243870DA, 0x3D23419B,
+        0x65FD6BA7, 0x7CE65AE6, 0x57CB0925, 0x4ED03864, 0x0191AEA3, 0x188A9FE2, 0x33A7CC21, 0x2ABCFD60,
+        0xAD24E1AF, 0xB43FD0EE, 0x9F12832D, 0x8609B26C, 0xC94824AB, 0xD05315EA, 0xFB7E4629, 0xE2657768,
+        0x2F3F79F6, 0x362448B7, 0x1D091B74, 0x04122A35, 0x4B53BCF2, 0x52488DB3, 0x7965DE70, 0x607EEF31,
+        0xE7E6F3FE, 0xFEFDC2BF, 0xD5D0917C, 0xCCCBA03D, 0x838A36FA, 0x9A9107BB, 0xB1BC5478, 0xA8A76539,
+        0x3B83984B, 0x2298A90A, 0x09B5FAC9, 0x10AECB88, 0x5FEF5D4F, 0x46F46C0E, 0x6DD93FCD, 0x74C20E8C,
+        0xF35A1243, 0xEA412302, 0xC16C70C1, 0xD8774180, 0x9736D747, 0x8E2DE606, 0xA500B5C5, 0xBC1B8484,
+        0x71418A1A, 0x685ABB5B, 0x4377E898, 0x5A6CD9D9, 0x152D4F1E, 0x0C367E5F, 0x271B2D9C, 0x3E001CDD,
+        0xB9980012, 0xA0833153, 0x8BAE6290, 0x92B553D1, 0xDDF4C516, 0xC4EFF457, 0xEFC2A794, 0xF6D996D5,
+        0xAE07BCE9, 0xB71C8DA8, 0x9C31DE6B, 0x852AEF2A, 0xCA6B79ED, 0xD37048AC, 0xF85D1B6F, 0xE1462A2E,
+        0x66DE36E1, 0x7FC507A0, 0x54E85463, 0x4DF36522, 0x02B2F3E5, 0x1BA9C2A4, 0x30849167, 0x299FA026,
+        0xE4C5AEB8, 0xFDDE9FF9, 0xD6F3CC3A, 0xCFE8FD7B, 0x80A96BBC, 0x99B25AFD, 0xB29F093E, 0xAB84387F,
+        0x2C1C24B0, 0x350715F1, 0x1E2A4632, 0x07317773, 0x4870E1B4, 0x516BD0F5, 0x7A468336, 0x635DB277,
+        0xCBFAD74E, 0xD2E1E60F, 0xF9CCB5CC, 0xE0D7848D, 0xAF96124A, 0xB68D230B, 0x9DA070C8, 0x84BB4189,
+        0x03235D46, 0x1A386C07, 0x31153FC4, 0x280E0E85, 0x674F9842, 0x7E54A903, 0x5579FAC0, 0x4C62CB81,
+        0x8138C51F, 0x9823F45E, 0xB30EA79D, 0xAA1596DC, 0xE554001B, 0xFC4F315A, 0xD7626299, 0xCE7953D8,
+        0x49E14F17, 0x50FA7E56, 0x7BD72D95, 0x62CC1CD4, 0x2D8D8A13, 0x3496BB52, 0x1FBBE891, 0x06A0D9D0,
+        0x5E7EF3EC, 0x4765C2AD, 0x6C48916E, 0x7553A02F, 0x3A1236E8, 0x230907A9, 0x0824546A, 0x113F652B,
+        0x96A779E4, 0x8FBC48A5, 0xA4911B66, 0xBD8A2A27, 0xF2CBBCE0, 0xEBD08DA1, 0xC0FDDE62, 0xD9E6EF23,
+        0x14BCE1BD, 0x0DA7D0FC, 0x268A833F, 0x3F91B27E, 0x70D024B9, 0x69CB15F8, 0x42E6463B, 0x5BFD777A,
+        0xDC656BB5, 0xC57E5AF4, 0xEE530937, 0xF7483876, 0xB809AEB1, 0xA1129FF0, 0x8A3FCC33, 0x9324FD72
+    },
+    {
+        0x00000000, 0x01C26A37, 0x0384D46E, 0x0246BE59, 0x0709A8DC, 0x06CBC2EB, 0x048D7CB2, 0x054F1685,
+        0x0E1351B8, 0x0FD13B8F, 0x0D9785D6, 0x0C55EFE1, 0x091AF964, 0x08D89353, 0x0A9E2D0A, 0x0B5C473D,
+        0x1C26A370, 0x1DE4C947, 0x1FA2771E, 0x1E601D29, 0x1B2F0BAC, 0x1AED619B, 0x18ABDFC2, 0x1969B5F5,
+        0x1235F2C8, 0x13F798FF, 0x11B126A6, 0x10734C91, 0x153C5A14, 0x14FE3023, 0x16B88E7A, 0x177AE44D,
+        0x384D46E0, 0x398F2CD7, 0x3BC9928E, 0x3A0BF8B9, 0x3F44EE3C, 0x3E86840B, 0x3CC03A52, 0x3D025065,
+        0x365E1758, 0x379C7D6F, 0x35DAC336, 0x3418A901, 0x3157BF84, 0x3095D5B3, 0x32D36BEA, 0x331101DD,
+        0x246BE590, 0x25A98FA7, 0x27EF31FE, 0x262D5BC9, 0x23624D4C, 0x22A0277B, 0x20E69922, 0x2124F315,
+        0x2A78B428, 0x2BBADE1F, 0x29FC6046, 0x283E0A71, 0x2D711CF4, 0x2CB376C3, 0x2EF5C89A, 0x2F37A2AD,
+        0x709A8DC0, 0x7158E7F7, 0x731E59AE, 0x72DC3399, 0x7793251C, 0x76514F2B, 0x7417F172, 0x75D59B45,
+        0x7E89DC78, 0x7F4BB64F, 0x7D0D0816, 0x7CCF6221, 0x798074A4, 0x78421E93, 0x7A04A0CA, 0x7BC6CAFD,
+        0x6CBC2EB0, 0x6D7E4487, 0x6F38FADE, 0x6EFA90E9, 0x6BB5866C, 0x6A77EC5B, 0x68315202, 0x69F33835,
+        0x62AF7F08, 0x636D153F, 0x612BAB66, 0x60E9C151, 0x65A6D7D4, 0x6464BDE3, 0x662203BA, 0x67E0698D,
+        0x48D7CB20, 0x4915A117, 0x4B531F4E, 0x4A917579, 0x4FDE63FC, 0x4E1C09CB, 0x4C5AB792, 0x4D98DDA5,
+        0x46C49A98, 0x4706F0AF, 0x45404EF6, 0x448224C1, 0x41CD3244, 0x400F5873, 0x4249E62A, 0x438B8C1D,
+        0x54F16850, 0x55330267, 0x5775BC3E, 0x56B7D609, 0x53F8C08C, 0x523AAABB, 0x507C14E2, 0x51BE7ED5,
+        0x5AE239E8, 0x5B2053DF, 0x5966ED86, 0x58A487B1, 0x5DEB9134, 0x5C29FB03, 0x5E6F455A, 0x5FAD2F6D,
+        0xE1351B80, 0xE0F771B7, 0xE2B1CFEE, 0xE373A5D9, 0xE63CB35C, 0xE7FED96B, 0xE5B86732, 0xE47A0D05,
+        0xEF264A38, 0xEEE4200F, 0xECA29E56, 0xED60F461, 0xE82FE2E4, 0xE9ED88D3, 0xEBAB368A, 0xEA695CBD,
+        0xFD13B8F0, 0xFCD1D2C7, 0xFE976C9E, 0xFF5506A9, 0xFA1A102C, 0xFBD87A1B, 0xF99EC442, 0xF85CAE75,
+        0xF300E948, 0xF2C2837F, 0xF0843D26, 0xF1465711, 0xF4094194, 0xF5CB2BA3, 0xF78D95FA, 0xF64FFFCD,
+        0xD9785D60, 0xD8BA3757, 0xDAFC890E, 0xDB3EE339, 0xDE71F5BC, 0xDFB39F8B, 0xDDF521D2, 0xDC374BE5,
+        0xD76B0CD8, 0xD6A966EF, 0xD4EFD8B6, 0xD52DB281, 0xD062A404, 0xD1A0CE33, 0xD3E6706A, 0xD2241A5D,
+        0xC55EFE10, 0xC49C9427, 0xC6DA2A7E, 0xC7184049, 0xC25756CC, 0xC3953CFB, 0xC1D382A2, 0xC011E895,
+        0xCB4DAFA8, 0xCA8FC59F, 0xC8C97BC6, 0xC90B11F1, 0xCC440774, 0xCD866D43, 0xCFC0D31A, 0xCE02B92D,
+        0x91AF9640, 0x906DFC77, 0x922B422E, 0x93E92819, 0x96A63E9C, 0x976454AB, 0x9522EAF2, 0x94E080C5,
+        0x9FBCC7F8, 0x9E7EADCF, 0x9C381396, 0x9DFA79A1, 0x98B56F24, 0x99770513, 0x9B31BB4A, 0x9AF3D17D,
+        0x8D893530, 0x8C4B5F07, 0x8E0DE15E, 0x8FCF8B69, 0x8A809DEC, 0x8B42F7DB, 0x89044982, 0x88C623B5,
+        0x839A6488, 0x82580EBF, 0x801EB0E6, 0x81DCDAD1, 0x8493CC54, 0x8551A663, 0x8717183A, 0x86D5720D,
+        0xA9E2D0A0, 0xA820BA97, 0xAA6604CE, 0xABA46EF9, 0xAEEB787C, 0xAF29124B, 0xAD6FAC12, 0xACADC625,
+        0xA7F18118, 0xA633EB2F, 0xA4755576, 0xA5B73F41, 0xA0F829C4, 0xA13A43F3, 0xA37CFDAA, 0xA2BE979D,
+        0xB5C473D0, 0xB40619E7, 0xB640A7BE, 0xB782CD89, 0xB2CDDB0C, 0xB30FB13B, 0xB1490F62, 0xB08B6555,
+        0xBBD72268, 0xBA15485F, 0xB853F606, 0xB9919C31, 0xBCDE8AB4, 0xBD1CE083, 0xBF5A5EDA, 0xBE9834ED
+    },
+    {
+        0x00000000, 0xB8BC6765, 0xAA09C88B, 0x12B5AFEE, 0x8F629757, 0x37DEF032, 0x256B5FDC, 0x9DD738B9,
+        0xC5B428EF, 0x7D084F8A, 0x6FBDE064, 0xD7018701, 0x4AD6BFB8, 0xF26AD8DD, 0xE0DF7733, 0x58631056,
+        0x5019579F, 0xE8A530FA, 0xFA109F14, 0x42ACF871, 0xDF7BC0C8, 0x67C7A7AD, 0x75720843, 0xCDCE6F26,
+        0x95AD7F70, 0x2D111815, 0x3FA4B7FB, 0x8718D09E, 0x1ACFE827, 0xA2738F42, 0xB0C620AC, 0x087A47C9,
+        0xA032AF3E, 0x188EC85B, 0x0A3B67B5, 0xB28700D0, 0x2F503869, 0x97EC5F0C, 0x8559F0E2, 0x3DE59787,
+        0x658687D1, 0xDD3AE0B4, 0xCF8F4F5A, 0x7733283F, 0xEAE41086, 0x525877E3, 0x40EDD80D, 0xF851BF68,
+        0xF02BF8A1, 0x48979FC4, 0x5A22302A, 0xE29E574F, 0x7F496FF6, 0xC7F50893, 0xD540A77D, 0x6DFCC018,
+        0x359FD04E, 0x8D23B72B, 0x9F9618C5, 0x272A7FA0, 0xBAFD4719, 0x0241207C, 0x10F48F92, 0xA848E8F7,
+        0x9B14583D, 0x23A83F58, 0x311D90B6, 0x89A1F7D3, 0x1476CF6A, 0xACCAA80F, 0xBE7F07E1, 0x06C36084,
+        0x5EA070D2, 0xE61C17B7, 0xF4A9B859, 0x4C15DF3C, 0xD1C2E785, 0x697E80E0, 0x7BCB2F0E, 0xC377486B,
+        0xCB0D0FA2, 0x73B168C7, 0x6104C729, 0xD9B8A04C, 0x446F98F5, 0xFCD3FF90, 0xEE66507E, 0x56DA371B,
+        0x0EB9274D, 0xB6054028, 0xA4B0EFC6, 0x1C0C88A3, 0x81DBB01A, 0x3967D77F, 0x2BD27891, 0x936E1FF4,
+        0x3B26F703, 0x839A9066, 0x912F3F88, 0x299358ED, 0xB4446054, 0x0CF80731, 0x1E4DA8DF, 0xA6F1CFBA,
+        0xFE92DFEC, 0x462EB889, 0x549B1767, 0xEC277002, 0x71F048BB, 0xC94C2FDE, 0xDBF98030, 0x6345E755,
+        0x6B3FA09C, 0xD383C7F9, 0xC1366817, 0x798A0F72, 0xE45D37CB, 0x5CE150AE, 0x4E54FF40, 0xF6E89825,
+        0xAE8B8873, 0x1637EF16, 0x048240F8, 0xBC3E279D, 0x21E91F24, 0x99557841, 0x8BE0D7AF, 0x335CB0CA,
+        0xED59B63B, 0x55E5D15E, 0x47507EB0, 0xFFEC19D5, 0x623B216C, 0xDA874609, 0xC832E9E7, 0x708E8E82,
+        0x28ED9ED4, 0x9051F9B1, 0x82E4565F, 0x3A58313A, 0xA78F0983, 0x1F336EE6, 0x0D86C108, 0xB53AA66D,
+        0xBD40E1A4, 0x05FC86C1, 0x1749292F, 0xAFF54E4A, 0x322276F3, 0x8A9E1196, 0x982BBE78, 0x2097D91D,
+        0x78F4C94B, 0xC048AE2E, 0xD2FD01C0, 0x6A4166A5, 0xF7965E1C, 0x4F2A3979, 0x5D9F9697, 0xE523F1F2,
+        0x4D6B1905, 0xF5D77E60, 0xE762D18E, 0x5FDEB6EB, 0xC2098E52, 0x7AB5E937, 0x680046D9, 0xD0BC21BC,
+        0x88DF31EA, 0x3063568F, 0x22D6F961, 0x9A6A9E04, 0x07BDA6BD, 0xBF01C1D8, 0xADB46E36, 0x15080953,
+        0x1D724E9A, 0xA5CE29FF, 0xB77B8611, 0x0FC7E174, 0x9210D9CD, 0x2AACBEA8, 0x38191146, 0x80A57623,
+        0xD8C66675, 0x607A0110, 0x72CFAEFE, 0xCA73C99B, 0x57A4F122, 0xEF189647, 0xFDAD39A9, 0x45115ECC,
+        0x764DEE06, 0xCEF18963, 0xDC44268D, 0x64F841E8, 0xF92F7951, 0x41931E34, 0x5326B1DA, 0xEB9AD6BF,
+        0xB3F9C6E9, 0x0B45A18C, 0x19F00E62, 0xA14C6907, 0x3C9B51BE, 0x842736DB, 0x96929935, 0x2E2EFE50,
+        0x2654B999, 0x9EE8DEFC, 0x8C5D7112, 0x34E11677, 0xA9362ECE, 0x118A49AB, 0x033FE645, 0xBB838120,
+        0xE3E09176, 0x5B5CF613, 0x49E959FD, 0xF1553E98, 0x6C820621, 0xD43E6144, 0xC68BCEAA, 0x7E37A9CF,
+        0xD67F4138, 0x6EC3265D, 0x7C7689B3, 0xC4CAEED6, 0x591DD66F, 0xE1A1B10A, 0xF3141EE4, 0x4BA87981,
+        0x13CB69D7, 0xAB770EB2, 0xB9C2A15C, 0x017EC639, 0x9CA9FE80, 0x241599E5, 0x36A0360B, 0x8E1C516E,
+        0x866616A7, 0x3EDA71C2, 0x2C6FDE2C, 0x94D3B949, 0x090481F0, 0xB1B8E695, 0xA30D497B, 0x1BB12E1E,
+        0x43D23E48, 0xFB6E592D, 0xE9DBF6C3, 0x516791A6, 0xCCB0A91F, 0x740CCE7A, 0x66B96194, 0xDE0506F1
+    },
+    {
+        0x00000000, 0x3D6029B0, 0x7AC05360, 0x47A07AD0, 0xF580A6C0, 0xC8E08F70, 0x8F40F5A0, 0xB220DC10,
+        0x30704BC1, 0x0D106271, 0x4AB018A1, 0x77D03111, 0xC5F0ED01, 0xF890C4B1, 0xBF30BE61, 0x825097D1,
+        0x60E09782, 0x5D80BE32, 0x1A20C4E2, 0x2740ED52, 0x95603142, 0xA80018F2, 0xEFA06222, 0xD2C04B92,
+        0x5090DC43, 0x6DF0F5F3, 0x2A508F23, 0x1730A693, 0xA5107A83, 0x98705333, 0xDFD029E3, 0xE2B00053,
+        0xC1C12F04, 0xFCA106B4, 0xBB017C64, 0x866155D4, 0x344189C4, 0x0921A074, 0x4E81DAA4, 0x73E1F314,
+        0xF1B164C5, 0xCCD14D75, 0x8B7137A5, 0xB6111E15, 0x0431C205, 0x3951EBB5, 0x7EF19165, 0x4391B8D5,
+        0xA121B886, 0x9C419136, 0xDBE1EBE6, 0xE681C256, 0x54A11E46, 0x69C137F6, 0x2E614D26, 0x13016496,
+        0x9151F347, 0xAC31DAF7, 0xEB91A027, 0xD6F18997, 0x64D15587, 0x59B17C37, 0x1E1106E7, 0x23712F57,
+        0x58F35849, 0x659371F9, 0x22330B29, 0x1F532299, 0xAD73FE89, 0x9013D739, 0xD7B3ADE9, 0xEAD38459,
+        0x68831388, 0x55E33A38, 0x124340E8, 0x2F236958, 0x9D03B548, 0xA0639CF8, 0xE7C3E628, 0xDAA3CF98,
+        0x3813CFCB, 0x0573E67B, 0x42D39CAB, 0x7FB3B51B, 0xCD93690B, 0xF0F340BB, 0xB7533A6B, 0x8A3313DB,
+        0x0863840A, 0x3503ADBA, 0x72A3D76A, 0x4FC3FEDA, 0xFDE322CA, 0xC0830B7A, 0x872371AA, 0xBA43581A,
+        0x9932774D, 0xA4525EFD, 0xE3F2242D, 0xDE920D9D, 0x6CB2D18D, 0x51D2F83D, 0x167282ED, 0x2B12AB5D,
+        0xA9423C8C, 0x9422153C, 0xD3826FEC, 0xEEE2465C, 0x5CC29A4C, 0x61A2B3FC, 0x2602C92C, 0x1B62E09C,
+        0xF9D2E0CF, 0xC4B2C97F, 0x8312B3AF, 0xBE729A1F, 0x0C52460F, 0x31326FBF, 0x7692156F, 0x4BF23CDF,
+        0xC9A2AB0E, 0xF4C282BE, 0xB362F86E, 0x8E02D1DE, 0x3C220DCE, 0x0142247E, 0x46E25EAE, 0x7B82771E,
+        0xB1E6B092, 0x8C869922, 0xCB26E3F2, 0xF646CA42, 0x44661652, 0x79063FE2, 0x3EA64532, 0x03C66C82,
+        0x8196FB53, 0xBCF6D2E3, 0xFB56A833, 0xC6368183, 0x74165D93, 0x49767423, 0x0ED60EF3, 0x33B62743,
+        0xD1062710, 0xEC660EA0, 0xABC67470, 0x96A65DC0, 0x248681D0, 0x19E6A860, 0x5E46D2B0, 0x6326FB00,
+        0xE1766CD1, 0xDC164561, 0x9BB63FB1, 0xA6D61601, 0x14F6CA11, 0x2996E3A1, 0x6E369971, 0x5356B0C1,
+        0x70279F96, 0x4D47B626, 0x0AE7CCF6, 0x3787E546, 0x85A73956, 0xB8C710E6, 0xFF676A36, 0xC2074386,
+        0x4057D457, 0x7D37FDE7, 0x3A978737, 0x07F7AE87, 0xB5D77297, 0x88B75B27, 0xCF1721F7, 0xF2770847,
+        0x10C70814, 0x2DA721A4, 0x6A075B74, 0x576772C4, 0xE547AED4, 0xD8278764, 0x9F87FDB4, 0xA2E7D404,
+        0x20B743D5, 0x1DD76A65, 0x5A7710B5, 0x67173905, 0xD537E515, 0xE857CCA5, 0xAFF7B675, 0x92979FC5,
+        0xE915E8DB, 0xD475C16B, 0x93D5BBBB, 0xAEB5920B, 0x1C954E1B, 0x21F567AB, 0x66551D7B, 0x5B3534CB,
+        0xD965A31A, 0xE4058AAA, 0xA3A5F07A, 0x9EC5D9CA, 0x2CE505DA, 0x11852C6A, 0x562556BA, 0x6B457F0A,
+        0x89F57F59, 0xB49556E9, 0xF3352C39, 0xCE550589, 0x7C75D999, 0x4115F029, 0x06B58AF9, 0x3BD5A349,
+        0xB9853498, 0x84E51D28, 0xC34567F8, 0xFE254E48, 0x4C059258, 0x7165BBE8, 0x36C5C138, 0x0BA5E888,
+        0x28D4C7DF, 0x15B4EE6F, 0x521494BF, 0x6F74BD0F, 0xDD54611F, 0xE03448AF, 0xA794327F, 0x9AF41BCF,
+        0x18A48C1E, 0x25C4A5AE, 0x6264DF7E, 0x5F04F6CE, 0xED242ADE, 0xD044036E, 0x97E479BE, 0xAA84500E,
+        0x4834505D, 0x755479ED, 0x32F4033D, 0x0F942A8D, 0xBDB4F69D, 0x80D4DF2D, 0xC774A5FD, 0xFA148C4D,
+        0x78441B9C, 0x4524322C, 0x028448FC, 0x3FE4614C, 0x8DC4BD5C, 0xB0A494EC, 0xF704EE3C, 0xCA64C78C
+    },
+    {
+        0x00000000, 0xCB5CD3A5, 0x4DC8A10B, 0x869472AE, 0x9B914216, 0x50CD91B3, 0xD659E31D, 0x1D0530B8,
+        0xEC53826D, 0x270F51C8, 0xA19B2366, 0x6AC7F0C3, 0x77C2C07B, 0xBC9E13DE, 0x3A0A6170, 0xF156B2D5,
+        0x03D6029B, 0xC88AD13E, 0x4E1EA390, 0x85427035, 0x9847408D, 0x531B9328, 0xD58FE186, 0x1ED33223,
+        0xEF8580F6, 0x24D95353, 0xA24D21FD, 0x6911F258, 0x7414C2E0, 0xBF481145, 0x39DC63EB, 0xF280B04E,
+        0x07AC0536, 0xCCF0D693, 0x4A64A43D, 0x81387798, 0x9C3D4720, 0x57619485, 0xD1F5E62B, 0x1AA9358E,
+        0xEBFF875B, 0x20A354FE, 0xA6372650, 0x6D6BF5F5, 0x706EC54D, 0xBB3216E8, 0x3DA66446, 0xF6FAB7E3,
+        0x047A07AD, 0xCF26D408, 0x49B2A6A6, 0x82EE7503, 0x9FEB45BB, 0x54B7961E, 0xD223E4B0, 0x197F3715,
+        0xE82985C0, 0x23755665, 0xA5E124CB, 0x6EBDF76E, 0x73B8C7D6, 0xB8E41473, 0x3E7066DD, 0xF52CB578,
+        0x0F580A6C, 0xC404D9C9, 0x4290AB67, 0x89CC78C2, 0x94C9487A, 0x5F959BDF, 0xD901E971, 0x125D3AD4,
+        0xE30B8801, 0x28575BA4, 0xAEC3290A, 0x659FFAAF, 0x789ACA17, 0xB3C619B2, 0x35526B1C, 0xFE0EB8B9,
+        0x0C8E08F7, 0xC7D2DB52, 0x4146A9FC, 0x8A1A7A59, 0x971F4AE1, 0x5C439944, 0xDAD7EBEA, 0x118B384F,
+        0xE0DD8A9A, 0x2B81593F, 0xAD152B91, 0x6649F834, 0x7B4CC88C, 0xB0101B29, 0x36846987, 0xFDD8BA22,
+        0x08F40F5A, 0xC3A8DCFF, 0x453CAE51, 0x8E607DF4, 0x93654D4C, 0x58399EE9, 0xDEADEC47, 0x15F13FE2,
+        0xE4A78D37, 0x2FFB5E92, 0xA96F2C3C, 0x6233FF99, 0x7F36CF21, 0xB46A1C84, 0x32FE6E2A, 0xF9A2BD8F,
+        0x0B220DC1, 0xC07EDE64, 0x46EAACCA, 0x8DB67F6F, 0x90B34FD7, 0x5BEF9C72, 0xDD7BEEDC, 0x16273D79,
+        0xE7718FAC, 0x2C2D5C09, 0xAAB92EA7, 0x61E5FD02, 0x7CE0CDBA, 0xB7BC1E1F, 0x31286CB1, 0xFA74BF14,
+        0x1EB014D8, 0xD5ECC77D, 0x5378B5D3, 0x98246676, 0x852156CE, 0x4E7D856B, 0xC8E9F7C5, 0x03B52460,
+        0xF2E396B5, 0x39BF4510, 0xBF2B37BE, 0x7477E41B, 0x6972D4A3, 0xA22E0706, 0x24BA75A8, 0xEFE6A60D,
+        0x1D661643, 0xD63AC5E6, 0x50AEB748, 0x9BF264ED, 0x86F75455, 0x4DAB87F0, 0xCB3FF55E, 0x006326FB,
+        0xF135942E, 0x3A69478B, 0xBCFD3525, 0x77A1E680, 0x6AA4D638, 0xA1F8059D, 0x276C7733, 0xEC30A496,
+        0x191C11EE, 0xD240C24B, 0x54D4B0E5, 0x9F886340, 0x828D53F8, 0x49D1805D, 0xCF45F2F3, 0x04192156,
+        0xF54F9383, 0x3E134026, 0xB8873288, 0x73DBE12D, 0x6EDED195, 0xA5820230, 0x2316709E, 0xE84AA33B,
+        0x1ACA1375, 0xD196C0D0, 0x5702B27E, 0x9C5E61DB, 0x815B5163, 0x4A0782C6, 0xCC93F068, 0x07CF23CD,
+        0xF6999118, 0x3DC542BD, 0xBB513013, 0x700DE3B6, 0x6D08D30E, 0xA65400AB, 0x20C07205, 0xEB9CA1A0,
+        0x11E81EB4, 0xDAB4CD11, 0x5C20BFBF, 0x977C6C1A, 0x8A795CA2, 0x41258F07, 0xC7B1FDA9, 0x0CED2E0C,
+        0xFDBB9CD9, 0x36E74F7C, 0xB0733DD2, 0x7B2FEE77, 0x662ADECF, 0xAD760D6A, 0x2BE27FC4, 0xE0BEAC61,
+        0x123E1C2F, 0xD962CF8A, 0x5FF6BD24, 0x94AA6E81, 0x89AF5E39, 0x42F38D9C, 0xC467FF32, 0x0F3B2C97,
+        0xFE6D9E42, 0x35314DE7, 0xB3A53F49, 0x78F9ECEC, 0x65FCDC54, 0xAEA00FF1, 0x28347D5F, 0xE368AEFA,
+        0x16441B82, 0xDD18C827, 0x5B8CBA89, 0x90D0692C, 0x8DD55994, 0x46898A31, 0xC01DF89F, 0x0B412B3A,
+        0xFA1799EF, 0x314B4A4A, 0xB7DF38E4, 0x7C83EB41, 0x6186DBF9, 0xAADA085C, 0x2C4E7AF2, 0xE712A957,
+        0x15921919, 0xDECECABC, 0x585AB812, 0x93066BB7, 0x8E035B0F, 0x455F88AA, 0xC3CBFA04, 0x089729A1,
+        0xF9C19B74, 0x329D48D1, 0xB4093A7F, 0x7F55E9DA, 0x6250D962, 0xA90C0AC7, 0x2F987869, 0xE4C4ABCC
+    },
+    {
+        0x00000000, 0xA6770BB4, 0x979F1129, 0x31E81A9D, 0xF44F2413, 0x52382FA7, 0x63D0353A, 0xC5A73E8E,
+        0x33EF4E67, 0x959845D3, 0xA4705F4E, 0x020754FA, 0xC7A06A74, 0x61D761C0, 0x503F7B5D, 0xF64870E9,
+        0x67DE9CCE, 0xC1A9977A, 0xF0418DE7, 0x56368653, 0x9391B8DD, 0x35E6B369, 0x040EA9F4, 0xA279A240,
+        0x5431D2A9, 0xF246D91D, 0xC3AEC380, 0x65D9C834, 0xA07EF6BA, 0x0609FD0E, 0x37E1E793, 0x9196EC27,
+        0xCFBD399C, 0x69CA3228, 0x582228B5, 0xFE552301, 0x3BF21D8F, 0x9D85163B, 0xAC6D0CA6, 0x0A1A0712,
+        0xFC5277FB, 0x5A257C4F, 0x6BCD66D2, 0xCDBA6D66, 0x081D53E8, 0xAE6A585C, 0x9F8242C1, 0x39F54975,
+        0xA863A552, 0x0E14AEE6, 0x3FFCB47B, 0x998BBFCF, 0x5C2C8141, 0xFA5B8AF5, 0xCBB39068, 0x6DC49BDC,
+        0x9B8CEB35, 0x3DFBE081, 0x0C13FA1C, 0xAA64F1A8, 0x6FC3CF26, 0xC9B4C492, 0xF85CDE0F, 0x5E2BD5BB,
+        0x440B7579, 0xE27C7ECD, 0xD3946450, 0x75E36FE4, 0xB044516A, 0x16335ADE, 0x27DB4043, 0x81AC4BF7,
+        0x77E43B1E, 0xD19330AA, 0xE07B2A37, 0x460C2183, 0x83AB1F0D, 0x25DC14B9, 0x14340E24, 0xB2430590,
+        0x23D5E9B7, 0x85A2E203, 0xB44AF89E, 0x123DF32A, 0xD79ACDA4, 0x71EDC610, 0x4005DC8D, 0xE672D739,
+        0x103AA7D0, 0xB64DAC64, 0x87A5B6F9, 0x21D2BD4D, 0xE47583C3, 0x42028877, 0x73EA92EA, 0xD59D995E,
+        0x8BB64CE5, 0x2DC14751, 0x1C295DCC, 0xBA5E5678, 0x7FF968F6, 0xD98E6342, 0xE86679DF, 0x4E11726B,
+        0xB8590282, 0x1E2E0936, 0x2FC613AB, 0x89B1181F, 0x4C162691, 0xEA612D25, 0xDB8937B8, 0x7DFE3C0C,
+        0xEC68D02B, 0x4A1FDB9F, 0x7BF7C102, 0xDD80CAB6, 0x1827F438, 0xBE50FF8C, 0x8FB8E511, 0x29CFEEA5,
+        0xDF879E4C, 0x79F095F8, 0x48188F65, 0xEE6F84D1, 0x2BC8BA5F, 0x8DBFB1EB, 0xBC57AB76, 0x1A20A0C2,
+        0x8816EAF2, 0x2E61E146, 0x1F89FBDB, 0xB9FEF06F, 0x7C59CEE1, 0xDA2EC555, 0xEBC6DFC8, 0x4DB1D47C,
+        0xBBF9A495, 0x1D8EAF21, 0x2C66B5BC, 0x8A11BE08, 0x4FB68086, 0xE9C18B32, 0xD82991AF, 0x7E5E9A1B,
+        0xEFC8763C, 0x49BF7D88, 0x78576715, 0xDE206CA1, 0x1B87522F, 0xBDF0599B, 0x8C184306, 0x2A6F48B2,
+        0xDC27385B, 0x7A5033EF, 0x4BB82972, 0xEDCF22C6, 0x28681C48, 0x8E1F17FC, 0xBFF70D61, 0x198006D5,
+        0x47ABD36E, 0xE1DCD8DA, 0xD034C247, 0x7643C9F3, 0xB3E4F77D, 0x1593FCC9, 0x247BE654, 0x820CEDE0,
+        0x74449D09, 0xD23396BD, 0xE3DB8C20, 0x45AC8794, 0x800BB91A, 0x267CB2AE, 0x1794A833, 0xB1E3A387,
+        0x20754FA0, 0x86024414, 0xB7EA5E89, 0x119D553D, 0xD43A6BB3, 0x724D6007, 0x43A57A9A, 0xE5D2712E,
+        0x139A01C7, 0xB5ED0A73, 0x840510EE, 0x22721B5A, 0xE7D525D4, 0x41A22E60, 0x704A34FD, 0xD63D3F49,
+        0xCC1D9F8B, 0x6A6A943F, 0x5B828EA2, 0xFDF58516, 0x3852BB98, 0x9E25B02C, 0xAFCDAAB1, 0x09BAA105,
+        0xFFF2D1EC, 0x5985DA58, 0x686DC0C5, 0xCE1ACB71, 0x0BBDF5FF, 0xADCAFE4B, 0x9C22E4D6, 0x3A55EF62,
+        0xABC30345, 0x0DB408F1, 0x3C5C126C, 0x9A2B19D8, 0x5F8C2756, 0xF9FB2CE2, 0xC813367F, 0x6E643DCB,
+        0x982C4D22, 0x3E5B4696, 0x0FB35C0B, 0xA9C457BF, 0x6C636931, 0xCA146285, 0xFBFC7818, 0x5D8B73AC,
+        0x03A0A617, 0xA5D7ADA3, 0x943FB73E, 0x3248BC8A, 0xF7EF8204, 0x519889B0, 0x6070932D, 0xC6079899,
+        0x304FE870, 0x9638E3C4, 0xA7D0F959, 0x01A7F2ED, 0xC400CC63, 0x6277C7D7, 0x539FDD4A, 0xF5E8D6FE,
+        0x647E3AD9, 0xC209316D, 0xF3E12BF0, 0x55962044, 0x90311ECA, 0x3646157E, 0x07AE0FE3, 0xA1D90457,
+        0x579174BE, 0xF1E67F0A, 0xC00E6597, 0x66796E23, 0xA3DE50AD, 0x05A95B19, 0x34414184, 0x92364A30
+    },
+    {
+        0x00000000, 0xCCAA009E, 0x4225077D, 0x8E8F07E3, 0x844A0EFA, 0x48E00E64, 0xC66F0987, 0x0AC50919,
+        0xD3E51BB5, 0x1F4F1B2B, 0x91C01CC8, 0x5D6A1C56, 0x57AF154F, 0x9B0515D1, 0x158A1232, 0xD92012AC,
+        0x7CBB312B, 0xB01131B5, 0x3E9E3656, 0xF23436C8, 0xF8F13FD1, 0x345B3F4F, 0xBAD438AC, 0x767E3832,
+        0xAF5E2A9E, 0x63F42A00, 0xED7B2DE3, 0x21D12D7D, 0x2B142464, 0xE7BE24FA, 0x69312319, 0xA59B2387,
+        0xF9766256, 0x35DC62C8, 0xBB53652B, 0x77F965B5, 0x7D3C6CAC, 0xB1966C32, 0x3F196BD1, 0xF3B36B4F,
+        0x2A9379E3, 0xE639797D, 0x68B67E9E, 0xA41C7E00, 0xAED97719, 0x62737787, 0xECFC7064, 0x205670FA,
+        0x85CD537D, 0x496753E3, 0xC7E85400, 0x0B42549E, 0x01875D87, 0xCD2D5D19, 0x43A25AFA, 0x8F085A64,
+        0x562848C8, 0x9A824856, 0x140D4FB5, 0xD8A74F2B, 0xD2624632, 0x1EC846AC, 0x9047414F, 0x5CED41D1,
+        0x299DC2ED, 0xE537C273, 0x6BB8C590, 0xA712C50E, 0xADD7CC17, 0x617DCC89, 0xEFF2CB6A, 0x2358CBF4,
+        0xFA78D958, 0x36D2D9C6, 0xB85DDE25, 0x74F7DEBB, 0x7E32D7A2, 0xB298D73C, 0x3C17D0DF, 0xF0BDD041,
+        0x5526F3C6, 0x998CF358, 0x1703F4BB, 0xDBA9F425, 0xD16CFD3C, 0x1DC6FDA2, 0x9349FA41, 0x5FE3FADF,
+        0x86C3E873, 0x4A69E8ED, 0xC4E6EF0E, 0x084CEF90, 0x0289E689, 0xCE23E617, 0x40ACE1F4, 0x8C06E16A,
+        0xD0EBA0BB, 0x1C41A025, 0x92CEA7C6, 0x5E64A758, 0x54A1AE41, 0x980BAEDF, 0x1684A93C, 0xDA2EA9A2,
+        0x030EBB0E, 0xCFA4BB90, 0x412BBC73, 0x8D81BCED, 0x8744B5F4, 0x4BEEB56A, 0xC561B289, 0x09CBB217,
+        0xAC509190, 0x60FA910E, 0xEE7596ED, 0x22DF9673, 0x281A9F6A, 0xE4B09FF4, 0x6A3F9817, 0xA6959889,
+        0x7FB58A25, 0xB31F8ABB, 0x3D908D58, 0xF13A8DC6, 0xFBFF84DF, 0x37558441, 0xB9DA83A2, 0x7570833C,
+        0x533B85DA, 0x9F918544, 0x111E82A7, 0xDDB48239, 0xD7718B20, 0x1BDB8BBE, 0x95548C5D, 0x59FE8CC3,
+        0x80DE9E6F, 0x4C749EF1, 0xC2FB9912, 0x0E51998C, 0x04949095, 0xC83E900B, 0x46B197E8, 0x8A1B9776,
+        0x2F80B4F1, 0xE32AB46F, 0x6DA5B38C, 0xA10FB312, 0xABCABA0B, 0x6760BA95, 0xE9EFBD76, 0x2545BDE8,
+        0xFC65AF44, 0x30CFAFDA, 0xBE40A839, 0x72EAA8A7, 0x782FA1BE, 0xB485A120, 0x3A0AA6C3, 0xF6A0A65D,
+        0xAA4DE78C, 0x66E7E712, 0xE868E0F1, 0x24C2E06F, 0x2E07E976, 0xE2ADE9E8, 0x6C22EE0B, 0xA088EE95,
+        0x79A8FC39, 0xB502FCA7, 0x3B8DFB44, 0xF727FBDA, 0xFDE2F2C3, 0x3148F25D, 0xBFC7F5BE, 0x736DF520,
+        0xD6F6D6A7, 0x1A5CD639, 0x94D3D1DA, 0x5879D144, 0x52BCD85D, 0x9E16D8C3, 0x1099DF20, 0xDC33DFBE,
+        0x0513CD12, 0xC9B9CD8C, 0x4736CA6F, 0x8B9CCAF1, 0x8159C3E8, 0x4DF3C376, 0xC37CC495, 0x0FD6C40B,
+        0x7AA64737, 0xB60C47A9, 0x3883404A, 0xF42940D4, 0xFEEC49CD, 0x32464953, 0xBCC94EB0, 0x70634E2E,
+        0xA9435C82, 0x65E95C1C, 0xEB665BFF, 0x27CC5B61, 0x2D095278, 0xE1A352E6, 0x6F2C5505, 0xA386559B,
+        0x061D761C, 0xCAB77682, 0x44387161, 0x889271FF, 0x825778E6, 0x4EFD7878, 0xC0727F9B, 0x0CD87F05,
+        0xD5F86DA9, 0x19526D37, 0x97DD6AD4, 0x5B776A4A, 0x51B26353, 0x9D1863CD, 0x1397642E, 0xDF3D64B0,
+        0x83D02561, 0x4F7A25FF, 0xC1F5221C, 0x0D5F2282, 0x079A2B9B, 0xCB302B05, 0x45BF2CE6, 0x89152C78,
+        0x50353ED4, 0x9C9F3E4A, 0x121039A9, 0xDEBA3937, 0xD47F302E, 0x18D530B0, 0x965A3753, 0x5AF037CD,
+        0xFF6B144A, 0x33C114D4, 0xBD4E1337, 0x71E413A9, 0x7B211AB0, 0xB78B1A2E, 0x39041DCD, 0xF5AE1D53,
+        0x2C8E0FFF, 0xE0240F61, 0x6EAB0882, 0xA201081C, 0xA8C40105, 0x646E019B, 0xEAE10678, 0x264B06E6
+    }
+};
+uint32_t (*crc32UpdateHook)(uint32_t crc, const uint8_t *message, size_t size) = nullptr;
+uint32_t crc32Init() {
+    return 0xFFFFFFFF;
+}
+uint32_t crc32Update(uint32_t crc, const uint8_t *message, size_t size) {
+    if (crc32UpdateHook) {
+        return crc32UpdateHook(crc, message, size);
+    }
+#if defined(__ARM_FEATURE_CRC32)
+    for (; size > 0 && ((uintptr_t)message & 7); size--) {
+        crc = __crc32b(crc, *message++);
+    }
+    for (; size >= 8; size -= 8, message += 8) {
+        uint64_t value;
+        memcpy(&value, message, sizeof(value));
+        crc = __crc32d(crc, value);
+    }
+    for (; size > 0; size--) {
+        crc = __crc32b(crc, *message++);
     }
+#else
+    for (; size >= 8; size -= 8, message += 8) {
+        uint32_t one = crc ^ ((uint32_t)message[0] | ((uint32_t)message[1] << 8) | ((uint32_t)message[2] << 16) | ((uint32_t)message[3] << 24));
+        uint32_t two = (uint32_t)message[4] | ((uint32_t)message[5] << 8) | ((uint32_t)message[6] << 16) | ((uint32_t)message[7] << 24);
+        crc =
+            CRC32_TABLE[7][one & 0xFF] ^
+            CRC32_TABLE[6][(one >> 8) & 0xFF] ^
+            CRC32_TABLE[5][(one >> 16) & 0xFF] ^
+            CRC32_TABLE[4][one >> 24] ^
+            CRC32_TABLE[3][two & 0xFF] ^
+            CRC32_TABLE[2][(two >> 8) & 0xFF] ^
+            CRC32_TABLE[1][(two >> 16) & 0xFF] ^
+            CRC32_TABLE[0][two >> 24];
+    }
+    for (; size > 0; size--) {
+        crc = (crc >> 8) ^ CRC32_TABLE[0][(crc ^ *message++) & 0xFF];
+    }
+#endif
+    return crc;
+}
+uint32_t crc32Final(uint32_t crc) {
     return ~crc;
 }
+uint32_t crc32(const uint8_t *mem_block, size_t block_size) {
+    return crc32Final(crc32Update(crc32Init(), mem_block, block_size));
+}
 uint8_t toBCD(uint8_t bin) {
     return ((bin / 10) << 4) | (bin % 10);
 }
@@ -1928,7 +2802,7 @@ const ArrayValue *Value::getArray() const {
         return arrayValue;
     }
     if (type == VALUE_TYPE_ARRAY_ASSET) {
-        return (ArrayValue *)((uint8_t *)&int32Value + int32Value);
+        return (ArrayValue *)EEZ_ASSETS_PTR(int32Value);
     }
     return &((ArrayValueRef *)refValue)->arrayValue;
 }
@@ -1937,7 +2811,7 @@ ArrayValue *Value::getArray() {
         return arrayValue;
     }
     if (type == VALUE_TYPE_ARRAY_ASSET) {
-        return (ArrayValue *)((uint8_t *)&int32Value + int32Value);
+        return (ArrayValue *)EEZ_ASSETS_PTR(int32Value);
     }
     return &((ArrayValueRef *)refValue)->arrayValue;
 }
@@ -2462,52 +3336,127 @@ Value Value::clone() {
     }
     return *this;
 }
-Value getVar(int16_t id) {
-    auto native_var = native_vars[id];
-    if (native_var.type == NATIVE_VAR_TYPE_INTEGER) {
-        auto get = (int32_t (*)())native_var.get;
-        return Value((int)get(), VALUE_TYPE_INT32);
-    }
-    if (native_var.type == NATIVE_VAR_TYPE_BOOLEAN) {
-        auto get = (bool (*)())native_var.get;
-        return Value(get(), VALUE_TYPE_BOOLEAN);
-    }
-    if (native_var.type == NATIVE_VAR_TYPE_FLOAT) {
-        auto get = (float (*)())native_var.get;
-        return Value(get(), VALUE_TYPE_FLOAT);
-    }
-    if (native_var.type == NATIVE_VAR_TYPE_DOUBLE) {
-        auto get = (double (*)())native_var.get;
-        return Value(get(), VALUE_TYPE_DOUBLE);
+static Value callNativeVarGetter(const native_var_t &native_var) {
+    switch (native_var.type) {
+    case NATIVE_VAR_TYPE_INTEGER:
+        return Value((int)((int32_t (*)())native_var.get)(), VALUE_TYPE_INT32);
+    case NATIVE_VAR_TYPE_BOOLEAN:
+        return Value(((bool (*)())native_var.get)(), VALUE_TYPE_BOOLEAN);
+    case NATIVE_VAR_TYPE_FLOAT:
+        return Value(((float (*)())native_var.get)(), VALUE_TYPE_FLOAT);
+    case NATIVE_VAR_TYPE_DOUBLE:
+        return Value(((double (*)())native_var.get)(), VALUE_TYPE_DOUBLE);
+    case NATIVE_VAR_TYPE_STRING:
+        return Value(((const char *(*)())native_var.get)(), VALUE_TYPE_STRING);
+    default:
+        return Value();
+    }
+}
+static void callNativeVarSetter(const native_var_t &native_var, const Value& value) {
+    switch (native_var.type) {
+    case NATIVE_VAR_TYPE_INTEGER:
+        ((void (*)(int32_t))native_var.set)(value.toInt32(nullptr));
+        break;
+    case NATIVE_VAR_TYPE_BOOLEAN:
+        ((void (*)(bool))native_var.set)(value.toBool(nullptr));
+        break;
+    case NATIVE_VAR_TYPE_FLOAT:
+        ((void (*)(float))native_var.set)(value.toFloat(nullptr));
+        break;
+    case NATIVE_VAR_TYPE_DOUBLE:
+        ((void (*)(double))native_var.set)(value.toDouble(nullptr));
+        break;
+    case NATIVE_VAR_TYPE_STRING:
+        ((void (*)(const char *))native_var.set)(value.getString());
+        break;
+    default:
+        break;
+    }
+}
+static flow::NativeVarCacheEntry &getNativeVarCacheEntry(int16_t id) {
+    return flow::g_runtimeContext->nativeVarCache[(uint16_t)id % EEZ_FLOW_NATIVE_VAR_CACHE_SIZE];
+}
+static void invalidateNativeVarCacheEntry(int16_t id) {
+    auto &entry = getNativeVarCacheEntry(id);
+    if (entry.id == id) {
+        entry.epoch = 0;
+        entry.value = Value();
+    }
+}
+static flow::NativeVarWrite *findNativeVarWrite(int16_t id) {
+    for (unsigned i = 0; i < flow::g_runtimeContext->numNativeVarWrites; i++) {
+        if (flow::g_runtimeContext->nativeVarWrites[i].id == id) {
+            return &flow::g_runtimeContext->nativeVarWrites[i];
+        }
     }
-    if (native_var.type == NATIVE_VAR_TYPE_STRING) {
-        auto get = (const char *(*)())native_var.get;
-        return Value(get(), VALUE_TYPE_STRING);
+    return nullptr;
+}
+Value getVar(int16_t id) {
+    auto &native_var = native_vars[id];
+    if (native_var.flags & NATIVE_VAR_FLAG_COALESCE_WRITES) {
+        auto nativeVarWrite = findNativeVarWrite(id);
+        if (nativeVarWrite) {
+            return nativeVarWrite->value;
+        }
+    }
+    if (native_var.flags & NATIVE_VAR_FLAG_TICK_STABLE) {
+        if (!flow::g_runtimeContext->nativeVarsBatchFetched) {
+            flow::g_runtimeContext->nativeVarsBatchFetched = true;
+            if (flow::getNativeVarsBatchHook) {
+                flow::getNativeVarsBatchHook();
+            }
+        }
+        auto &entry = getNativeVarCacheEntry(id);
+        if (entry.id != id || entry.epoch != flow::g_runtimeContext->nativeVarCacheEpoch) {
+            entry.id = id;
+            entry.epoch = flow::g_runtimeContext->nativeVarCacheEpoch;
+            entry.value = callNativeVarGetter(native_var);
+        }
+        return entry.value;
     }
-    return Value();
+    return callNativeVarGetter(native_var);
 }
 void setVar(int16_t id, const Value& value) {
-    auto native_var = native_vars[id];
-    if (native_var.type == NATIVE_VAR_TYPE_INTEGER) {
-        auto set = (void (*)(int32_t))native_var.set;
-        set(value.toInt32(nullptr));
-    }
-    if (native_var.type == NATIVE_VAR_TYPE_BOOLEAN) {
-        auto set = (void (*)(bool))native_var.set;
-        set(value.toBool(nullptr));
+    auto &native_var = native_vars[id];
+    if (native_var.flags & NATIVE_VAR_FLAG_COALESCE_WRITES) {
+        auto nativeVarWrite = findNativeVarWrite(id);
+        if (!nativeVarWrite && flow::g_runtimeContext->numNativeVarWrites < EEZ_FLOW_NATIVE_VAR_WRITES_SIZE) {
+            nativeVarWrite = &flow::g_runtimeContext->nativeVarWrites[flow::g_runtimeContext->numNativeVarWrites++];
+            nativeVarWrite->id = id;
+        }
+        if (nativeVarWrite) {
+            nativeVarWrite->value = value;
+            return;
+        }
     }
-    if (native_var.type == NATIVE_VAR_TYPE_FLOAT) {
-        auto set = (void (*)(float))native_var.set;
-        set(value.toFloat(nullptr));
+    callNativeVarSetter(native_var, value);
+    if (native_var.flags & NATIVE_VAR_FLAG_TICK_STABLE) {
+        invalidateNativeVarCacheEntry(id);
     }
-    if (native_var.type == NATIVE_VAR_TYPE_DOUBLE) {
-        auto set = (void (*)(double))native_var.set;
-        set(value.toDouble(nullptr));
+}
+void setNativeVarCachedValue(int16_t id, const Value& value) {
+    auto &entry = getNativeVarCacheEntry(id);
+    entry.id = id;
+    entry.epoch = flow::g_runtimeContext->nativeVarCacheEpoch;
+    entry.value = value;
+}
+void beginNativeVarsTick() {
+    if (++flow::g_runtimeContext->nativeVarCacheEpoch == 0) {
+        flow::g_runtimeContext->nativeVarCacheEpoch = 1;
     }
-    if (native_var.type == NATIVE_VAR_TYPE_STRING) {
-        auto set = (void (*)(const char *))native_var.set;
-        set(value.getString());
+    flow::g_runtimeContext->nativeVarsBatchFetched = false;
+}
+void flushNativeVarWrites() {
+    for (unsigned i = 0; i < flow::g_runtimeContext->numNativeVarWrites; i++) {
+        auto &nativeVarWrite = flow::g_runtimeContext->nativeVarWrites[i];
+        auto &native_var = native_vars[nativeVarWrite.id];
+        callNativeVarSetter(native_var, nativeVarWrite.value);
+        if (native_var.flags & NATIVE_VAR_FLAG_TICK_STABLE) {
+            invalidateNativeVarCacheEntry(nativeVarWrite.id);
+        }
+        nativeVarWrite.value = Value();
     }
+    flow::g_runtimeContext->numNativeVarWrites = 0;
 }
 } 
 // -----------------------------------------------------------------------------
@@ -2555,6 +3504,12 @@ void executeMQTTPublishComponent(FlowState *flowState, unsigned componentIndex);
 void executeLabelInComponent(FlowState *flowState, unsigned componentIndex);
 void executeLabelOutComponent(FlowState *flowState, unsigned componentIndex);
 void executeLVGLApiComponent(FlowState *flowState, unsigned componentIndex);
+#if EEZ_FLOW_SNAPSHOT
+bool restoreCatchErrorComponentExecutionState(FlowState *flowState, unsigned componentIndex, SnapshotReader &reader);
+bool restoreCounterComponentExecutionState(FlowState *flowState, unsigned componentIndex, SnapshotReader &reader);
+bool restoreDelayComponentExecutionState(FlowState *flowState, unsigned componentIndex, SnapshotReader &reader);
+bool restoreInputComponentExecutionState(FlowState *flowState, unsigned componentIndex, SnapshotReader &reader);
+#endif
 typedef void (*ExecuteComponentFunctionType)(FlowState *flowState, unsigned componentIndex);
 static ExecuteComponentFunctionType g_executeComponentFunctions[] = {
 	executeStartComponent,
@@ -2603,12 +3558,34 @@ static ExecuteComponentFunctionType g_executeComponentFunctions[] = {
     executeLVGLApiComponent, 
     executeSetColorThemeComponent,  
 };
+#if EEZ_FLOW_SNAPSHOT
+bool restoreComponentExecutionState(FlowState *flowState, unsigned componentIndex, SnapshotReader &reader) {
+	auto component = flowState->flow->components[componentIndex];
+    switch (component->type) {
+    case defs_v3::COMPONENT_TYPE_CATCH_ERROR_ACTION:
+        return restoreCatchErrorComponentExecutionState(flowState, componentIndex, reader);
+    case defs_v3::COMPONENT_TYPE_COUNTER_ACTION:
+        return restoreCounterComponentExecutionState(flowState, componentIndex, reader);
+    case defs_v3::COMPONENT_TYPE_DELAY_ACTION:
+        return restoreDelayComponentExecutionState(flowState, componentIndex, reader);
+    case defs_v3::COMPONENT_TYPE_INPUT_ACTION:
+        return restoreInputComponentExecutionState(flowState, componentIndex, reader);
+    }
+    return false;
+}
+#endif
 void registerComponent(ComponentTypes componentType, ExecuteComponentFunctionType executeComponentFunction) {
 	if (componentType >= defs_v3::COMPONENT_TYPE_START_ACTION) {
 		g_executeComponentFunctions[componentType - defs_v3::COMPONENT_TYPE_START_ACTION] = executeComponentFunction;
 	}
 }
-bool hasExecFunc(FlowState *flowState, unsigned componentIndex) {
+bool isValidComponentType(uint16_t componentType) {
+	if (componentType >= defs_v3::COMPONENT_TYPE_START_ACTION && componentType < defs_v3::FIRST_DASHBOARD_ACTION_COMPONENT_TYPE) {
+		return componentType - defs_v3::COMPONENT_TYPE_START_ACTION < (int)(sizeof(g_executeComponentFunctions) / sizeof(ExecuteComponentFunctionType));
+	}
+	return true;
+}
+bool hasExecFunc(FlowState *flowState, unsigned componentIndex) {
 	auto component = flowState->flow->components[componentIndex];
 	if (component->type >= defs_v3::FIRST_DASHBOARD_ACTION_COMPONENT_TYPE) {
         return false;
@@ -2625,7 +3602,9 @@ void executeComponent(FlowState *flowState, unsigned componentIndex) {
     } else if (component->type >= defs_v3::COMPONENT_TYPE_START_ACTION) {
 		auto executeComponentFunction = g_executeComponentFunctions[component->type - defs_v3::COMPONENT_TYPE_START_ACTION];
 		if (executeComponentFunction != nullptr) {
+            EEZ_FLOW_TRACE_EVENT(TRACE_EVENT_TASK_START, flowState, componentIndex, component->type);
 			executeComponentFunction(flowState, componentIndex);
+            EEZ_FLOW_TRACE_EVENT(TRACE_EVENT_TASK_END, flowState, componentIndex, component->type);
 			return;
 		}
 	}
@@ -2645,6 +3624,7 @@ struct AnimateComponenentExecutionState : public ComponenentExecutionState {
     float endPosition;
     float speed;
     uint32_t startTimestamp;
+    bool canMigrate() override { return true; }
 };
 void executeAnimateComponent(FlowState *flowState, unsigned componentIndex) {
     FlowState *timelineFlowState = flowState;
@@ -2715,40 +3695,226 @@ void executeAnimateComponent(FlowState *flowState, unsigned componentIndex) {
 #include <stdio.h>
 namespace eez {
 namespace flow {
-FlowState *g_executeActionFlowState;
-unsigned g_executeActionComponentIndex;
+#if EEZ_FLOW_INLINE_ACTIONS
+static bool isInlinableComponent(Component *component, uint32_t flowsCount, const uint8_t *inlinableActionFlows) {
+    switch (component->type) {
+    case defs_v3::COMPONENT_TYPE_START_ACTION:
+    case defs_v3::COMPONENT_TYPE_END_ACTION:
+    case defs_v3::COMPONENT_TYPE_INPUT_ACTION:
+    case defs_v3::COMPONENT_TYPE_OUTPUT_ACTION:
+    case defs_v3::COMPONENT_TYPE_EVAL_EXPR_ACTION:
+    case defs_v3::COMPONENT_TYPE_SET_VARIABLE_ACTION:
+    case defs_v3::COMPONENT_TYPE_SWITCH_ACTION:
+    case defs_v3::COMPONENT_TYPE_COMPARE_ACTION:
+    case defs_v3::COMPONENT_TYPE_IS_TRUE_ACTION:
+    case defs_v3::COMPONENT_TYPE_CONSTANT_ACTION:
+    case defs_v3::COMPONENT_TYPE_LOG_ACTION:
+    case defs_v3::COMPONENT_TYPE_NOOP_ACTION:
+    case defs_v3::COMPONENT_TYPE_COMMENT_ACTION:
+    case defs_v3::COMPONENT_TYPE_LABEL_IN_ACTION:
+    case defs_v3::COMPONENT_TYPE_LABEL_OUT_ACTION:
+        return true;
+    case defs_v3::COMPONENT_TYPE_CALL_ACTION_ACTION: {
+        auto callActionComponent = (CallActionActionComponent *)component;
+        return
+            callActionComponent->flowIndex >= 0 &&
+            (uint32_t)callActionComponent->flowIndex < flowsCount &&
+            inlinableActionFlows[callActionComponent->flowIndex];
+    }
+    default:
+        return false;
+    }
+}
+static bool hasAssignableUserProperties(Flow *flow) {
+    for (uint32_t i = 0; i < flow->userPropertiesAssignable.count; i++) {
+        if (flow->userPropertiesAssignable.items[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+static bool doLocalsEscape(FlowDefinition *flowDefinition, Flow *flow) {
+    for (uint32_t componentIndex = 0; componentIndex < flow->components.count; componentIndex++) {
+        auto component = flow->components[componentIndex];
+        if (component->type == defs_v3::COMPONENT_TYPE_CALL_ACTION_ACTION) {
+            auto callActionComponent = (CallActionActionComponent *)component;
+            if (
+                callActionComponent->flowIndex >= 0 &&
+                (uint32_t)callActionComponent->flowIndex < flowDefinition->flows.count &&
+                hasAssignableUserProperties(flowDefinition->flows[callActionComponent->flowIndex])
+            ) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+void classifyInlinableActionFlows(Assets *assets) {
+    freeInlinableActionFlows();
+    auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
+    auto flowsCount = flowDefinition->flows.count;
+    auto inlinableActionFlows = (uint8_t *)alloc(flowsCount, 0x8e2b4d17);
+    if (!inlinableActionFlows) {
+        return;
+    }
+    memset(inlinableActionFlows, 0, flowsCount);
+    bool changed;
+    do {
+        changed = false;
+        for (uint32_t flowIndex = 0; flowIndex < flowsCount; flowIndex++) {
+            if (inlinableActionFlows[flowIndex]) {
+                continue;
+            }
+            auto flow = flowDefinition->flows[flowIndex];
+            if (doLocalsEscape(flowDefinition, flow)) {
+                continue;
+            }
+            uint32_t componentIndex;
+            for (componentIndex = 0; componentIndex < flow->components.count; componentIndex++) {
+                if (!isInlinableComponent(flow->components[componentIndex], flowsCount, inlinableActionFlows)) {
+                    break;
+                }
+            }
+            if (componentIndex == flow->components.count) {
+                inlinableActionFlows[flowIndex] = 1;
+                changed = true;
+            }
+        }
+    } while (changed);
+    g_runtimeContext->inlinableActionFlows = inlinableActionFlows;
+}
+void freeInlinableActionFlows() {
+    if (g_runtimeContext->inlinableActionFlows) {
+        free(g_runtimeContext->inlinableActionFlows);
+        g_runtimeContext->inlinableActionFlows = nullptr;
+    }
+}
+static bool isInlinableActionFlow(FlowState *flowState, int flowIndex) {
+    return
+        g_runtimeContext->inlinableActionFlows &&
+        !g_runtimeContext->debuggerIsConnected &&
+        flowState->assets == g_runtimeContext->mainAssets &&
+        g_runtimeContext->inlinableActionFlows[flowIndex];
+}
+static void initInlineFrame(InlineFrame *inlineFrame) {
+    inlineFrame->tasks = inlineFrame->inlineTasks;
+    inlineFrame->capacity = EEZ_FLOW_INLINE_QUEUE_SIZE;
+    inlineFrame->head = 0;
+    inlineFrame->tail = 0;
+    inlineFrame->isFull = false;
+}
+static void freeInlineFrame(InlineFrame *inlineFrame) {
+    if (inlineFrame->tasks != inlineFrame->inlineTasks) {
+        free(inlineFrame->tasks);
+        inlineFrame->tasks = inlineFrame->inlineTasks;
+    }
+}
+static bool growInlineFrame(InlineFrame *inlineFrame) {
+    if (inlineFrame->capacity >= QUEUE_SIZE) {
+        return false;
+    }
+    auto capacity = MIN(2 * inlineFrame->capacity, QUEUE_SIZE);
+    auto tasks = (uint16_t *)alloc(capacity * sizeof(uint16_t), 0x3d8a61c4);
+    if (!tasks) {
+        return false;
+    }
+    for (unsigned i = 0; i < inlineFrame->capacity; i++) {
+        tasks[i] = inlineFrame->tasks[(inlineFrame->head + i) % inlineFrame->capacity];
+    }
+    freeInlineFrame(inlineFrame);
+    inlineFrame->tasks = tasks;
+    inlineFrame->head = 0;
+    inlineFrame->tail = inlineFrame->capacity;
+    inlineFrame->capacity = capacity;
+    inlineFrame->isFull = false;
+    return true;
+}
+bool addToInlineFrame(FlowState *flowState, unsigned componentIndex) {
+    auto inlineFrame = flowState->inlineFrame;
+    if (inlineFrame->isFull && !growInlineFrame(inlineFrame)) {
+        throwError(flowState, componentIndex, "Execution queue is full\n");
+        return false;
+    }
+    inlineFrame->tasks[inlineFrame->tail] = (uint16_t)componentIndex;
+    inlineFrame->tail = (inlineFrame->tail + 1) % inlineFrame->capacity;
+    if (inlineFrame->head == inlineFrame->tail) {
+        inlineFrame->isFull = true;
+    }
+    return true;
+}
+static void runInlineFrame(FlowState *flowState) {
+    auto inlineFrame = flowState->inlineFrame;
+    while (inlineFrame->head != inlineFrame->tail || inlineFrame->isFull) {
+        unsigned componentIndex = inlineFrame->tasks[inlineFrame->head];
+        inlineFrame->head = (inlineFrame->head + 1) % inlineFrame->capacity;
+        inlineFrame->isFull = false;
+        if (flowState->error) {
+            break;
+        }
+        flowState->executingComponentIndex = componentIndex;
+        executeComponent(flowState, componentIndex);
+        if (isFlowStopped() || g_runtimeContext->isStopping) {
+            break;
+        }
+        resetSequenceInputs(flowState);
+    }
+}
+#endif
+static void setCallActionUserProperties(FlowState *flowState, unsigned componentIndex, FlowState *actionFlowState) {
+    for (uint32_t i = 0; i < actionFlowState->flow->userPropertiesAssignable.count; i++) {
+        auto isAssignable = actionFlowState->flow->userPropertiesAssignable.items[i];
+        Value value;
+        if (isAssignable) {
+            if (!evalAssignableProperty(flowState, componentIndex, i, value, FlowError::UserProperty("CallAction", i))) {
+                break;
+            }
+            if (value.getType() == VALUE_TYPE_FLOW_OUTPUT) {
+                value = Value::makePropertyRef(flowState, componentIndex, i, 0x5696e703);
+            }
+        } else {
+            if (!evalProperty(flowState, componentIndex, i, value, FlowError::UserAssignableProperty("CallAction", i))) {
+                break;
+            }
+        }
+        auto propValuePtr = actionFlowState->values + actionFlowState->flow->componentInputs.count + i;
+        *propValuePtr = value;
+        onValueChanged(actionFlowState, propValuePtr);
+    }
+}
 void executeCallAction(FlowState *flowState, unsigned componentIndex, int flowIndex, const Value& inputValue) {
 	if (flowIndex >= (int)flowState->assets->flowDefinition->flows.count) {
-        g_executeActionFlowState = flowState;
-        g_executeActionComponentIndex = componentIndex;
+        g_runtimeContext->executeActionFlowState = flowState;
+        g_runtimeContext->executeActionComponentIndex = componentIndex;
 		executeActionFunction(flowIndex - flowState->assets->flowDefinition->flows.count);
         if ((int)componentIndex != -1 && !flowState->componenentAsyncStates[componentIndex]) {
 		    propagateValueThroughSeqout(flowState, componentIndex);
         }
 		return;
 	}
-	FlowState *actionFlowState = initActionFlowState(flowIndex, flowState, componentIndex, inputValue);
-    if ((int)componentIndex != -1) {
-        for (uint32_t i = 0; i < actionFlowState->flow->userPropertiesAssignable.count; i++) {
-            auto isAssignable = actionFlowState->flow->userPropertiesAssignable.items[i];
-            Value value;
-            if (isAssignable) {
-                if (!evalAssignableProperty(flowState, componentIndex, i, value, FlowError::UserProperty("CallAction", i))) {
-                    break;
-                }
-                if (value.getType() == VALUE_TYPE_FLOW_OUTPUT) {
-                    value = Value::makePropertyRef(flowState, componentIndex, i, 0x5696e703);
-                }
-            } else {
-                if (!evalProperty(flowState, componentIndex, i, value, FlowError::UserAssignableProperty("CallAction", i))) {
-                    break;
-                }
+#if EEZ_FLOW_INLINE_ACTIONS
+    if (isInlinableActionFlow(flowState, flowIndex)) {
+        InlineFrame inlineFrame;
+        initInlineFrame(&inlineFrame);
+        FlowState *actionFlowState = initInlineActionFlowState(flowIndex, flowState, componentIndex, inputValue, &inlineFrame);
+        if (actionFlowState) {
+            if ((int)componentIndex != -1) {
+                setCallActionUserProperties(flowState, componentIndex, actionFlowState);
             }
-            auto propValuePtr = actionFlowState->values + actionFlowState->flow->componentInputs.count + i;
-            *propValuePtr = value;
-            onValueChanged(propValuePtr);
+            bool hasTasks = inlineFrame.head != inlineFrame.tail || inlineFrame.isFull;
+            runInlineFrame(actionFlowState);
+            freeInlineActionFlowState(actionFlowState);
+            freeInlineFrame(&inlineFrame);
+            if (!hasTasks && (int)componentIndex != -1) {
+                propagateValueThroughSeqout(flowState, componentIndex);
+            }
+            return;
         }
     }
+#endif
+	FlowState *actionFlowState = initActionFlowState(flowIndex, flowState, componentIndex, inputValue);
+    if ((int)componentIndex != -1) {
+        setCallActionUserProperties(flowState, componentIndex, actionFlowState);
+    }
 	if (canFreeFlowState(actionFlowState)) {
         freeFlowState(actionFlowState);
         if ((int)componentIndex != -1) {
@@ -2778,6 +3944,17 @@ void executeCatchErrorComponent(FlowState *flowState, unsigned componentIndex) {
     deallocateComponentExecutionState(flowState, componentIndex);
 	propagateValueThroughSeqout(flowState, componentIndex);
 }
+#if EEZ_FLOW_SNAPSHOT
+bool CatchErrorComponenentExecutionState::saveSnapshot(SnapshotWriter &writer) {
+    writer.writeValue(message);
+    return true;
+}
+bool restoreCatchErrorComponentExecutionState(FlowState *flowState, unsigned componentIndex, SnapshotReader &reader) {
+    auto catchErrorComponentExecutionState = allocateComponentExecutionState<CatchErrorComponenentExecutionState>(flowState, componentIndex);
+    reader.readValue(catchErrorComponentExecutionState->message);
+    return !reader.error;
+}
+#endif
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -2833,6 +4010,13 @@ namespace eez {
 namespace flow {
 struct CounterComponenentExecutionState : public ComponenentExecutionState {
     int counter;
+    bool canMigrate() override { return true; }
+#if EEZ_FLOW_SNAPSHOT
+    bool saveSnapshot(SnapshotWriter &writer) override {
+        writer.writeUint32((uint32_t)counter);
+        return true;
+    }
+#endif
 };
 void executeCounterComponent(FlowState *flowState, unsigned componentIndex) {
     auto counterComponenentExecutionState = (CounterComponenentExecutionState *)flowState->componenentExecutionStates[componentIndex];
@@ -2852,6 +4036,13 @@ void executeCounterComponent(FlowState *flowState, unsigned componentIndex) {
         propagateValue(flowState, componentIndex, 1);
     }
 }
+#if EEZ_FLOW_SNAPSHOT
+bool restoreCounterComponentExecutionState(FlowState *flowState, unsigned componentIndex, SnapshotReader &reader) {
+    auto counterComponenentExecutionState = allocateComponentExecutionState<CounterComponenentExecutionState>(flowState, componentIndex);
+    counterComponenentExecutionState->counter = (int)reader.readUint32();
+    return !reader.error;
+}
+#endif
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -2861,6 +4052,14 @@ namespace eez {
 namespace flow {
 struct DelayComponenentExecutionState : public ComponenentExecutionState {
 	uint32_t waitUntil;
+    bool canMigrate() override { return true; }
+#if EEZ_FLOW_SNAPSHOT
+    bool saveSnapshot(SnapshotWriter &writer) override {
+        int32_t remaining = (int32_t)(waitUntil - millis());
+        writer.writeUint32(remaining > 0 ? (uint32_t)remaining : 0);
+        return true;
+    }
+#endif
 };
 void executeDelayComponent(FlowState *flowState, unsigned componentIndex) {
 	auto delayComponentExecutionState = (DelayComponenentExecutionState *)flowState->componenentExecutionStates[componentIndex];
@@ -2891,6 +4090,13 @@ void executeDelayComponent(FlowState *flowState, unsigned componentIndex) {
 		}
 	}
 }
+#if EEZ_FLOW_SNAPSHOT
+bool restoreDelayComponentExecutionState(FlowState *flowState, unsigned componentIndex, SnapshotReader &reader) {
+    auto delayComponentExecutionState = allocateComponentExecutionState<DelayComponenentExecutionState>(flowState, componentIndex);
+    delayComponentExecutionState->waitUntil = millis() + reader.readUint32();
+    return !reader.error;
+}
+#endif
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -2992,6 +4198,17 @@ void executeInputComponent(FlowState *flowState, unsigned componentIndex) {
         inputActionComponentExecutionState->value = value;
     }
 }
+#if EEZ_FLOW_SNAPSHOT
+bool InputActionComponentExecutionState::saveSnapshot(SnapshotWriter &writer) {
+    writer.writeValue(value);
+    return true;
+}
+bool restoreInputComponentExecutionState(FlowState *flowState, unsigned componentIndex, SnapshotReader &reader) {
+    auto inputActionComponentExecutionState = allocateComponentExecutionState<InputActionComponentExecutionState>(flowState, componentIndex);
+    reader.readValue(inputActionComponentExecutionState->value);
+    return !reader.error;
+}
+#endif
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -3224,6 +4441,7 @@ enum GroupActions {
 };
 struct LVGLExecutionState : public ComponenentExecutionState {
     uint32_t actionIndex;
+    bool canMigrate() override { return true; }
 };
 void executeLVGLComponent(FlowState *flowState, unsigned componentIndex) {
     auto component = (LVGLComponent *)flowState->flow->components[componentIndex];
@@ -4241,6 +5459,7 @@ static ActionType actions[] = {
 };
 struct LVGLApiExecutionState : public ComponenentExecutionState {
     uint32_t actionIndex;
+    bool canMigrate() override { return true; }
 };
 void executeLVGLApiComponent(FlowState *flowState, unsigned componentIndex) {
     auto component = (LVGLApiComponent *)flowState->flow->components[componentIndex];
@@ -4273,7 +5492,7 @@ LVGLUserWidgetExecutionState *createUserWidgetFlowState(FlowState *flowState, un
         Value value = Value::makePropertyRef(flowState, userWidgetWidgetComponentIndex, i, 0x5166d8a4);
         auto propValuePtr = userWidgetFlowState->values + userWidgetFlowState->flow->componentInputs.count + (i - offset);
         *propValuePtr = value;
-        onValueChanged(propValuePtr);
+        onValueChanged(userWidgetFlowState, propValuePtr);
     }
     auto userWidgetWidgetExecutionState = allocateComponentExecutionState<LVGLUserWidgetExecutionState>(flowState, userWidgetWidgetComponentIndex);
     userWidgetWidgetExecutionState->flowState = userWidgetFlowState;
@@ -4346,6 +5565,7 @@ struct MQTTEventActionComponenentExecutionState : public ComponenentExecutionSta
     MQTTEvent *lastEvent;
     MQTTEventActionComponenentExecutionState() : firstEvent(nullptr), lastEvent(nullptr) {}
     virtual ~MQTTEventActionComponenentExecutionState() override;
+    bool canMigrate() override { return true; }
     void addEvent(int16_t outputIndex, Value value = Value(VALUE_TYPE_NULL)) {
         auto event = ObjectAllocator<MQTTEvent>::allocate(0xe1b95933);
         event->outputIndex = outputIndex;
@@ -4837,7 +6057,12 @@ void executeSelectLanguageComponent(FlowState *flowState, unsigned componentInde
     auto &languages = flowState->assets->languages;
     for (uint32_t languageIndex = 0; languageIndex < languages.count; languageIndex++) {
         if (strcmp(languages[languageIndex]->languageID, language) == 0) {
-            g_selectedLanguage = languageIndex;
+            g_runtimeContext->selectedLanguage = languageIndex;
+            resetTranslations();
+            if (!loadTranslations(flowState->assets)) {
+                throwError(flowState, componentIndex, FlowError::Plain("Failed to load translations"));
+                return;
+            }
 	        propagateValueThroughSeqout(flowState, componentIndex);
             return;
         }
@@ -4846,6 +6071,52 @@ void executeSelectLanguageComponent(FlowState *flowState, unsigned componentInde
     snprintf(message, sizeof(message), "Unknown language %s", language);
     throwError(flowState, componentIndex, FlowError::Plain(message));
 }
+bool loadTranslations(Assets *assets) {
+    if (g_runtimeContext->translationsAssets == assets) {
+        return true;
+    }
+    int languageIndex = g_runtimeContext->selectedLanguage;
+    auto &languages = assets->languages;
+    if (languageIndex < 0 || languageIndex >= (int)languages.count) {
+        g_runtimeContext->translations = Value::makeArrayRef(0, VALUE_TYPE_STRING, 0x71c4e0a9);
+        g_runtimeContext->translationsAssets = assets;
+        return true;
+    }
+    if (!loadAssetsSection(assets, ASSETS_SECTION_LANGUAGE_TRANSLATIONS + languageIndex)) {
+        return false;
+    }
+    auto &translations = languages[languageIndex]->translations;
+    auto translationsValue = Value::makeArrayRef(translations.count, VALUE_TYPE_STRING, 0x71c4e0a9);
+    if (translationsValue.getType() != VALUE_TYPE_ARRAY_REF) {
+        return false;
+    }
+    auto array = translationsValue.getArray();
+    for (uint32_t i = 0; i < translations.count; i++) {
+        array->values[i] = Value::makeStringRef(translations[i], -1, 0x2a5f9c63);
+        if (array->values[i].getType() != VALUE_TYPE_STRING_REF) {
+            return false;
+        }
+    }
+    unloadAssetsSection(assets, ASSETS_SECTION_LANGUAGE_TRANSLATIONS + languageIndex);
+    g_runtimeContext->translations = translationsValue;
+    g_runtimeContext->translationsAssets = assets;
+    return true;
+}
+void resetTranslations() {
+    g_runtimeContext->translations = Value();
+    g_runtimeContext->translationsAssets = nullptr;
+}
+void releaseUnusedTranslations() {
+    auto assets = g_runtimeContext->mainAssets;
+    if (!assets) {
+        return;
+    }
+    for (uint32_t languageIndex = 0; languageIndex < assets->languages.count; languageIndex++) {
+        if ((int)languageIndex != g_runtimeContext->selectedLanguage) {
+            unloadAssetsSection(assets, ASSETS_SECTION_LANGUAGE_TRANSLATIONS + languageIndex);
+        }
+    }
+}
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -5068,6 +6339,8 @@ namespace flow {
 struct WatchVariableComponenentExecutionState : public ComponenentExecutionState {
 	Value value;
     WatchListNode *node;
+    bool canMigrate() override { return true; }
+    void migrate() override { value = value.clone(); }
 };
 void executeWatchVariableComponent(FlowState *flowState, unsigned componentIndex) {
 	auto watchVariableComponentExecutionState = (WatchVariableComponenentExecutionState *)flowState->componenentExecutionStates[componentIndex];
@@ -5347,7 +6620,9 @@ enum MessagesToDebugger {
     MESSAGE_TO_DEBUGGER_LOG, 
 	MESSAGE_TO_DEBUGGER_PAGE_CHANGED, 
     MESSAGE_TO_DEBUGGER_COMPONENT_EXECUTION_STATE_CHANGED, 
-    MESSAGE_TO_DEBUGGER_COMPONENT_ASYNC_STATE_CHANGED 
+    MESSAGE_TO_DEBUGGER_COMPONENT_ASYNC_STATE_CHANGED, 
+    MESSAGE_TO_DEBUGGER_ALLOC_TAG_INFO, 
+    MESSAGE_TO_DEBUGGER_TRACE 
 };
 enum MessagesFromDebugger {
     MESSAGE_FROM_DEBUGGER_RESUME, 
@@ -5357,66 +6632,331 @@ enum MessagesFromDebugger {
     MESSAGE_FROM_DEBUGGER_REMOVE_BREAKPOINT, 
     MESSAGE_FROM_DEBUGGER_ENABLE_BREAKPOINT, 
     MESSAGE_FROM_DEBUGGER_DISABLE_BREAKPOINT, 
-    MESSAGE_FROM_DEBUGGER_MODE 
+    MESSAGE_FROM_DEBUGGER_MODE, 
+    MESSAGE_FROM_DEBUGGER_VALUE_RATE_LIMIT, 
+    MESSAGE_FROM_DEBUGGER_COMPONENT_RATE_LIMIT, 
+    MESSAGE_FROM_DEBUGGER_GET_ALLOC_TAG_INFO, 
+    MESSAGE_FROM_DEBUGGER_GET_TRACE 
 };
-enum LogItemType {
-	LOG_ITEM_TYPE_FATAL,
-	LOG_ITEM_TYPE_ERROR,
-    LOG_ITEM_TYPE_WARNING ,
-    LOG_ITEM_TYPE_SCPI,
-    LOG_ITEM_TYPE_INFO,
-    LOG_ITEM_TYPE_DEBUG
-};
-enum DebuggerState {
-    DEBUGGER_STATE_RESUMED,
-    DEBUGGER_STATE_PAUSED,
-    DEBUGGER_STATE_SINGLE_STEP,
-    DEBUGGER_STATE_STOPPED,
-};
-bool g_debuggerIsConnected;
-static uint32_t g_messageSubsciptionFilter = 0xFFFFFFFF;
-static DebuggerState g_debuggerState;
-static bool g_skipNextBreakpoint;
-static char g_inputFromDebugger[64];
-static unsigned g_inputFromDebuggerPosition;
-int g_debuggerMode = DEBUGGER_MODE_RUN;
+static const uint32_t OUTPUT_BUFFER_MASK = EEZ_FLOW_DEBUGGER_OUTPUT_BUFFER_SIZE - 1;
+uint32_t peekDebuggerOutput(const char *&span1, uint32_t &length1, const char *&span2, uint32_t &length2) {
+    uint32_t head = g_runtimeContext->outputBufferHead.load(std::memory_order_acquire);
+    uint32_t tail = g_runtimeContext->outputBufferTail.load(std::memory_order_relaxed);
+    uint32_t length = head - tail;
+    uint32_t start = tail & OUTPUT_BUFFER_MASK;
+    span1 = g_runtimeContext->outputBuffer + start;
+    length1 = length < EEZ_FLOW_DEBUGGER_OUTPUT_BUFFER_SIZE - start ? length : EEZ_FLOW_DEBUGGER_OUTPUT_BUFFER_SIZE - start;
+    span2 = g_runtimeContext->outputBuffer;
+    length2 = length - length1;
+    return length;
+}
+void consumeDebuggerOutput(uint32_t length) {
+    uint32_t tail = g_runtimeContext->outputBufferTail.load(std::memory_order_relaxed);
+    g_runtimeContext->outputBufferTail.store(tail + length, std::memory_order_release);
+}
+void drainDebuggerOutput() {
+    const char *span1;
+    const char *span2;
+    uint32_t length1;
+    uint32_t length2;
+    if (peekDebuggerOutput(span1, length1, span2, length2)) {
+        writeDebuggerBufferHook(span1, length1);
+        if (length2) {
+            writeDebuggerBufferHook(span2, length2);
+        }
+        consumeDebuggerOutput(length1 + length2);
+    }
+}
+void notifyDebuggerOutput() {
+    if (
+        g_runtimeContext->outputBufferHead.load(std::memory_order_relaxed) !=
+        g_runtimeContext->outputBufferTail.load(std::memory_order_acquire)
+    ) {
+        debuggerOutputAvailableHook();
+    }
+}
+static uint32_t getDebuggerOutputFreeSpace() {
+    uint32_t tail = g_runtimeContext->outputBufferTail.load(std::memory_order_acquire);
+    return EEZ_FLOW_DEBUGGER_OUTPUT_BUFFER_SIZE - (g_runtimeContext->outputBufferWritePosition - tail);
+}
+static void writeDebuggerOutput(const char *data, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    bool endOfMessage = data[length - 1] == '\n';
+    while (length > 0) {
+        uint32_t chunkLength = getDebuggerOutputFreeSpace();
+        if (chunkLength == 0) {
+            // ring is full, publish the part of the message written so far and wait until consumer makes room
+            g_runtimeContext->outputBufferHead.store(g_runtimeContext->outputBufferWritePosition, std::memory_order_release);
+            debuggerOutputAvailableHook();
+            continue;
+        }
+        if (chunkLength > length) {
+            chunkLength = (uint32_t)length;
+        }
+        uint32_t start = g_runtimeContext->outputBufferWritePosition & OUTPUT_BUFFER_MASK;
+        uint32_t length1 = EEZ_FLOW_DEBUGGER_OUTPUT_BUFFER_SIZE - start;
+        if (length1 > chunkLength) {
+            length1 = chunkLength;
+        }
+        memcpy(g_runtimeContext->outputBuffer + start, data, length1);
+        memcpy(g_runtimeContext->outputBuffer, data + length1, chunkLength - length1);
+        g_runtimeContext->outputBufferWritePosition += chunkLength;
+        data += chunkLength;
+        length -= chunkLength;
+    }
+    if (endOfMessage) {
+        g_runtimeContext->outputBufferHead.store(g_runtimeContext->outputBufferWritePosition, std::memory_order_release);
+    }
+}
+static inline void writeDebuggerOutput(char ch) {
+    writeDebuggerOutput(&ch, 1);
+}
+static void updateStepGate() {
+    g_runtimeContext->stepGateArmed =
+        g_runtimeContext->debuggerIsConnected &&
+        (g_runtimeContext->messageSubsciptionFilter & (1 << MESSAGE_TO_DEBUGGER_ADD_TO_QUEUE)) != 0 &&
+        (g_runtimeContext->debuggerState != DEBUGGER_STATE_RESUMED || g_runtimeContext->numArmedBreakpoints > 0);
+}
 void setDebuggerMessageSubsciptionFilter(uint32_t filter) {
-    g_messageSubsciptionFilter = filter;
+    g_runtimeContext->messageSubsciptionFilter = filter;
+    updateStepGate();
+}
+bool addDebuggerFlowSubscriptionFilter(int16_t flowIndex, uint16_t firstComponentIndex, uint16_t lastComponentIndex) {
+    if (g_runtimeContext->numDebuggerFlowFilters == EEZ_FLOW_DEBUGGER_FLOW_FILTERS_SIZE) {
+        return false;
+    }
+    auto &flowFilter = g_runtimeContext->debuggerFlowFilters[g_runtimeContext->numDebuggerFlowFilters++];
+    flowFilter.flowIndex = flowIndex;
+    flowFilter.firstComponentIndex = firstComponentIndex;
+    flowFilter.lastComponentIndex = lastComponentIndex;
+    return true;
+}
+void clearDebuggerFlowSubscriptionFilters() {
+    g_runtimeContext->numDebuggerFlowFilters = 0;
 }
 static bool isSubscribedTo(MessagesToDebugger messageType) {
-    if (g_debuggerIsConnected && (g_messageSubsciptionFilter & (1 << messageType)) != 0) {
+    if (g_runtimeContext->debuggerIsConnected && (g_runtimeContext->messageSubsciptionFilter & (1 << messageType)) != 0) {
         startToDebuggerMessageHook();
         return true;
     }
     return false;
 }
+static bool isFlowSubscribed(FlowState *flowState, int componentIndex) {
+    if (componentIndex < 0 && flowState->debuggerAnnounced) {
+        return true;
+    }
+    for (unsigned i = 0; i < g_runtimeContext->numDebuggerFlowFilters; i++) {
+        auto &flowFilter = g_runtimeContext->debuggerFlowFilters[i];
+        if (
+            flowFilter.flowIndex == flowState->flowIndex &&
+            (componentIndex < 0 || (componentIndex >= flowFilter.firstComponentIndex && componentIndex <= flowFilter.lastComponentIndex))
+        ) {
+            return true;
+        }
+    }
+    return false;
+}
+static bool isSubscribedTo(MessagesToDebugger messageType, FlowState *flowState, int componentIndex) {
+    if (!g_runtimeContext->debuggerIsConnected) {
+        return false;
+    }
+    if (g_runtimeContext->numDebuggerFlowFilters > 0 && !isFlowSubscribed(flowState, componentIndex)) {
+        return false;
+    }
+    return isSubscribedTo(messageType);
+}
 static void setDebuggerState(DebuggerState newState) {
-	if (newState != g_debuggerState) {
-		g_debuggerState = newState;
+	if (newState != g_runtimeContext->debuggerState) {
+		g_runtimeContext->debuggerState = newState;
+        updateStepGate();
 		if (isSubscribedTo(MESSAGE_TO_DEBUGGER_STATE_CHANGED)) {
 			char buffer[256];
 			snprintf(buffer, sizeof(buffer), "%d\t%d\n",
 				MESSAGE_TO_DEBUGGER_STATE_CHANGED,
-				g_debuggerState
+				g_runtimeContext->debuggerState
 			);
-			writeDebuggerBufferHook(buffer, strlen(buffer));
+			writeDebuggerOutput(buffer, strlen(buffer));
 		}
 	}
 }
+static void resetDebuggerSamples() {
+    for (unsigned i = 0; i < EEZ_FLOW_DEBUGGER_SAMPLES_SIZE; i++) {
+        g_runtimeContext->debuggerSamples[i].key = nullptr;
+        g_runtimeContext->debuggerSamples[i].pending = false;
+    }
+    g_runtimeContext->numPendingDebuggerSamples = 0;
+}
+static void resetDebuggerRateLimits() {
+    g_runtimeContext->debuggerValueRateLimit = 0;
+    g_runtimeContext->debuggerComponentRateLimit = 0;
+    g_runtimeContext->numDebuggerRateLimits = 0;
+    resetDebuggerSamples();
+}
+static void setDebuggerRateLimit(int32_t flowIndex, uint32_t index, uint32_t intervalMs) {
+    for (unsigned i = 0; i < g_runtimeContext->numDebuggerRateLimits; i++) {
+        auto &rateLimit = g_runtimeContext->debuggerRateLimits[i];
+        if (rateLimit.flowIndex == flowIndex && rateLimit.index == index) {
+            rateLimit.intervalMs = intervalMs;
+            return;
+        }
+    }
+    if (g_runtimeContext->numDebuggerRateLimits == EEZ_FLOW_DEBUGGER_RATE_LIMITS_SIZE) {
+        ErrorTrace("Too many debugger rate limits\n");
+        return;
+    }
+    auto &rateLimit = g_runtimeContext->debuggerRateLimits[g_runtimeContext->numDebuggerRateLimits++];
+    rateLimit.flowIndex = flowIndex;
+    rateLimit.index = index;
+    rateLimit.intervalMs = intervalMs;
+}
+static uint32_t getDebuggerRateLimit(int32_t flowIndex, uint32_t index, uint32_t defaultIntervalMs) {
+    for (unsigned i = 0; i < g_runtimeContext->numDebuggerRateLimits; i++) {
+        auto &rateLimit = g_runtimeContext->debuggerRateLimits[i];
+        if (rateLimit.flowIndex == flowIndex && rateLimit.index == index) {
+            return rateLimit.intervalMs;
+        }
+    }
+    return defaultIntervalMs;
+}
 void onDebuggerClientConnected() {
-    g_debuggerIsConnected = true;
-	g_skipNextBreakpoint = false;
-	g_inputFromDebuggerPosition = 0;
+    g_runtimeContext->debuggerIsConnected = true;
+    resetDebuggerRateLimits();
+	g_runtimeContext->skipNextBreakpoint = false;
+	g_runtimeContext->inputFromDebuggerPosition = 0;
     setDebuggerState(DEBUGGER_STATE_PAUSED);
+    updateStepGate();
 }
 void onDebuggerClientDisconnected() {
-    g_debuggerIsConnected = false;
+    g_runtimeContext->debuggerIsConnected = false;
     setDebuggerState(DEBUGGER_STATE_RESUMED);
+    updateStepGate();
+}
+static void setBreakpoint(Assets *assets, uint32_t flowIndex, uint32_t componentIndex, bool enabled) {
+    auto flowBreakpoints = getFlowBreakpoints(assets, flowIndex);
+    if (!flowBreakpoints) {
+        return;
+    }
+    auto &word = flowBreakpoints[componentIndex >> 5];
+    auto mask = 1u << (componentIndex & 31);
+    if (enabled && !(word & mask)) {
+        word |= mask;
+        g_runtimeContext->numArmedBreakpoints++;
+    } else if (!enabled && (word & mask)) {
+        word &= ~mask;
+        g_runtimeContext->numArmedBreakpoints--;
+    }
+    updateStepGate();
+}
+void initBreakpoints(Assets *assets) {
+    freeBreakpoints();
+    auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
+    uint32_t numWords = flowDefinition->flows.count;
+    for (uint32_t flowIndex = 0; flowIndex < flowDefinition->flows.count; flowIndex++) {
+        numWords += (flowDefinition->flows[flowIndex]->components.count + 31) >> 5;
+    }
+    auto breakpoints = (uint32_t *)alloc(numWords * sizeof(uint32_t), 0x3d9b05a1);
+    if (!breakpoints) {
+        ErrorTrace("Not enough memory for breakpoints\n");
+        return;
+    }
+    memset(breakpoints, 0, numWords * sizeof(uint32_t));
+    g_runtimeContext->breakpoints = breakpoints;
+    uint32_t offset = flowDefinition->flows.count;
+    for (uint32_t flowIndex = 0; flowIndex < flowDefinition->flows.count; flowIndex++) {
+        auto flow = flowDefinition->flows[flowIndex];
+        breakpoints[flowIndex] = offset;
+        offset += (flow->components.count + 31) >> 5;
+        for (uint32_t componentIndex = 0; componentIndex < flow->components.count; componentIndex++) {
+            if (flow->components[componentIndex]->breakpoint) {
+                setBreakpoint(assets, flowIndex, componentIndex, true);
+            }
+        }
+    }
+}
+void freeBreakpoints() {
+    if (g_runtimeContext->breakpoints) {
+        free(g_runtimeContext->breakpoints);
+        g_runtimeContext->breakpoints = nullptr;
+    }
+    g_runtimeContext->numArmedBreakpoints = 0;
+    updateStepGate();
+}
+uint32_t *getFlowBreakpoints(Assets *assets, int flowIndex) {
+    if (!g_runtimeContext->breakpoints || assets != g_runtimeContext->mainAssets) {
+        return nullptr;
+    }
+    return g_runtimeContext->breakpoints + g_runtimeContext->breakpoints[flowIndex];
+}
+#if EEZ_ALLOC_TRACKING
+static void writeAllocTagInfo() {
+    if (!isSubscribedTo(MESSAGE_TO_DEBUGGER_ALLOC_TAG_INFO)) {
+        return;
+    }
+    AllocTagInfo tagInfos[8];
+    uint32_t firstTagInfo = 0;
+    uint32_t numTagInfos;
+    while ((numTagInfos = getAllocInfo(tagInfos, 8, firstTagInfo)) > 0) {
+        firstTagInfo += numTagInfos;
+        for (uint32_t i = 0; i < numTagInfos; i++) {
+            char buffer[256];
+            snprintf(buffer, sizeof(buffer), "%d\t%08" PRIx32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu64 "\n",
+                MESSAGE_TO_DEBUGGER_ALLOC_TAG_INFO,
+                tagInfos[i].id,
+                tagInfos[i].liveCount,
+                tagInfos[i].peakCount,
+                tagInfos[i].liveBytes,
+                tagInfos[i].peakBytes,
+                tagInfos[i].totalCount,
+                tagInfos[i].cumulativeBytes
+            );
+            writeDebuggerOutput(buffer, strlen(buffer));
+        }
+    }
+}
+#endif
+#if EEZ_FLOW_TRACE
+static void writeTrace() {
+    if (!isSubscribedTo(MESSAGE_TO_DEBUGGER_TRACE)) {
+        return;
+    }
+    uint32_t size = getTraceDumpSize();
+    auto dump = (uint8_t *)alloc(size, 0x5b0e7d12);
+    if (!dump) {
+        ErrorTrace("Not enough memory for the trace dump\n");
+        return;
+    }
+    size = dumpTrace(dump, size);
+    static const uint32_t TRACE_CHUNK_SIZE = 64;
+    for (uint32_t offset = 0; offset < size; offset += TRACE_CHUNK_SIZE) {
+        char buffer[64 + 2 * TRACE_CHUNK_SIZE];
+        int n = snprintf(buffer, sizeof(buffer), "%d\t%" PRIu32 "\t%" PRIu32 "\t",
+            MESSAGE_TO_DEBUGGER_TRACE,
+            offset,
+            size
+        );
+        uint32_t chunkSize = size - offset < TRACE_CHUNK_SIZE ? size - offset : TRACE_CHUNK_SIZE;
+        for (uint32_t i = 0; i < chunkSize; i++) {
+            n += snprintf(buffer + n, sizeof(buffer) - n, "%02x", dump[offset + i]);
+        }
+        buffer[n++] = '\n';
+        writeDebuggerOutput(buffer, n);
+    }
+    free(dump);
 }
+#endif
 void processDebuggerInput(char *buffer, uint32_t length) {
 	for (uint32_t i = 0; i < length; i++) {
 		if (buffer[i] == '\n') {
-			int messageFromDebugger = g_inputFromDebugger[0] - '0';
+			auto end = g_runtimeContext->inputFromDebuggerPosition < sizeof(g_runtimeContext->inputFromDebugger) ?
+				g_runtimeContext->inputFromDebuggerPosition : sizeof(g_runtimeContext->inputFromDebugger) - 1;
+			g_runtimeContext->inputFromDebugger[end] = 0;
+			char *messageArgs;
+			int messageFromDebugger = (int)strtol(g_runtimeContext->inputFromDebugger, &messageArgs, 10);
+			if (*messageArgs) {
+				messageArgs++;
+			}
 			if (messageFromDebugger == MESSAGE_FROM_DEBUGGER_RESUME) {
 				setDebuggerState(DEBUGGER_STATE_RESUMED);
 			} else if (messageFromDebugger == MESSAGE_FROM_DEBUGGER_PAUSE) {
@@ -5428,16 +6968,16 @@ void processDebuggerInput(char *buffer, uint32_t length) {
 				messageFromDebugger <= MESSAGE_FROM_DEBUGGER_DISABLE_BREAKPOINT
 			) {
 				char *p;
-				auto flowIndex = (uint32_t)strtol(g_inputFromDebugger + 2, &p, 10);
+				auto flowIndex = (uint32_t)strtol(messageArgs, &p, 10);
 				auto componentIndex = (uint32_t)strtol(p + 1, nullptr, 10);
-				auto assets = g_firstFlowState->assets;
+				auto assets = g_runtimeContext->firstFlowState->assets;
 				auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
 				if (flowIndex < flowDefinition->flows.count) {
 					auto flow = flowDefinition->flows[flowIndex];
 					if (componentIndex < flow->components.count) {
-						auto component = flow->components[componentIndex];
-						component->breakpoint = messageFromDebugger == MESSAGE_FROM_DEBUGGER_ADD_BREAKPOINT ||
-							messageFromDebugger == MESSAGE_FROM_DEBUGGER_ENABLE_BREAKPOINT ? 1 : 0;
+                        setBreakpoint(assets, flowIndex, componentIndex,
+                            messageFromDebugger == MESSAGE_FROM_DEBUGGER_ADD_BREAKPOINT ||
+                            messageFromDebugger == MESSAGE_FROM_DEBUGGER_ENABLE_BREAKPOINT);
 					} else {
 						ErrorTrace("Invalid breakpoint component index\n");
 					}
@@ -5445,126 +6985,127 @@ void processDebuggerInput(char *buffer, uint32_t length) {
 					ErrorTrace("Invalid breakpoint flow index\n");
 				}
 			} else if (messageFromDebugger == MESSAGE_FROM_DEBUGGER_MODE) {
-                g_debuggerMode = strtol(g_inputFromDebugger + 2, nullptr, 10);
+                g_runtimeContext->debuggerMode = strtol(messageArgs, nullptr, 10);
+            } else if (messageFromDebugger == MESSAGE_FROM_DEBUGGER_VALUE_RATE_LIMIT) {
+				char *p;
+				auto intervalMs = (uint32_t)strtol(messageArgs, &p, 10);
+				auto globalVariableIndex = (int32_t)strtol(p + 1, nullptr, 10);
+                if (globalVariableIndex < 0) {
+                    g_runtimeContext->debuggerValueRateLimit = intervalMs;
+                } else {
+                    setDebuggerRateLimit(-1, globalVariableIndex, intervalMs);
+                }
+            } else if (messageFromDebugger == MESSAGE_FROM_DEBUGGER_COMPONENT_RATE_LIMIT) {
+				char *p;
+				auto intervalMs = (uint32_t)strtol(messageArgs, &p, 10);
+				auto flowIndex = (int32_t)strtol(p + 1, &p, 10);
+				auto componentIndex = (uint32_t)strtol(p + 1, nullptr, 10);
+                if (flowIndex < 0) {
+                    g_runtimeContext->debuggerComponentRateLimit = intervalMs;
+                } else {
+                    setDebuggerRateLimit(flowIndex, componentIndex, intervalMs);
+                }
+            } else if (messageFromDebugger == MESSAGE_FROM_DEBUGGER_GET_ALLOC_TAG_INFO) {
+#if EEZ_ALLOC_TRACKING
+                writeAllocTagInfo();
+#endif
+            } else if (messageFromDebugger == MESSAGE_FROM_DEBUGGER_GET_TRACE) {
+#if EEZ_FLOW_TRACE
+                writeTrace();
+#endif
             }
-			g_inputFromDebuggerPosition = 0;
+			g_runtimeContext->inputFromDebuggerPosition = 0;
 		} else {
-			if (g_inputFromDebuggerPosition < sizeof(g_inputFromDebugger)) {
-				g_inputFromDebugger[g_inputFromDebuggerPosition++] = buffer[i];
-			} else if (g_inputFromDebuggerPosition == sizeof(g_inputFromDebugger)) {
+			if (g_runtimeContext->inputFromDebuggerPosition < sizeof(g_runtimeContext->inputFromDebugger)) {
+				g_runtimeContext->inputFromDebugger[g_runtimeContext->inputFromDebuggerPosition++] = buffer[i];
+			} else if (g_runtimeContext->inputFromDebuggerPosition == sizeof(g_runtimeContext->inputFromDebugger)) {
 				ErrorTrace("Input from debugger buffer overflow\n");
 			}
 		}
 	}
 }
 bool canExecuteStep(FlowState *&flowState, unsigned &componentIndex) {
-    if (!g_debuggerIsConnected) {
-        return true;
-    }
-    if (!isSubscribedTo(MESSAGE_TO_DEBUGGER_ADD_TO_QUEUE)) {
+    if (!g_runtimeContext->stepGateArmed) {
         return true;
     }
-    if (g_debuggerState == DEBUGGER_STATE_PAUSED) {
+    startToDebuggerMessageHook();
+    if (g_runtimeContext->debuggerState == DEBUGGER_STATE_PAUSED) {
         return false;
     }
-    if (g_debuggerState == DEBUGGER_STATE_SINGLE_STEP) {
-        g_skipNextBreakpoint = false;
+    if (g_runtimeContext->debuggerState == DEBUGGER_STATE_SINGLE_STEP) {
+        g_runtimeContext->skipNextBreakpoint = false;
 	    setDebuggerState(DEBUGGER_STATE_PAUSED);
         return true;
     }
-    auto component = flowState->flow->components[componentIndex];
-    if (g_skipNextBreakpoint) {
-        if (component->breakpoint) {
-            g_skipNextBreakpoint = false;
+    bool isBreakpoint = flowState->breakpoints &&
+        (flowState->breakpoints[componentIndex >> 5] & (1u << (componentIndex & 31))) != 0;
+    if (g_runtimeContext->skipNextBreakpoint) {
+        if (isBreakpoint) {
+            g_runtimeContext->skipNextBreakpoint = false;
         }
     } else {
-        if (component->breakpoint) {
-            g_skipNextBreakpoint = true;
+        if (isBreakpoint) {
+            g_runtimeContext->skipNextBreakpoint = true;
 			setDebuggerState(DEBUGGER_STATE_PAUSED);
             return false;
         }
     }
     return true;
 }
-#if defined(__EMSCRIPTEN__)
-char outputBuffer[1024 * 1024];
-#else
-char outputBuffer[64];
-#endif
-int outputBufferPosition = 0;
-#define WRITE_TO_OUTPUT_BUFFER(ch) \
-	outputBuffer[outputBufferPosition++] = ch; \
-	if (outputBufferPosition == sizeof(outputBuffer)) { \
-		writeDebuggerBufferHook(outputBuffer, outputBufferPosition); \
-		outputBufferPosition = 0; \
-	}
-#define FLUSH_OUTPUT_BUFFER() \
-	if (outputBufferPosition > 0) { \
-		writeDebuggerBufferHook(outputBuffer, outputBufferPosition); \
-		outputBufferPosition = 0; \
-	}
 static void writeValueAddr(const void *pValue) {
 	char tmpStr[32];
 	snprintf(tmpStr, sizeof(tmpStr), "%p", pValue);
-	auto len = strlen(tmpStr);
-	for (size_t i = 0; i < len; i++) {
-		WRITE_TO_OUTPUT_BUFFER(tmpStr[i]);
-	}
+	writeDebuggerOutput(tmpStr, strlen(tmpStr));
 }
 static void writeString(const char *str) {
-	WRITE_TO_OUTPUT_BUFFER('"');
+	writeDebuggerOutput('"');
+    const char *run = str;
     while (true) {
         utf8_int32_t cp;
-        str = utf8codepoint(str, &cp);
+        const char *next = utf8codepoint(str, &cp);
+        if (cp >= 32 && cp < 127 && cp != '"') {
+            str = next;
+            continue;
+        }
+        writeDebuggerOutput(run, str - run);
         if (!cp) {
             break;
         }
         if (cp == '"') {
-			WRITE_TO_OUTPUT_BUFFER('\\');
-			WRITE_TO_OUTPUT_BUFFER('"');
+            writeDebuggerOutput("\\\"", 2);
 		} else if (cp == '\t') {
-			WRITE_TO_OUTPUT_BUFFER('\\');
-			WRITE_TO_OUTPUT_BUFFER('t');
+            writeDebuggerOutput("\\t", 2);
 		} else if (cp == '\n') {
-			WRITE_TO_OUTPUT_BUFFER('\\');
-			WRITE_TO_OUTPUT_BUFFER('n');
-		} else if (cp >= 32 && cp < 127) {
-			WRITE_TO_OUTPUT_BUFFER(cp);
+            writeDebuggerOutput("\\n", 2);
         } else {
             char temp[32];
             snprintf(temp, sizeof(temp), "\\u%04x", (int)cp);
-            for (size_t i = 0; i < strlen(temp); i++) {
-			    WRITE_TO_OUTPUT_BUFFER(temp[i]);
-            }
+            writeDebuggerOutput(temp, strlen(temp));
         }
+        str = next;
+        run = str;
     }
-	WRITE_TO_OUTPUT_BUFFER('"');
-	WRITE_TO_OUTPUT_BUFFER('\n');
-	FLUSH_OUTPUT_BUFFER();
+	writeDebuggerOutput("\"\n", 2);
 }
 static void writeArrayType(uint32_t arrayType) {
 	char tmpStr[32];
 	snprintf(tmpStr, sizeof(tmpStr), "%x", (int)arrayType);
-	auto len = strlen(tmpStr);
-	for (size_t i = 0; i < len; i++) {
-		WRITE_TO_OUTPUT_BUFFER(tmpStr[i]);
-	}
+	writeDebuggerOutput(tmpStr, strlen(tmpStr));
 }
 static void writeArray(const ArrayValue *arrayValue) {
-	WRITE_TO_OUTPUT_BUFFER('{');
+	writeDebuggerOutput('{');
 	writeValueAddr(arrayValue);
-    WRITE_TO_OUTPUT_BUFFER(',');
+    writeDebuggerOutput(',');
     writeArrayType(arrayValue->arraySize);
-    WRITE_TO_OUTPUT_BUFFER(',');
+    writeDebuggerOutput(',');
     writeArrayType(arrayValue->arrayType);
     auto transferredSize = arrayValue->arraySize > MAX_ARRAY_SIZE_TRANSFERRED_IN_DEBUGGER ? MAX_ARRAY_SIZE_TRANSFERRED_IN_DEBUGGER : arrayValue->arraySize;
 	for (uint32_t i = 0; i < transferredSize; i++) {
-		WRITE_TO_OUTPUT_BUFFER(',');
+		writeDebuggerOutput(',');
 		writeValueAddr(&arrayValue->values[i]);
 	}
-	WRITE_TO_OUTPUT_BUFFER('}');
-	WRITE_TO_OUTPUT_BUFFER('\n');
-	FLUSH_OUTPUT_BUFFER();
+	writeDebuggerOutput('}');
+	writeDebuggerOutput('\n');
     for (uint32_t i = 0; i < transferredSize; i++) {
         onValueChanged(&arrayValue->values[i]);
     }
@@ -5671,21 +7212,24 @@ static void writeValue(const Value &value) {
 #pragma warning(pop)
 #endif
 	stringAppendString(tempStr, sizeof(tempStr), "\n");
-	writeDebuggerBufferHook(tempStr, strlen(tempStr));
+	writeDebuggerOutput(tempStr, strlen(tempStr));
 }
 void onStarted(Assets *assets) {
+    if (!assets->external) {
+        resetDebuggerSamples();
+    }
     if (!assets->external && isSubscribedTo(MESSAGE_TO_DEBUGGER_GLOBAL_VARIABLE_INIT)) {
 		auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
-        if (g_globalVariables) {
-            for (uint32_t i = 0; i < g_globalVariables->count; i++) {
-                auto pValue = g_globalVariables->values + i;
+        if (g_runtimeContext->globalVariables) {
+            for (uint32_t i = 0; i < g_runtimeContext->globalVariables->count; i++) {
+                auto pValue = g_runtimeContext->globalVariables->values + i;
                 char buffer[256];
                 snprintf(buffer, sizeof(buffer), "%d\t%d\t%p\t",
                     MESSAGE_TO_DEBUGGER_GLOBAL_VARIABLE_INIT,
                     (int)i,
                     (const void *)pValue
                 );
-                writeDebuggerBufferHook(buffer, strlen(buffer));
+                writeDebuggerOutput(buffer, strlen(buffer));
                 writeValue(*pValue);
             }
         } else {
@@ -5697,7 +7241,7 @@ void onStarted(Assets *assets) {
                     (int)i,
                     (const void *)pValue
                 );
-                writeDebuggerBufferHook(buffer, strlen(buffer));
+                writeDebuggerOutput(buffer, strlen(buffer));
                 writeValue(*pValue);
             }
         }
@@ -5705,9 +7249,66 @@ void onStarted(Assets *assets) {
 }
 void onStopped() {
     setDebuggerState(DEBUGGER_STATE_STOPPED);
+    resetDebuggerSamples();
+}
+static DebuggerSample *getDebuggerSample(const void *key, uint32_t index, uint32_t intervalMs) {
+    auto hash = (uint32_t)((uintptr_t)key >> 3) * 31 + index;
+    auto &sample = g_runtimeContext->debuggerSamples[hash % EEZ_FLOW_DEBUGGER_SAMPLES_SIZE];
+    if (sample.key != key || sample.index != index) {
+        if (sample.pending) {
+            return nullptr;
+        }
+        sample.key = key;
+        sample.index = index;
+        sample.lastSentTime = millis() - intervalMs;
+    }
+    sample.intervalMs = intervalMs;
+    return &sample;
+}
+static bool isDebuggerSampleDue(DebuggerSample *sample) {
+    return millis() - sample->lastSentTime >= sample->intervalMs;
+}
+static void writeValueChanged(const Value *pValue) {
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%d\t%p\t",
+        MESSAGE_TO_DEBUGGER_VALUE_CHANGED,
+        (const void *)pValue
+    );
+    writeDebuggerOutput(buffer, strlen(buffer));
+    writeValue(pValue->getValue());
+}
+void flushDebuggerSamples() {
+    if (!g_runtimeContext->numPendingDebuggerSamples) {
+        return;
+    }
+    if (!isSubscribedTo(MESSAGE_TO_DEBUGGER_VALUE_CHANGED)) {
+        resetDebuggerSamples();
+        return;
+    }
+    for (unsigned i = 0; i < EEZ_FLOW_DEBUGGER_SAMPLES_SIZE; i++) {
+        auto sample = &g_runtimeContext->debuggerSamples[i];
+        if (sample->pending && isDebuggerSampleDue(sample)) {
+            sample->pending = false;
+            sample->lastSentTime = millis();
+            g_runtimeContext->numPendingDebuggerSamples--;
+            writeValueChanged((const Value *)sample->key);
+        }
+    }
 }
-void onAddToQueue(FlowState *flowState, int sourceComponentIndex, int sourceOutputIndex, unsigned targetComponentIndex, int targetInputIndex) {
-    if (isSubscribedTo(MESSAGE_TO_DEBUGGER_ADD_TO_QUEUE)) {
+bool onAddToQueue(FlowState *flowState, int sourceComponentIndex, int sourceOutputIndex, unsigned targetComponentIndex, int targetInputIndex) {
+    if (isSubscribedTo(MESSAGE_TO_DEBUGGER_ADD_TO_QUEUE, flowState, targetComponentIndex)) {
+        if (g_runtimeContext->debuggerState == DEBUGGER_STATE_RESUMED && (g_runtimeContext->debuggerComponentRateLimit || g_runtimeContext->numDebuggerRateLimits)) {
+            auto intervalMs = getDebuggerRateLimit(flowState->flowIndex, targetComponentIndex, g_runtimeContext->debuggerComponentRateLimit);
+            if (intervalMs) {
+                auto sample = getDebuggerSample(flowState, targetComponentIndex + 1, intervalMs);
+                if (sample) {
+                    if (!isDebuggerSampleDue(sample)) {
+                        return false;
+                    }
+                    sample->lastSentTime = millis();
+                }
+            }
+        }
         uint32_t free;
         uint32_t alloc;
         getAllocInfo(free, alloc);
@@ -5722,8 +7323,10 @@ void onAddToQueue(FlowState *flowState, int sourceComponentIndex, int sourceOutp
             (unsigned int)free,
             (unsigned int)alloc
 		);
-        writeDebuggerBufferHook(buffer, strlen(buffer));
+        writeDebuggerOutput(buffer, strlen(buffer));
+        return true;
     }
+    return false;
 }
 void onRemoveFromQueue() {
     if (isSubscribedTo(MESSAGE_TO_DEBUGGER_REMOVE_FROM_QUEUE)) {
@@ -5731,21 +7334,46 @@ void onRemoveFromQueue() {
 		snprintf(buffer, sizeof(buffer), "%d\n",
 			MESSAGE_TO_DEBUGGER_REMOVE_FROM_QUEUE
 		);
-        writeDebuggerBufferHook(buffer, strlen(buffer));
+        writeDebuggerOutput(buffer, strlen(buffer));
     }
 }
 void onValueChanged(const Value *pValue) {
     if (isSubscribedTo(MESSAGE_TO_DEBUGGER_VALUE_CHANGED)) {
-        char buffer[256];
-		snprintf(buffer, sizeof(buffer), "%d\t%p\t",
-			MESSAGE_TO_DEBUGGER_VALUE_CHANGED,
-            (const void *)pValue
-		);
-        writeDebuggerBufferHook(buffer, strlen(buffer));
-		writeValue(pValue->getValue());
+        auto globalVariables = g_runtimeContext->globalVariables;
+        if (
+            (g_runtimeContext->debuggerValueRateLimit || g_runtimeContext->numDebuggerRateLimits) &&
+            globalVariables && pValue >= globalVariables->values && pValue < globalVariables->values + globalVariables->count
+        ) {
+            auto intervalMs = getDebuggerRateLimit(-1, (uint32_t)(pValue - globalVariables->values), g_runtimeContext->debuggerValueRateLimit);
+            if (intervalMs) {
+                auto sample = getDebuggerSample(pValue, 0, intervalMs);
+                if (sample) {
+                    if (!isDebuggerSampleDue(sample)) {
+                        if (!sample->pending) {
+                            sample->pending = true;
+                            g_runtimeContext->numPendingDebuggerSamples++;
+                        }
+                        return;
+                    }
+                    if (sample->pending) {
+                        sample->pending = false;
+                        g_runtimeContext->numPendingDebuggerSamples--;
+                    }
+                    sample->lastSentTime = millis();
+                }
+            }
+        }
+        writeValueChanged(pValue);
     }
 }
-void onFlowStateCreated(FlowState *flowState) {
+void onValueChanged(FlowState *flowState, const Value *pValue) {
+    if (g_runtimeContext->numDebuggerFlowFilters > 0 && g_runtimeContext->debuggerIsConnected && !isFlowSubscribed(flowState, -1)) {
+        return;
+    }
+    onValueChanged(pValue);
+}
+static void writeFlowStateCreated(FlowState *flowState) {
+    flowState->debuggerAnnounced = true;
     if (isSubscribedTo(MESSAGE_TO_DEBUGGER_FLOW_STATE_CREATED)) {
         char buffer[256];
 		snprintf(buffer, sizeof(buffer), "%d\t%d\t%d\t%d\t%d\n",
@@ -5755,7 +7383,7 @@ void onFlowStateCreated(FlowState *flowState) {
 			(int)(flowState->parentFlowState ? flowState->parentFlowState->flowStateIndex : -1),
 			(int)flowState->parentComponentIndex
 		);
-        writeDebuggerBufferHook(buffer, strlen(buffer));
+        writeDebuggerOutput(buffer, strlen(buffer));
     }
     if (isSubscribedTo(MESSAGE_TO_DEBUGGER_LOCAL_VARIABLE_INIT)) {
 		auto flow = flowState->flow;
@@ -5768,7 +7396,7 @@ void onFlowStateCreated(FlowState *flowState) {
 				(int)i,
                 (const void *)pValue
             );
-            writeDebuggerBufferHook(buffer, strlen(buffer));
+            writeDebuggerOutput(buffer, strlen(buffer));
 			writeValue(*pValue);
         }
     }
@@ -5783,41 +7411,69 @@ void onFlowStateCreated(FlowState *flowState) {
 					(int)i,
 					(const void *)pValue
 				);
-				writeDebuggerBufferHook(buffer, strlen(buffer));
+				writeDebuggerOutput(buffer, strlen(buffer));
 				writeValue(*pValue);
         }
 	}
 }
-void onFlowStateDestroyed(FlowState *flowState) {
-	if (isSubscribedTo(MESSAGE_TO_DEBUGGER_FLOW_STATE_DESTROYED)) {
-		char buffer[256];
-		snprintf(buffer, sizeof(buffer), "%d\t%d\n",
-			MESSAGE_TO_DEBUGGER_FLOW_STATE_DESTROYED,
-			(int)flowState->flowStateIndex
-		);
-		writeDebuggerBufferHook(buffer, strlen(buffer));
+static void announceFlowState(FlowState *flowState) {
+    if (flowState->parentFlowState && !flowState->parentFlowState->debuggerAnnounced) {
+        announceFlowState(flowState->parentFlowState);
+    }
+    writeFlowStateCreated(flowState);
+}
+void onFlowStateCreated(FlowState *flowState) {
+    if (!g_runtimeContext->debuggerIsConnected) {
+        return;
+    }
+    if (g_runtimeContext->numPendingFlowStateDestroyedRecords > 0) {
+        drainLog();
+    }
+    if (g_runtimeContext->numDebuggerFlowFilters > 0 && !isFlowSubscribed(flowState, -1)) {
+        return;
+    }
+    announceFlowState(flowState);
+}
+static void writeFlowStateDestroyed(uint32_t flowStateIndex) {
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%d\t%d\n",
+        MESSAGE_TO_DEBUGGER_FLOW_STATE_DESTROYED,
+        (int)flowStateIndex
+    );
+    writeDebuggerOutput(buffer, strlen(buffer));
+}
+static bool queueFlowStateDestroyedRecord(FlowState *flowState);
+void onFlowStateDestroyed(FlowState *flowState) {
+	if (isSubscribedTo(MESSAGE_TO_DEBUGGER_FLOW_STATE_DESTROYED, flowState, -1)) {
+        if (g_runtimeContext->logBufferHead != g_runtimeContext->logBufferTail) {
+            if (queueFlowStateDestroyedRecord(flowState)) {
+                return;
+            }
+            drainLog();
+        }
+        writeFlowStateDestroyed(flowState->flowStateIndex);
 	}
 }
 void onFlowStateTimelineChanged(FlowState *flowState) {
-	if (isSubscribedTo(MESSAGE_TO_DEBUGGER_FLOW_STATE_TIMELINE_CHANGED)) {
+	if (isSubscribedTo(MESSAGE_TO_DEBUGGER_FLOW_STATE_TIMELINE_CHANGED, flowState, -1)) {
 		char buffer[256];
 		snprintf(buffer, sizeof(buffer), "%d\t%d\t%g\n",
 			MESSAGE_TO_DEBUGGER_FLOW_STATE_TIMELINE_CHANGED,
 			(int)flowState->flowStateIndex,
             flowState->timelinePosition
 		);
-		writeDebuggerBufferHook(buffer, strlen(buffer));
+		writeDebuggerOutput(buffer, strlen(buffer));
 	}
 }
 void onFlowError(FlowState *flowState, int componentIndex, const char *errorMessage) {
-	if (isSubscribedTo(MESSAGE_TO_DEBUGGER_FLOW_STATE_ERROR)) {
+	if (isSubscribedTo(MESSAGE_TO_DEBUGGER_FLOW_STATE_ERROR, flowState, -1)) {
 		char buffer[256];
 		snprintf(buffer, sizeof(buffer), "%d\t%d\t%d\t",
 			MESSAGE_TO_DEBUGGER_FLOW_STATE_ERROR,
 			(int)flowState->flowStateIndex,
 			componentIndex
 		);
-		writeDebuggerBufferHook(buffer, strlen(buffer));
+		writeDebuggerOutput(buffer, strlen(buffer));
 		writeString(errorMessage);
 	}
     if (onFlowErrorHook) {
@@ -5825,7 +7481,7 @@ void onFlowError(FlowState *flowState, int componentIndex, const char *errorMess
     }
 }
 void onComponentExecutionStateChanged(FlowState *flowState, int componentIndex) {
-	if (isSubscribedTo(MESSAGE_TO_DEBUGGER_COMPONENT_EXECUTION_STATE_CHANGED)) {
+	if (isSubscribedTo(MESSAGE_TO_DEBUGGER_COMPONENT_EXECUTION_STATE_CHANGED, flowState, componentIndex)) {
 		char buffer[256];
 		snprintf(buffer, sizeof(buffer), "%d\t%d\t%d\t%p\n",
 			MESSAGE_TO_DEBUGGER_COMPONENT_EXECUTION_STATE_CHANGED,
@@ -5833,11 +7489,11 @@ void onComponentExecutionStateChanged(FlowState *flowState, int componentIndex)
 			componentIndex,
             (void *)flowState->componenentExecutionStates[componentIndex]
 		);
-        writeDebuggerBufferHook(buffer, strlen(buffer));
+        writeDebuggerOutput(buffer, strlen(buffer));
 	}
 }
 void onComponentAsyncStateChanged(FlowState *flowState, int componentIndex) {
-	if (isSubscribedTo(MESSAGE_TO_DEBUGGER_COMPONENT_ASYNC_STATE_CHANGED)) {
+	if (isSubscribedTo(MESSAGE_TO_DEBUGGER_COMPONENT_ASYNC_STATE_CHANGED, flowState, componentIndex)) {
 		char buffer[256];
 		snprintf(buffer, sizeof(buffer), "%d\t%d\t%d\t%d\n",
 			MESSAGE_TO_DEBUGGER_COMPONENT_ASYNC_STATE_CHANGED,
@@ -5845,91 +7501,178 @@ void onComponentAsyncStateChanged(FlowState *flowState, int componentIndex) {
 			componentIndex,
             flowState->componenentAsyncStates[componentIndex] ? 1 : 0
 		);
-        writeDebuggerBufferHook(buffer, strlen(buffer));
+        writeDebuggerOutput(buffer, strlen(buffer));
 	}
 }
-static void writeLogMessage(const char *str) {
-	for (const char *p = str; *p; p++) {
-		if (*p == '\t') {
-			WRITE_TO_OUTPUT_BUFFER('\\');
-			WRITE_TO_OUTPUT_BUFFER('t');
-		} if (*p == '\n') {
-			WRITE_TO_OUTPUT_BUFFER('\\');
-			WRITE_TO_OUTPUT_BUFFER('n');
-		} else {
-			WRITE_TO_OUTPUT_BUFFER(*p);
-		}
-	}
-	WRITE_TO_OUTPUT_BUFFER('\n');
-	FLUSH_OUTPUT_BUFFER();
+enum LogMessageKind {
+    LOG_MESSAGE_KIND_PLAIN,
+    LOG_MESSAGE_KIND_SCPI_COMMAND,
+    LOG_MESSAGE_KIND_SCPI_QUERY,
+    LOG_MESSAGE_KIND_SCPI_QUERY_RESULT,
+    LOG_MESSAGE_KIND_FLOW_STATE_DESTROYED
+};
+static const char *g_logMessagePrefixes[] = {
+    "",
+    "SCPI COMMAND: ",
+    "SCPI QUERY: ",
+    "SCPI QUERY RESULT: "
+};
+static const uint8_t LOG_RECORD_TO_DEBUGGER = 1;
+static const uint8_t LOG_RECORD_TO_LVGL = 2;
+static const uint8_t LOG_RECORD_TRUNCATED = 4;
+struct LogRecordHeader {
+    uint32_t flowStateIndex;
+    uint16_t componentIndex;
+    uint16_t length;
+    uint8_t type;
+    uint8_t kind;
+    uint8_t flags;
+    uint8_t reserved;
+};
+static const uint32_t LOG_BUFFER_MASK = EEZ_FLOW_LOG_BUFFER_SIZE - 1;
+static void writeToLogBuffer(uint32_t position, const void *data, uint32_t length) {
+    uint32_t start = position & LOG_BUFFER_MASK;
+    uint32_t n = length < EEZ_FLOW_LOG_BUFFER_SIZE - start ? length : EEZ_FLOW_LOG_BUFFER_SIZE - start;
+    memcpy(g_runtimeContext->logBuffer + start, data, n);
+    memcpy(g_runtimeContext->logBuffer, (const uint8_t *)data + n, length - n);
+}
+static void readFromLogBuffer(uint32_t position, void *data, uint32_t length) {
+    uint32_t start = position & LOG_BUFFER_MASK;
+    uint32_t n = length < EEZ_FLOW_LOG_BUFFER_SIZE - start ? length : EEZ_FLOW_LOG_BUFFER_SIZE - start;
+    memcpy(data, g_runtimeContext->logBuffer + start, n);
+    memcpy((uint8_t *)data + n, g_runtimeContext->logBuffer, length - n);
+}
+static void writeLogMessage(const char *str, size_t len);
+static void writeLogRecord(const LogRecordHeader &header, const char *message1, uint32_t length1, const char *message2, uint32_t length2) {
+    const char *truncationMark = header.flags & LOG_RECORD_TRUNCATED ? "..." : "";
+    if (header.flags & LOG_RECORD_TO_LVGL) {
+        LV_LOG_USER("EEZ-FLOW: %.*s%.*s%s", (int)length1, message1, (int)length2, message2, truncationMark);
+    }
+    if ((header.flags & LOG_RECORD_TO_DEBUGGER) && isSubscribedTo(MESSAGE_TO_DEBUGGER_LOG)) {
+        char buffer[256];
+        snprintf(buffer, sizeof(buffer), "%d\t%d\t%d\t%d\t%s",
+            MESSAGE_TO_DEBUGGER_LOG,
+            header.type,
+            (int)header.flowStateIndex,
+            header.componentIndex == 0xFFFF ? -1 : (int)header.componentIndex,
+            g_logMessagePrefixes[header.kind]
+        );
+        writeDebuggerOutput(buffer, strlen(buffer));
+        writeLogMessage(message1, length1);
+        writeLogMessage(message2, length2);
+        writeDebuggerOutput(truncationMark, strlen(truncationMark));
+        writeDebuggerOutput('\n');
+    }
+}
+static void addLogMessage(uint8_t type, LogMessageKind kind, FlowState *flowState, unsigned componentIndex, const char *message, size_t length, bool toLvgl) {
+    if (type > g_runtimeContext->logLevel) {
+        return;
+    }
+    bool toDebugger =
+        g_runtimeContext->debuggerIsConnected &&
+        (g_runtimeContext->messageSubsciptionFilter & (1 << MESSAGE_TO_DEBUGGER_LOG)) != 0 &&
+        (g_runtimeContext->numDebuggerFlowFilters == 0 || isFlowSubscribed(flowState, componentIndex));
+    if (!toDebugger && !toLvgl) {
+        return;
+    }
+    uint8_t flags = (toDebugger ? LOG_RECORD_TO_DEBUGGER : 0) | (toLvgl ? LOG_RECORD_TO_LVGL : 0);
+    if (length > EEZ_FLOW_LOG_MAX_MESSAGE_LENGTH) {
+        length = EEZ_FLOW_LOG_MAX_MESSAGE_LENGTH;
+        flags |= LOG_RECORD_TRUNCATED;
+    }
+    LogRecordHeader header;
+    header.flowStateIndex = flowState->flowStateIndex;
+    header.componentIndex = (uint16_t)componentIndex;
+    header.length = (uint16_t)length;
+    header.type = type;
+    header.kind = kind;
+    header.flags = flags;
+    header.reserved = 0;
+    uint32_t recordLength = sizeof(LogRecordHeader) + length;
+    if (EEZ_FLOW_LOG_BUFFER_SIZE - (g_runtimeContext->logBufferHead - g_runtimeContext->logBufferTail) < recordLength) {
+        drainLog();
+        if (EEZ_FLOW_LOG_BUFFER_SIZE < recordLength) {
+            writeLogRecord(header, message, length, nullptr, 0);
+            return;
+        }
+    }
+    writeToLogBuffer(g_runtimeContext->logBufferHead, &header, sizeof(LogRecordHeader));
+    writeToLogBuffer(g_runtimeContext->logBufferHead + sizeof(LogRecordHeader), message, length);
+    g_runtimeContext->logBufferHead += recordLength;
+}
+static bool queueFlowStateDestroyedRecord(FlowState *flowState) {
+    if (EEZ_FLOW_LOG_BUFFER_SIZE - (g_runtimeContext->logBufferHead - g_runtimeContext->logBufferTail) < sizeof(LogRecordHeader)) {
+        return false;
+    }
+    LogRecordHeader header;
+    header.flowStateIndex = flowState->flowStateIndex;
+    header.componentIndex = 0xFFFF;
+    header.length = 0;
+    header.type = 0;
+    header.kind = LOG_MESSAGE_KIND_FLOW_STATE_DESTROYED;
+    header.flags = LOG_RECORD_TO_DEBUGGER;
+    header.reserved = 0;
+    writeToLogBuffer(g_runtimeContext->logBufferHead, &header, sizeof(LogRecordHeader));
+    g_runtimeContext->logBufferHead += sizeof(LogRecordHeader);
+    g_runtimeContext->numPendingFlowStateDestroyedRecords++;
+    return true;
 }
 static void writeLogMessage(const char *str, size_t len) {
+    size_t run = 0;
 	for (size_t i = 0; i < len; i++) {
-		if (str[i] == '\t') {
-			WRITE_TO_OUTPUT_BUFFER('\\');
-			WRITE_TO_OUTPUT_BUFFER('t');
-		} if (str[i] == '\n') {
-			WRITE_TO_OUTPUT_BUFFER('\\');
-			WRITE_TO_OUTPUT_BUFFER('n');
-		} else {
-			WRITE_TO_OUTPUT_BUFFER(str[i]);
+		if (str[i] == '\t' || str[i] == '\n') {
+            writeDebuggerOutput(str + run, i - run);
+            writeDebuggerOutput(str[i] == '\t' ? "\\t" : "\\n", 2);
+            run = i + 1;
 		}
 	}
-	WRITE_TO_OUTPUT_BUFFER('\n');
-	FLUSH_OUTPUT_BUFFER();
+    writeDebuggerOutput(str + run, len - run);
+}
+void setLogLevel(uint8_t logLevel) {
+    g_runtimeContext->logLevel = logLevel;
+}
+void drainLog() {
+    while (g_runtimeContext->logBufferTail != g_runtimeContext->logBufferHead) {
+        LogRecordHeader header;
+        readFromLogBuffer(g_runtimeContext->logBufferTail, &header, sizeof(LogRecordHeader));
+        uint32_t messagePosition = g_runtimeContext->logBufferTail + sizeof(LogRecordHeader);
+        uint32_t start = messagePosition & LOG_BUFFER_MASK;
+        uint32_t length1 = header.length < EEZ_FLOW_LOG_BUFFER_SIZE - start ? header.length : EEZ_FLOW_LOG_BUFFER_SIZE - start;
+        const char *message1 = g_runtimeContext->logBuffer + start;
+        uint32_t length2 = header.length - length1;
+        const char *message2 = g_runtimeContext->logBuffer;
+        g_runtimeContext->logBufferTail = messagePosition + header.length;
+        if (header.kind == LOG_MESSAGE_KIND_FLOW_STATE_DESTROYED) {
+            g_runtimeContext->numPendingFlowStateDestroyedRecords--;
+            if (isSubscribedTo(MESSAGE_TO_DEBUGGER_FLOW_STATE_DESTROYED)) {
+                writeFlowStateDestroyed(header.flowStateIndex);
+            }
+            continue;
+        }
+        writeLogRecord(header, message1, length1, message2, length2);
+    }
 }
-void logInfo(FlowState *flowState, unsigned componentIndex, const char *message) {
-    LV_LOG_USER("EEZ-FLOW: %s", message);
-	if (isSubscribedTo(MESSAGE_TO_DEBUGGER_LOG)) {
-		char buffer[256];
-		snprintf(buffer, sizeof(buffer), "%d\t%d\t%d\t%d\t",
-			MESSAGE_TO_DEBUGGER_LOG,
-            LOG_ITEM_TYPE_INFO,
-            (int)flowState->flowStateIndex,
-			componentIndex
-		);
-		writeDebuggerBufferHook(buffer, strlen(buffer));
-		writeLogMessage(message);
+void notifyLog() {
+    if (g_runtimeContext->logBufferHead != g_runtimeContext->logBufferTail) {
+        logAvailableHook();
     }
 }
+void logInfo(FlowState *flowState, unsigned componentIndex, const char *message) {
+#if defined(LV_USE_LOG) && LV_USE_LOG
+    bool toLvgl = true;
+#else
+    bool toLvgl = false;
+#endif
+    addLogMessage(LOG_ITEM_TYPE_INFO, LOG_MESSAGE_KIND_PLAIN, flowState, componentIndex, message, strlen(message), toLvgl);
+}
 void logScpiCommand(FlowState *flowState, unsigned componentIndex, const char *cmd) {
-	if (isSubscribedTo(MESSAGE_TO_DEBUGGER_LOG)) {
-		char buffer[256];
-		snprintf(buffer, sizeof(buffer), "%d\t%d\t%d\t%d\tSCPI COMMAND: ",
-			MESSAGE_TO_DEBUGGER_LOG,
-            LOG_ITEM_TYPE_SCPI,
-            (int)flowState->flowStateIndex,
-			componentIndex
-		);
-		writeDebuggerBufferHook(buffer, strlen(buffer));
-		writeLogMessage(cmd);
-    }
+    addLogMessage(LOG_ITEM_TYPE_SCPI, LOG_MESSAGE_KIND_SCPI_COMMAND, flowState, componentIndex, cmd, strlen(cmd), false);
 }
 void logScpiQuery(FlowState *flowState, unsigned componentIndex, const char *query) {
-	if (isSubscribedTo(MESSAGE_TO_DEBUGGER_LOG)) {
-		char buffer[256];
-		snprintf(buffer, sizeof(buffer), "%d\t%d\t%d\t%d\tSCPI QUERY: ",
-			MESSAGE_TO_DEBUGGER_LOG,
-            LOG_ITEM_TYPE_SCPI,
-            (int)flowState->flowStateIndex,
-			componentIndex
-		);
-		writeDebuggerBufferHook(buffer, strlen(buffer));
-		writeLogMessage(query);
-    }
+    addLogMessage(LOG_ITEM_TYPE_SCPI, LOG_MESSAGE_KIND_SCPI_QUERY, flowState, componentIndex, query, strlen(query), false);
 }
 void logScpiQueryResult(FlowState *flowState, unsigned componentIndex, const char *resultText, size_t resultTextLen) {
-	if (isSubscribedTo(MESSAGE_TO_DEBUGGER_LOG)) {
-		char buffer[256];
-		snprintf(buffer, sizeof(buffer) - 1, "%d\t%d\t%d\t%d\tSCPI QUERY RESULT: ",
-			MESSAGE_TO_DEBUGGER_LOG,
-            LOG_ITEM_TYPE_SCPI,
-            (int)flowState->flowStateIndex,
-			componentIndex
-		);
-		writeDebuggerBufferHook(buffer, strlen(buffer));
-		writeLogMessage(resultText, resultTextLen);
-    }
+    addLogMessage(LOG_ITEM_TYPE_SCPI, LOG_MESSAGE_KIND_SCPI_QUERY_RESULT, flowState, componentIndex, resultText, resultTextLen, false);
 }
 void onPageChanged(int previousPageId, int activePageId, bool activePageIsFromStack, bool previousPageIsStillOnStack) {
     if (flow::isFlowStopped()) {
@@ -5940,7 +7683,7 @@ void onPageChanged(int previousPageId, int activePageId, bool activePageIsFromSt
     }
     if (!previousPageIsStillOnStack) {
         if (previousPageId > 0) {
-            auto flowState = getPageFlowState(g_mainAssets, previousPageId - 1);
+            auto flowState = getPageFlowState(flow::g_runtimeContext->loadedAssets, previousPageId - 1);
             if (flowState) {
                 onEvent(flowState, FLOW_EVENT_CLOSE_PAGE, Value());
             }
@@ -5948,7 +7691,7 @@ void onPageChanged(int previousPageId, int activePageId, bool activePageIsFromSt
     }
     if (!activePageIsFromStack) {
         if (activePageId > 0) {
-            auto flowState = getPageFlowState(g_mainAssets, activePageId - 1);
+            auto flowState = getPageFlowState(flow::g_runtimeContext->loadedAssets, activePageId - 1);
             if (flowState) {
                 onEvent(flowState, FLOW_EVENT_OPEN_PAGE, Value());
             }
@@ -5960,7 +7703,7 @@ void onPageChanged(int previousPageId, int activePageId, bool activePageIsFromSt
             MESSAGE_TO_DEBUGGER_PAGE_CHANGED,
             activePageId
         );
-        writeDebuggerBufferHook(buffer, strlen(buffer));
+        writeDebuggerOutput(buffer, strlen(buffer));
     }
 }
 } 
@@ -5971,8 +7714,8 @@ void onPageChanged(int previousPageId, int activePageId, bool activePageIsFromSt
 #include <stdio.h>
 namespace eez {
 namespace flow {
-EvalStack g_stack;
 static void evalExpression(FlowState *flowState, const uint8_t *instructions, int *numInstructionBytes) {
+    auto &stack = g_runtimeContext->stack;
 	auto flowDefinition = static_cast<FlowDefinition*>(flowState->assets->flowDefinition);
 	auto flow = flowState->flow;
 	int i = 0;
@@ -5981,28 +7724,28 @@ static void evalExpression(FlowState *flowState, const uint8_t *instructions, in
 		auto instructionType = instruction & EXPR_EVAL_INSTRUCTION_TYPE_MASK;
 		auto instructionArg = instruction & EXPR_EVAL_INSTRUCTION_PARAM_MASK;
 		if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_CONSTANT) {
-			g_stack.push(*flowDefinition->constants[instructionArg]);
+			stack.push(*flowDefinition->constants[instructionArg]);
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_INPUT) {
-			g_stack.push(flowState->values[instructionArg]);
+			stack.push(flowState->values[instructionArg]);
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_LOCAL_VAR) {
-			g_stack.push(&flowState->values[flow->componentInputs.count + instructionArg]);
+			stack.push(&flowState->values[flow->componentInputs.count + instructionArg]);
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_GLOBAL_VAR) {
 			if ((uint32_t)instructionArg < flowDefinition->globalVariables.count) {
-                if (g_globalVariables && !flowState->assets->external) {
-				    g_stack.push(g_globalVariables->values + instructionArg);
+                if (g_runtimeContext->globalVariables && !flowState->assets->external) {
+				    stack.push(g_runtimeContext->globalVariables->values + instructionArg);
                 } else {
-                    g_stack.push(flowDefinition->globalVariables[instructionArg]);
+                    stack.push(flowDefinition->globalVariables[instructionArg]);
                 }
 			} else {
-				g_stack.push(Value((int)(instructionArg - flowDefinition->globalVariables.count + 1), VALUE_TYPE_NATIVE_VARIABLE));
+				stack.push(Value((int)(instructionArg - flowDefinition->globalVariables.count + 1), VALUE_TYPE_NATIVE_VARIABLE));
 			}
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_OUTPUT) {
-			g_stack.push(Value((uint16_t)instructionArg, VALUE_TYPE_FLOW_OUTPUT));
+			stack.push(Value((uint16_t)instructionArg, VALUE_TYPE_FLOW_OUTPUT));
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_ARRAY_ELEMENT) {
-			auto elementIndexValue = g_stack.pop().getValue();
-			auto arrayValue = g_stack.pop().getValue();
+			auto elementIndexValue = stack.pop().getValue();
+			auto arrayValue = stack.pop().getValue();
             if (arrayValue.getType() == VALUE_TYPE_UNDEFINED || arrayValue.getType() == VALUE_TYPE_NULL) {
-                g_stack.push(Value(0, VALUE_TYPE_UNDEFINED));
+                stack.push(Value(0, VALUE_TYPE_UNDEFINED));
             } else {
                 if (arrayValue.isArray()) {
                     auto array = arrayValue.getArray();
@@ -6010,14 +7753,14 @@ static void evalExpression(FlowState *flowState, const uint8_t *instructions, in
                     auto elementIndex = elementIndexValue.toInt32(&err);
                     if (!err) {
                         if (elementIndex >= 0 && elementIndex < (int)array->arraySize) {
-                            g_stack.push(Value::makeArrayElementRef(arrayValue, elementIndex, 0x132e0e2f));
+                            stack.push(Value::makeArrayElementRef(arrayValue, elementIndex, 0x132e0e2f));
                         } else {
-                            g_stack.push(Value::makeError());
-                            g_stack.setErrorMessage("Array element index out of bounds\n");
+                            stack.push(Value::makeError());
+                            stack.setErrorMessage("Array element index out of bounds\n");
                         }
                     } else {
-                        g_stack.push(Value::makeError());
-                        g_stack.setErrorMessage("Integer value expected for array element index\n");
+                        stack.push(Value::makeError());
+                        stack.setErrorMessage("Integer value expected for array element index\n");
                     }
                 } else if (arrayValue.isBlob()) {
                     auto blobRef = arrayValue.getBlob();
@@ -6025,27 +7768,27 @@ static void evalExpression(FlowState *flowState, const uint8_t *instructions, in
                     auto elementIndex = elementIndexValue.toInt32(&err);
                     if (!err) {
                         if (elementIndex >= 0 && elementIndex < (int)blobRef->len) {
-                            g_stack.push(Value::makeArrayElementRef(arrayValue, elementIndex, 0x132e0e2f));
+                            stack.push(Value::makeArrayElementRef(arrayValue, elementIndex, 0x132e0e2f));
                         } else {
-                            g_stack.push(Value::makeError());
-                            g_stack.setErrorMessage("Blob element index out of bounds\n");
+                            stack.push(Value::makeError());
+                            stack.setErrorMessage("Blob element index out of bounds\n");
                         }
                     } else {
-                        g_stack.push(Value::makeError());
-                        g_stack.setErrorMessage("Integer value expected for blob element index\n");
+                        stack.push(Value::makeError());
+                        stack.setErrorMessage("Integer value expected for blob element index\n");
                     }
                 } else {
-                    g_stack.push(Value::makeError());
-                    g_stack.setErrorMessage("Array value expected\n");
+                    stack.push(Value::makeError());
+                    stack.setErrorMessage("Array value expected\n");
                 }
             }
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_OPERATION) {
-			g_evalOperations[instructionArg](g_stack);
+			g_evalOperations[instructionArg](stack);
 		} else {
             if (instruction == EXPR_EVAL_INSTRUCTION_TYPE_END_WITH_DST_VALUE_TYPE) {
     			i += 2;
-                if (g_stack.sp == 1) {
-                    auto finalResult = g_stack.pop();
+                if (stack.sp == 1) {
+                    auto finalResult = stack.pop();
                     #define VALUE_TYPE (instructions[i] + (instructions[i + 1] << 8) + (instructions[i + 2] << 16) + (instructions[i + 3] << 24))
                     if (finalResult.getType() == VALUE_TYPE_VALUE_PTR) {
                         finalResult.dstValueType = VALUE_TYPE;
@@ -6053,7 +7796,7 @@ static void evalExpression(FlowState *flowState, const uint8_t *instructions, in
                         auto arrayElementValue = (ArrayElementValue *)finalResult.refValue;
                         arrayElementValue->dstValueType = VALUE_TYPE;
                     }
-                    g_stack.push(finalResult);
+                    stack.push(finalResult);
                 }
                 i += 4;
                 break;
@@ -6069,46 +7812,48 @@ static void evalExpression(FlowState *flowState, const uint8_t *instructions, in
 	}
 }
 bool evalExpression(FlowState *flowState, int componentIndex, const uint8_t *instructions, Value &result, const FlowError &errorMessage, int *numInstructionBytes, const int32_t *iterators) {
-    size_t savedSp = g_stack.sp;
-    FlowState *savedFlowState = g_stack.flowState;
-	int savedComponentIndex = g_stack.componentIndex;
-	const int32_t *savedIterators = g_stack.iterators;
-    const char *savedErrorMessage = g_stack.errorMessage;
-	g_stack.flowState = flowState;
-	g_stack.componentIndex = componentIndex;
-	g_stack.iterators = iterators;
-    g_stack.errorMessage = nullptr;
+    auto &stack = g_runtimeContext->stack;
+    size_t savedSp = stack.sp;
+    FlowState *savedFlowState = stack.flowState;
+	int savedComponentIndex = stack.componentIndex;
+	const int32_t *savedIterators = stack.iterators;
+    const char *savedErrorMessage = stack.errorMessage;
+	stack.flowState = flowState;
+	stack.componentIndex = componentIndex;
+	stack.iterators = iterators;
+    stack.errorMessage = nullptr;
 	evalExpression(flowState, instructions, numInstructionBytes);
-	g_stack.flowState = savedFlowState;
-	g_stack.componentIndex = savedComponentIndex;
-	g_stack.iterators = savedIterators;
-    g_stack.errorMessage = savedErrorMessage;
-    if (g_stack.sp == savedSp + 1) {
-        result = g_stack.pop().getValue();
+	stack.flowState = savedFlowState;
+	stack.componentIndex = savedComponentIndex;
+	stack.iterators = savedIterators;
+    stack.errorMessage = savedErrorMessage;
+    if (stack.sp == savedSp + 1) {
+        result = stack.pop().getValue();
         if (!result.isError()) {
             return true;
         }
     }
-    FlowError flowError = errorMessage.setDescription(g_stack.errorMessage);
+    FlowError flowError = errorMessage.setDescription(stack.errorMessage);
     throwError(flowState, componentIndex, flowError);
 	return false;
 }
 bool evalAssignableExpression(FlowState *flowState, int componentIndex, const uint8_t *instructions, Value &result, const FlowError &errorMessage, int *numInstructionBytes, const int32_t *iterators) {
-    FlowState *savedFlowState = g_stack.flowState;
-	int savedComponentIndex = g_stack.componentIndex;
-	const int32_t *savedIterators = g_stack.iterators;
-    const char *savedErrorMessage = g_stack.errorMessage;
-	g_stack.flowState = flowState;
-	g_stack.componentIndex = componentIndex;
-	g_stack.iterators = iterators;
-    g_stack.errorMessage = nullptr;
+    auto &stack = g_runtimeContext->stack;
+    FlowState *savedFlowState = stack.flowState;
+	int savedComponentIndex = stack.componentIndex;
+	const int32_t *savedIterators = stack.iterators;
+    const char *savedErrorMessage = stack.errorMessage;
+	stack.flowState = flowState;
+	stack.componentIndex = componentIndex;
+	stack.iterators = iterators;
+    stack.errorMessage = nullptr;
 	evalExpression(flowState, instructions, numInstructionBytes);
-	g_stack.flowState = savedFlowState;
-	g_stack.componentIndex = savedComponentIndex;
-	g_stack.iterators = savedIterators;
-    g_stack.errorMessage = savedErrorMessage;
-    if (g_stack.sp == 1) {
-        auto finalResult = g_stack.pop();
+	stack.flowState = savedFlowState;
+	stack.componentIndex = savedComponentIndex;
+	stack.iterators = savedIterators;
+    stack.errorMessage = savedErrorMessage;
+    if (stack.sp == 1) {
+        auto finalResult = stack.pop();
         if (
             finalResult.getType() == VALUE_TYPE_VALUE_PTR ||
             finalResult.getType() == VALUE_TYPE_NATIVE_VARIABLE ||
@@ -6120,7 +7865,7 @@ bool evalAssignableExpression(FlowState *flowState, int componentIndex, const ui
             return true;
         }
     }
-    errorMessage.setDescription(g_stack.errorMessage);
+    errorMessage.setDescription(stack.errorMessage);
     throwError(flowState, componentIndex, errorMessage);
 	return false;
 }
@@ -6175,24 +7920,130 @@ uint32_t g_wasmModuleId = 0;
 #define EEZ_FLOW_TICK_MAX_DURATION_MS 5
 #endif
 static const uint32_t FLOW_TICK_MAX_DURATION_MS = EEZ_FLOW_TICK_MAX_DURATION_MS;
-static unsigned g_tick_max_duration_count = 0;
-int g_selectedLanguage = 0;
-FlowState *g_firstFlowState;
-FlowState *g_lastFlowState;
-static bool g_isStopping = false;
-static bool g_isStopped = true;
 static void doStop();
+static void freePreviousAssets();
+static void trySwapAssets();
+#if EEZ_FLOW_VERIFY_ASSETS
+static bool verifyExpression(FlowDefinition *flowDefinition, Flow *flow, Component *component, const uint8_t *instructions) {
+	for (int i = 0; ; i += 2) {
+		uint16_t instruction = instructions[i] + (instructions[i + 1] << 8);
+		auto instructionType = instruction & EXPR_EVAL_INSTRUCTION_TYPE_MASK;
+		uint32_t instructionArg = instruction & EXPR_EVAL_INSTRUCTION_PARAM_MASK;
+		if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_CONSTANT) {
+			if (instructionArg >= flowDefinition->constants.count) {
+				return false;
+			}
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_INPUT) {
+			if (instructionArg >= flow->componentInputs.count) {
+				return false;
+			}
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_LOCAL_VAR) {
+			if (instructionArg >= flow->localVariables.count) {
+				return false;
+			}
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_OUTPUT) {
+			if (instructionArg >= component->outputs.count) {
+				return false;
+			}
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_OPERATION) {
+			if (instructionArg >= g_numEvalOperations) {
+				return false;
+			}
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_END) {
+			return true;
+		}
+	}
+}
+static bool verifyFlow(FlowDefinition *flowDefinition, Flow *flow, char *errorMessage, size_t errorMessageSize, int flowIndex) {
+	for (uint32_t componentIndex = 0; componentIndex < flow->components.count; componentIndex++) {
+		auto component = flow->components[componentIndex];
+		if (!isValidComponentType(component->type)) {
+			snprintf(errorMessage, errorMessageSize, "Invalid component type %d at index %d in flow at index %d\n", component->type, (int)componentIndex, flowIndex);
+			return false;
+		}
+		for (uint32_t inputIndex = 0; inputIndex < component->inputs.count; inputIndex++) {
+			if (component->inputs[inputIndex] >= flow->componentInputs.count) {
+				snprintf(errorMessage, errorMessageSize, "Invalid input in component at index %d in flow at index %d\n", (int)componentIndex, flowIndex);
+				return false;
+			}
+		}
+		for (uint32_t outputIndex = 0; outputIndex < component->outputs.count; outputIndex++) {
+			auto componentOutput = component->outputs[outputIndex];
+			for (uint32_t connectionIndex = 0; connectionIndex < componentOutput->connections.count; connectionIndex++) {
+				auto connection = componentOutput->connections[connectionIndex];
+				if (connection->targetComponentIndex >= flow->components.count || connection->targetInputIndex >= flow->componentInputs.count) {
+					snprintf(errorMessage, errorMessageSize, "Invalid connection from component at index %d in flow at index %d\n", (int)componentIndex, flowIndex);
+					return false;
+				}
+			}
+		}
+		if (component->errorCatchOutput < -1 || component->errorCatchOutput >= (int)component->outputs.count) {
+			snprintf(errorMessage, errorMessageSize, "Invalid error output in component at index %d in flow at index %d\n", (int)componentIndex, flowIndex);
+			return false;
+		}
+		for (uint32_t propertyIndex = 0; propertyIndex < component->properties.count; propertyIndex++) {
+			if (!verifyExpression(flowDefinition, flow, component, component->properties[propertyIndex]->evalInstructions)) {
+				snprintf(errorMessage, errorMessageSize, "Invalid expression in property %d of component at index %d in flow at index %d\n", (int)propertyIndex, (int)componentIndex, flowIndex);
+				return false;
+			}
+		}
+	}
+	for (uint32_t i = 0; i < flow->widgetDataItems.count; i++) {
+		auto widgetDataItem = flow->widgetDataItems[i];
+		if (widgetDataItem->componentIndex != -1 && (widgetDataItem->componentIndex < 0 || widgetDataItem->componentIndex >= (int)flow->components.count || widgetDataItem->propertyValueIndex < 0 || widgetDataItem->propertyValueIndex >= (int)flow->components[widgetDataItem->componentIndex]->properties.count)) {
+			snprintf(errorMessage, errorMessageSize, "Invalid widget data item %d in flow at index %d\n", (int)i, flowIndex);
+			return false;
+		}
+	}
+	for (uint32_t i = 0; i < flow->widgetActions.count; i++) {
+		auto widgetActionItem = flow->widgetActions[i];
+		if (widgetActionItem->componentIndex != -1 && (widgetActionItem->componentIndex < 0 || widgetActionItem->componentIndex >= (int)flow->components.count || widgetActionItem->componentOutputIndex < 0 || widgetActionItem->componentOutputIndex >= (int)flow->components[widgetActionItem->componentIndex]->outputs.count)) {
+			snprintf(errorMessage, errorMessageSize, "Invalid widget action %d in flow at index %d\n", (int)i, flowIndex);
+			return false;
+		}
+	}
+	return true;
+}
+static bool verifyAssets(Assets *assets, char *errorMessage, size_t errorMessageSize) {
+	auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
+	if (flowDefinition->constants.count <= NULL_VALUE_INDEX) {
+		snprintf(errorMessage, errorMessageSize, "Invalid constants\n");
+		return false;
+	}
+	for (uint32_t flowIndex = 0; flowIndex < flowDefinition->flows.count; flowIndex++) {
+		if (!verifyFlow(flowDefinition, flowDefinition->flows[flowIndex], errorMessage, errorMessageSize, (int)flowIndex)) {
+			return false;
+		}
+	}
+	return true;
+}
+#endif
 unsigned start(Assets *assets) {
 	auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
 	if (flowDefinition->flows.count == 0) {
 		return 0;
 	}
-    g_isStopped = false;
-    g_isStopping = false;
+#if EEZ_FLOW_VERIFY_ASSETS
+    char errorMessage[128];
+    if (!verifyAssets(assets, errorMessage, sizeof(errorMessage))) {
+        ErrorTrace("%s", errorMessage);
+        return 0;
+    }
+#endif
+    g_runtimeContext->isStopped = false;
+    g_runtimeContext->isStopping = false;
     initGlobalVariables(assets);
     if (!assets->external) {
+        g_runtimeContext->mainAssets = assets;
+#if EEZ_FLOW_SNAPSHOT
+        g_runtimeContext->mainAssetsCrc32 = assets == g_runtimeContext->loadedAssets ? g_runtimeContext->loadedAssetsCrc32 : 0;
+#endif
 	    queueReset();
         watchListReset();
+#if EEZ_FLOW_INLINE_ACTIONS
+        classifyInlinableActionFlows(assets);
+#endif
+        initBreakpoints(assets);
     }
     scpiComponentInitHook();
 	onStarted(assets);
@@ -6202,14 +8053,39 @@ void tick() {
 	if (isFlowStopped()) {
 		return;
 	}
-    if (g_isStopping) {
+    if (g_runtimeContext->isStopping) {
         doStop();
         return;
+    }
+    if (g_runtimeContext->previousAssets) {
+        freePreviousAssets();
+    }
+    if (g_runtimeContext->pendingAssets) {
+        trySwapAssets();
+        if (isFlowStopped() || g_runtimeContext->isStopping) {
+            return;
+        }
     }
 	uint32_t startTickCount = millis();
+    EEZ_FLOW_TRACE_EVENT(TRACE_EVENT_TICK_START, nullptr, -1, 0);
+    flushNativeVarWrites();
+    beginNativeVarsTick();
+#if EEZ_OPTION_THREADS
+    drainInboundQueue();
+    if (isFlowStopped() || g_runtimeContext->isStopping) {
+        return;
+    }
+#endif
+    if (g_runtimeContext->numCoalescedEvents > 0) {
+        flushCoalescedEvents();
+        if (isFlowStopped() || g_runtimeContext->isStopping) {
+            return;
+        }
+    }
     visitWatchList();
     auto queueSizeAtTickStart = getQueueSize();
-    for (size_t i = 0; i < queueSizeAtTickStart || g_numNonContinuousTaskInQueue > 0; i++) {
+    size_t i = 0;
+    for (; i < queueSizeAtTickStart || g_runtimeContext->numNonContinuousTaskInQueue > 0; i++) {
 		FlowState *flowState;
 		unsigned componentIndex;
         bool continuousTask;
@@ -6238,7 +8114,7 @@ void tick() {
                 executeComponent(flowState, componentIndex);
             }
         }
-        if (isFlowStopped() || g_isStopping) {
+        if (isFlowStopped() || g_runtimeContext->isStopping) {
             break;
         }
         resetSequenceInputs(flowState);
@@ -6247,50 +8123,320 @@ void tick() {
         }
         if ((i + 1) % 5 == 0) {
             if (millis() - startTickCount >= FLOW_TICK_MAX_DURATION_MS) {
-                g_tick_max_duration_count++;
+                g_runtimeContext->tickMaxDurationCount++;
                 break;
             }
         }
 	}
+    EEZ_FLOW_TRACE_EVENT(TRACE_EVENT_TICK_END, nullptr, -1, i);
+    notifyLog();
+    flushDebuggerSamples();
+    notifyDebuggerOutput();
 	finishToDebuggerMessageHook();
-    for (FlowState *flowState = g_firstFlowState; flowState; ) {
-        FlowState* nextFlowState = flowState->nextSibling;
-        if (flowState->deleteOnNextTick) {
-            freeFlowState(flowState);
-        }
-        flowState = nextFlowState;
+    if (g_runtimeContext->firstFlowStateScheduledForDeletion) {
+        freeFlowStatesScheduledForDeletion();
     }
+    flushNativeVarWrites();
+}
+static Assets *getMainAssets() {
+    return g_runtimeContext->mainAssets ? g_runtimeContext->mainAssets : g_runtimeContext->loadedAssets;
 }
 void stop(Assets* assets) {
     if (!assets) {
-        assets = g_mainAssets;
+        assets = getMainAssets();
     }
     if (assets->external) {
-        for (FlowState *flowState = g_firstFlowState; flowState; flowState = flowState->nextSibling) {
+        for (FlowState *flowState = g_runtimeContext->firstFlowState; flowState; flowState = flowState->nextSibling) {
             if (flowState->assets == assets) {
-                flowState->deleteOnNextTick = true;
+                scheduleFlowStateDeletion(flowState);
             }
         }
     } else {
-        g_isStopping = true;
+        g_runtimeContext->isStopping = true;
+    }
+}
+static bool isFlowCompatible(Flow *oldFlow, Flow *newFlow) {
+    if (
+        oldFlow->components.count != newFlow->components.count ||
+        oldFlow->componentInputs.count != newFlow->componentInputs.count ||
+        oldFlow->localVariables.count != newFlow->localVariables.count
+    ) {
+        return false;
+    }
+    for (uint32_t componentIndex = 0; componentIndex < oldFlow->components.count; componentIndex++) {
+        if (oldFlow->components[componentIndex]->type != newFlow->components[componentIndex]->type) {
+            return false;
+        }
+    }
+    return true;
+}
+static bool areFlowStatesCompatible(FlowState *firstFlowState, Assets *oldAssets, Assets *newAssets) {
+	auto newFlowDefinition = static_cast<FlowDefinition *>(newAssets->flowDefinition);
+    for (auto flowState = firstFlowState; flowState; flowState = flowState->nextSibling) {
+        if (flowState->assets == oldAssets && !flowState->deleteOnNextTick) {
+            if (
+                flowState->flowIndex >= (int)newFlowDefinition->flows.count ||
+                !isFlowCompatible(flowState->flow, newFlowDefinition->flows[flowState->flowIndex])
+            ) {
+                return false;
+            }
+        }
+        if (!areFlowStatesCompatible(flowState->firstChild, oldAssets, newAssets)) {
+            return false;
+        }
+    }
+    return true;
+}
+static bool areFlowStatesBusy(FlowState *firstFlowState) {
+    for (auto flowState = firstFlowState; flowState; flowState = flowState->nextSibling) {
+        if (flowState->deleteOnNextTick) {
+            continue;
+        }
+        if (flowState->isAction) {
+            return true;
+        }
+        for (uint32_t componentIndex = 0; componentIndex < flowState->flow->components.count; componentIndex++) {
+            if (flowState->componenentAsyncStates[componentIndex]) {
+                return true;
+            }
+            auto executionState = flowState->componenentExecutionStates[componentIndex];
+            if (executionState && !executionState->canMigrate()) {
+                return true;
+            }
+        }
+        if (areFlowStatesBusy(flowState->firstChild)) {
+            return true;
+        }
+    }
+    return false;
+}
+bool hotSwapAssets(const uint8_t *assetsData, uint32_t assetsDataSize) {
+    if (isFlowStopped() || g_runtimeContext->pendingAssets) {
+        return false;
+    }
+    if (areFlowStatesBusy(g_runtimeContext->firstFlowState)) {
+        return false;
     }
+    uint8_t *assetsMemory;
+    auto assets = loadAssets(assetsData, assetsDataSize, assetsMemory);
+    if (!assets) {
+        return false;
+    }
+	auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
+    if (!flowDefinition || flowDefinition->flows.count == 0) {
+        unloadAssets(assetsMemory);
+        return false;
+    }
+#if EEZ_FLOW_VERIFY_ASSETS
+    char errorMessage[128];
+    if (!verifyAssets(assets, errorMessage, sizeof(errorMessage))) {
+        ErrorTrace("%s", errorMessage);
+        unloadAssets(assetsMemory);
+        return false;
+    }
+#endif
+    if (!areFlowStatesCompatible(g_runtimeContext->firstFlowState, g_runtimeContext->mainAssets, assets)) {
+        unloadAssets(assetsMemory);
+        return false;
+    }
+    g_runtimeContext->pendingAssets = assets;
+    g_runtimeContext->pendingAssetsMemory = assetsMemory;
+#if EEZ_FLOW_SNAPSHOT
+    g_runtimeContext->pendingAssetsCrc32 = crc32(assetsData, assetsDataSize);
+#endif
+    return true;
+}
+static bool isAssetsUsed(FlowState *firstFlowState, Assets *assets) {
+    for (auto flowState = firstFlowState; flowState; flowState = flowState->nextSibling) {
+        if (flowState->assets == assets || isAssetsUsed(flowState->firstChild, assets)) {
+            return true;
+        }
+    }
+    return false;
+}
+static void freePreviousAssets() {
+    if (isAssetsUsed(g_runtimeContext->firstFlowState, g_runtimeContext->previousAssets)) {
+        return;
+    }
+    unloadAssets(g_runtimeContext->previousAssetsMemory);
+    g_runtimeContext->previousAssets = nullptr;
+    g_runtimeContext->previousAssetsMemory = nullptr;
+}
+static bool isGlobalVariableCompatible(const Value &oldValue, const Value &newValue) {
+    if (oldValue.isString() || newValue.isString()) {
+        return oldValue.isString() && newValue.isString();
+    }
+    if (oldValue.isArray() || newValue.isArray()) {
+        return oldValue.isArray() && newValue.isArray();
+    }
+    return oldValue.type == newValue.type;
+}
+static int findGlobalVariable(FlowDefinition *oldFlowDefinition, FlowDefinition *newFlowDefinition, uint32_t newGlobalVariableIndex) {
+    if (
+        oldFlowDefinition->globalVariableIds.count != oldFlowDefinition->globalVariables.count ||
+        newFlowDefinition->globalVariableIds.count != newFlowDefinition->globalVariables.count
+    ) {
+        return newGlobalVariableIndex < oldFlowDefinition->globalVariables.count ? (int)newGlobalVariableIndex : -1;
+    }
+    auto id = newFlowDefinition->globalVariableIds[newGlobalVariableIndex];
+    for (uint32_t i = 0; i < oldFlowDefinition->globalVariableIds.count; i++) {
+        if (oldFlowDefinition->globalVariableIds[i] == id) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+static void migrateFlowStates(FlowState *firstFlowState, Assets *oldAssets, Assets *newAssets) {
+	auto newFlowDefinition = static_cast<FlowDefinition *>(newAssets->flowDefinition);
+    for (auto flowState = firstFlowState; flowState; flowState = flowState->nextSibling) {
+        if (flowState->assets == oldAssets && !flowState->deleteOnNextTick) {
+            onFlowStateDestroyed(flowState);
+            for (uint32_t componentIndex = 0; componentIndex < flowState->flow->components.count; componentIndex++) {
+                if (flowState->componenentExecutionStates[componentIndex]) {
+                    flowState->componenentExecutionStates[componentIndex]->migrate();
+                }
+            }
+            auto flow = newFlowDefinition->flows[flowState->flowIndex];
+            flowState->assets = newAssets;
+            flowState->flow = flow;
+            if (flowState->parentFlowState && flowState->parentComponentIndex != -1) {
+                flowState->parentComponent = flowState->parentFlowState->flow->components[flowState->parentComponentIndex];
+            }
+            auto nValues = flow->componentInputs.count + flow->localVariables.count;
+            for (uint32_t i = 0; i < nValues; i++) {
+                flowState->values[i] = flowState->values[i].clone();
+            }
+            flowState->debuggerAnnounced = false;
+            onFlowStateCreated(flowState);
+        }
+        migrateFlowStates(flowState->firstChild, oldAssets, newAssets);
+    }
+}
+static void updateFlowStatesBreakpoints(FlowState *firstFlowState) {
+    for (auto flowState = firstFlowState; flowState; flowState = flowState->nextSibling) {
+        flowState->breakpoints = getFlowBreakpoints(flowState->assets, flowState->flowIndex);
+        updateFlowStatesBreakpoints(flowState->firstChild);
+    }
+}
+static void swapAssets() {
+    auto oldAssets = g_runtimeContext->mainAssets;
+    auto newAssets = g_runtimeContext->pendingAssets;
+	auto oldFlowDefinition = static_cast<FlowDefinition *>(oldAssets->flowDefinition);
+	auto newFlowDefinition = static_cast<FlowDefinition *>(newAssets->flowDefinition);
+    uint32_t numGlobalVariables = oldFlowDefinition->globalVariables.count;
+    Value *globalValues = nullptr;
+    if (numGlobalVariables > 0) {
+        globalValues = (Value *)alloc(numGlobalVariables * sizeof(Value), 0x4b7d02e9);
+        if (globalValues) {
+            for (uint32_t i = 0; i < numGlobalVariables; i++) {
+                new (globalValues + i) Value(getGlobalVariable(oldAssets, i).clone());
+            }
+        } else {
+            numGlobalVariables = 0;
+        }
+    }
+    migrateFlowStates(g_runtimeContext->firstFlowState, oldAssets, newAssets);
+    if (g_runtimeContext->globalVariables) {
+        for (uint32_t i = 0; i < g_runtimeContext->globalVariables->count; i++) {
+            (g_runtimeContext->globalVariables->values + i)->~Value();
+        }
+        free(g_runtimeContext->globalVariables);
+        g_runtimeContext->globalVariables = nullptr;
+    }
+    g_runtimeContext->previousAssets = oldAssets;
+    g_runtimeContext->previousAssetsMemory = g_runtimeContext->mainAssetsMemory;
+    if (g_runtimeContext->loadedAssets == oldAssets) {
+        g_runtimeContext->previousAssetsMemory = releaseMainAssetsMemory();
+        g_runtimeContext->loadedAssets = newAssets;
+        // globals of the swapped in assets are kept in g_runtimeContext->globalVariables, not inside the image
+        g_runtimeContext->loadedAssetsAreMutable = false;
+#if EEZ_FLOW_SNAPSHOT
+        g_runtimeContext->loadedAssetsCrc32 = g_runtimeContext->pendingAssetsCrc32;
+#endif
+    }
+    g_runtimeContext->mainAssets = newAssets;
+    g_runtimeContext->mainAssetsMemory = g_runtimeContext->pendingAssetsMemory;
+#if EEZ_FLOW_SNAPSHOT
+    g_runtimeContext->mainAssetsCrc32 = g_runtimeContext->pendingAssetsCrc32;
+#endif
+    g_runtimeContext->pendingAssets = nullptr;
+    g_runtimeContext->pendingAssetsMemory = nullptr;
+    resetTranslations();
+    initGlobalVariables(newAssets);
+    for (uint32_t i = 0; i < newFlowDefinition->globalVariables.count; i++) {
+        auto oldIndex = findGlobalVariable(oldFlowDefinition, newFlowDefinition, i);
+        if (oldIndex != -1 && (uint32_t)oldIndex < numGlobalVariables && isGlobalVariableCompatible(globalValues[oldIndex], getGlobalVariable(newAssets, i))) {
+            setGlobalVariable(newAssets, i, globalValues[oldIndex]);
+        }
+    }
+    for (uint32_t i = 0; i < numGlobalVariables; i++) {
+        (globalValues + i)->~Value();
+    }
+    if (globalValues) {
+        free(globalValues);
+    }
+#if EEZ_FLOW_INLINE_ACTIONS
+    freeInlinableActionFlows();
+    classifyInlinableActionFlows(newAssets);
+#endif
+    initBreakpoints(newAssets);
+    updateFlowStatesBreakpoints(g_runtimeContext->firstFlowState);
+    onStarted(newAssets);
+}
+static void trySwapAssets() {
+#if EEZ_OPTION_THREADS
+    drainInboundQueue();
+    if (isFlowStopped() || g_runtimeContext->isStopping) {
+        return;
+    }
+#endif
+    if (!areFlowStatesCompatible(g_runtimeContext->firstFlowState, g_runtimeContext->mainAssets, g_runtimeContext->pendingAssets)) {
+        ErrorTrace("Hot swapped assets are not compatible with the running flows\n");
+        unloadAssets(g_runtimeContext->pendingAssetsMemory);
+        g_runtimeContext->pendingAssets = nullptr;
+        g_runtimeContext->pendingAssetsMemory = nullptr;
+        return;
+    }
+    if (areFlowStatesBusy(g_runtimeContext->firstFlowState)) {
+        return;
+    }
+    swapAssets();
 }
 void doStop() {
     onStopped();
+    drainLog();
+    notifyDebuggerOutput();
     finishToDebuggerMessageHook();
-    g_debuggerIsConnected = false;
-    freeAllChildrenFlowStates(g_firstFlowState);
-    g_firstFlowState = nullptr;
-    g_lastFlowState = nullptr;
-    g_isStopped = true;
+    g_runtimeContext->debuggerIsConnected = false;
+    freeAllChildrenFlowStates(g_runtimeContext->firstFlowState);
+    g_runtimeContext->firstFlowState = nullptr;
+    g_runtimeContext->lastFlowState = nullptr;
+    g_runtimeContext->firstFlowStateScheduledForDeletion = nullptr;
+    g_runtimeContext->isStopped = true;
 	queueReset();
     watchListReset();
+    resetCoalescedEvents();
+    flushNativeVarWrites();
+#if EEZ_OPTION_THREADS
+    inboundQueueReset();
+#endif
+#if EEZ_FLOW_INLINE_ACTIONS
+    freeInlinableActionFlows();
+#endif
+    freeBreakpoints();
+    resetTranslations();
+    unloadAssets(g_runtimeContext->pendingAssetsMemory);
+    g_runtimeContext->pendingAssets = nullptr;
+    g_runtimeContext->pendingAssetsMemory = nullptr;
+    unloadAssets(g_runtimeContext->previousAssetsMemory);
+    g_runtimeContext->previousAssets = nullptr;
+    g_runtimeContext->previousAssetsMemory = nullptr;
 }
 bool isFlowStopped() {
-    return g_isStopped;
+    return g_runtimeContext->isStopped;
 }
 unsigned getTickMaxDurationCounter() {
-    return g_tick_max_duration_count;
+    return g_runtimeContext->tickMaxDurationCount;
 }
 FlowState *getPageFlowState(Assets *assets, int16_t pageIndex) {
 	if (!assets->flowDefinition) {
@@ -6300,13 +8446,13 @@ FlowState *getPageFlowState(Assets *assets, int16_t pageIndex) {
 		return nullptr;
 	}
     FlowState *flowState;
-    for (flowState = g_firstFlowState; flowState; flowState = flowState->nextSibling) {
-        if (flowState->flowIndex == pageIndex) {
+    for (flowState = g_runtimeContext->firstFlowState; flowState; flowState = flowState->nextSibling) {
+        if (flowState->assets == assets && flowState->flowIndex == pageIndex) {
             break;
         }
     }
     if (flowState) {
-        flowState->deleteOnNextTick = false;
+        cancelFlowStateDeletion(flowState);
     } else {
         flowState = initPageFlowState(assets, pageIndex, nullptr, 0);
     }
@@ -6322,52 +8468,57 @@ int getPageIndexIncludeParents(FlowState *flowState) {
 	return flowState->flowIndex;
 }
 void deletePageFlowState(Assets *assets, int16_t pageIndex) {
-    EEZ_UNUSED(assets);
-    for (FlowState *flowState = g_firstFlowState; flowState; flowState = flowState->nextSibling) {
-        if (flowState->flowIndex == pageIndex) {
-            flowState->deleteOnNextTick = true;
+    for (FlowState *flowState = g_runtimeContext->firstFlowState; flowState; flowState = flowState->nextSibling) {
+        if (flowState->assets == assets && flowState->flowIndex == pageIndex) {
+            scheduleFlowStateDeletion(flowState);
             return;
         }
     }
 }
 Value getGlobalVariable(uint32_t globalVariableIndex) {
-    return getGlobalVariable(g_mainAssets, globalVariableIndex);
+    return getGlobalVariable(getMainAssets(), globalVariableIndex);
 }
 Value getGlobalVariable(Assets *assets, uint32_t globalVariableIndex) {
     if (globalVariableIndex < assets->flowDefinition->globalVariables.count) {
-        return g_globalVariables && !assets->external ? g_globalVariables->values[globalVariableIndex] : *assets->flowDefinition->globalVariables[globalVariableIndex];
+        if (g_runtimeContext->globalVariables && !assets->external) {
+            return g_runtimeContext->globalVariables->values[globalVariableIndex];
+        }
+        Value value = *assets->flowDefinition->globalVariables[globalVariableIndex];
+        value.options &= ~VALUE_OPTIONS_SHARED;
+        return value;
     }
     return Value();
 }
 void setGlobalVariable(uint32_t globalVariableIndex, const Value &value) {
-    setGlobalVariable(g_mainAssets, globalVariableIndex, value);
+    setGlobalVariable(getMainAssets(), globalVariableIndex, value);
 }
 void setGlobalVariable(Assets *assets, uint32_t globalVariableIndex, const Value &value) {
     if (globalVariableIndex < assets->flowDefinition->globalVariables.count) {
-        if (g_globalVariables && !assets->external) {
-            g_globalVariables->values[globalVariableIndex] = value;
+        if (g_runtimeContext->globalVariables && !assets->external) {
+            g_runtimeContext->globalVariables->values[globalVariableIndex] = value;
         } else {
             *assets->flowDefinition->globalVariables[globalVariableIndex] = value;
         }
+        markWatchesDirtyForGlobalVariable(globalVariableIndex);
     }
 }
 Value getUserProperty(unsigned propertyIndex) {
     Value value;
-    evalProperty(g_executeActionFlowState, g_executeActionComponentIndex, propertyIndex, value, FlowError::PropertyNum("CallAction", propertyIndex));
+    evalProperty(g_runtimeContext->executeActionFlowState, g_runtimeContext->executeActionComponentIndex, propertyIndex, value, FlowError::PropertyNum("CallAction", propertyIndex));
     return value;
 }
 void setUserProperty(unsigned propertyIndex, const Value &value) {
     Value dstValue;
-    if (!evalAssignableProperty(g_executeActionFlowState, g_executeActionComponentIndex, propertyIndex, dstValue, FlowError::PropertyInArray("CallAction", "Assignable property", propertyIndex))) {
+    if (!evalAssignableProperty(g_runtimeContext->executeActionFlowState, g_runtimeContext->executeActionComponentIndex, propertyIndex, dstValue, FlowError::PropertyInArray("CallAction", "Assignable property", propertyIndex))) {
         return;
     }
-    assignValue(g_executeActionFlowState, g_executeActionComponentIndex, dstValue, value);
+    assignValue(g_runtimeContext->executeActionFlowState, g_runtimeContext->executeActionComponentIndex, dstValue, value);
 }
 AsyncAction *beginAsyncExecution() {
-    startAsyncExecution(g_executeActionFlowState, g_executeActionComponentIndex);
+    startAsyncExecution(g_runtimeContext->executeActionFlowState, g_runtimeContext->executeActionComponentIndex);
     AsyncAction *asyncAction = (AsyncAction *) alloc(sizeof(AsyncAction), 0xcb44f51e);
-    asyncAction->flowState = g_executeActionFlowState;
-    asyncAction->componentIndex = g_executeActionComponentIndex;
+    asyncAction->flowState = g_runtimeContext->executeActionFlowState;
+    asyncAction->componentIndex = g_runtimeContext->executeActionComponentIndex;
     return asyncAction;
 }
 void endAsyncExecution(AsyncAction *asyncAction) {
@@ -6385,7 +8536,7 @@ void setUserPropertyAsync(AsyncAction *asyncAction, unsigned propertyIndex, cons
     if (!evalAssignableProperty(asyncAction->flowState, asyncAction->componentIndex, propertyIndex, dstValue, FlowError::PropertyInArray("CallAction", "Assignable property", propertyIndex))) {
         return;
     }
-    assignValue(g_executeActionFlowState, g_executeActionComponentIndex, dstValue, value);
+    assignValue(g_runtimeContext->executeActionFlowState, g_runtimeContext->executeActionComponentIndex, dstValue, value);
 }
 void onArrayValueFree(ArrayValue *arrayValue) {
     if (arrayValue->arrayType == defs_v3::OBJECT_TYPE_MQTT_CONNECTION) {
@@ -6451,6 +8602,8 @@ void (*scpiComponentInitHook)() = scpiComponentInit;
 void (*startToDebuggerMessageHook)() = startToDebuggerMessage;
 void (*writeDebuggerBufferHook)(const char *buffer, uint32_t length) = writeDebuggerBuffer;
 void (*finishToDebuggerMessageHook)() = finishToDebuggerMessage;
+void (*debuggerOutputAvailableHook)() = drainDebuggerOutput;
+void (*logAvailableHook)() = drainLog;
 void (*onDebuggerInputAvailableHook)() = onDebuggerInputAvailable;
 static lv_obj_t *getLvglObjectFromIndex(int32_t index) {
     EEZ_UNUSED(index);
@@ -6526,6 +8679,169 @@ double (*getDateNowHook)() = getDateNowDefaultImplementation;
 double (*getDateNowHook)() = nullptr;
 #endif
 void (*onFlowErrorHook)(FlowState *flowState, int componentIndex, const char *errorMessage) = nullptr;
+void (*getNativeVarsBatchHook)() = nullptr;
+#if EEZ_FLOW_TRACE
+uint32_t (*getTraceTimestampHook)() = millis;
+#endif
+} 
+} 
+// -----------------------------------------------------------------------------
+// flow/inbound_queue.cpp
+// -----------------------------------------------------------------------------
+namespace eez {
+namespace flow {
+#if EEZ_OPTION_THREADS
+void inboundQueueInit(InboundQueue &inboundQueue) {
+    for (uint32_t i = 0; i < INBOUND_QUEUE_SIZE; i++) {
+        inboundQueue.events[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    inboundQueue.enqueuePosition.store(0, std::memory_order_relaxed);
+    inboundQueue.dequeuePosition = 0;
+}
+static InboundEvent *beginPost(InboundQueue &inboundQueue, uint32_t &position) {
+    position = inboundQueue.enqueuePosition.load(std::memory_order_relaxed);
+    while (true) {
+        auto event = &inboundQueue.events[position & (INBOUND_QUEUE_SIZE - 1)];
+        auto sequence = event->sequence.load(std::memory_order_acquire);
+        auto diff = (int32_t)(sequence - position);
+        if (diff == 0) {
+            if (inboundQueue.enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                return event;
+            }
+        } else if (diff < 0) {
+            return nullptr;
+        } else {
+            position = inboundQueue.enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+static void endPost(InboundEvent *event, uint32_t position) {
+    event->sequence.store(position + 1, std::memory_order_release);
+}
+static bool isInboundValue(const Value &value) {
+    return value.type <= VALUE_TYPE_DOUBLE || value.type == VALUE_TYPE_DATE;
+}
+bool postEndAsyncExecution(AsyncAction *asyncAction, RuntimeContext *runtimeContext) {
+    uint32_t position;
+    auto event = beginPost(runtimeContext->inboundQueue, position);
+    if (!event) {
+        return false;
+    }
+    event->type = INBOUND_EVENT_END_ASYNC_ACTION;
+    event->asyncAction = asyncAction;
+    endPost(event, position);
+    return true;
+}
+bool postEndAsyncExecution(FlowState *flowState, int componentIndex, RuntimeContext *runtimeContext) {
+    uint32_t position;
+    auto event = beginPost(runtimeContext->inboundQueue, position);
+    if (!event) {
+        return false;
+    }
+    event->type = INBOUND_EVENT_END_ASYNC_EXECUTION;
+    event->flowState = flowState;
+    event->componentIndex = componentIndex;
+    endPost(event, position);
+    return true;
+}
+bool postPropagateValue(FlowState *flowState, unsigned componentIndex, unsigned outputIndex, const Value &value, RuntimeContext *runtimeContext) {
+    if (!isInboundValue(value)) {
+        return false;
+    }
+    uint32_t position;
+    auto event = beginPost(runtimeContext->inboundQueue, position);
+    if (!event) {
+        return false;
+    }
+    event->type = INBOUND_EVENT_PROPAGATE_VALUE;
+    event->flowState = flowState;
+    event->componentIndex = componentIndex;
+    event->outputIndex = outputIndex;
+    event->value = value;
+    endPost(event, position);
+    return true;
+}
+bool postSetGlobalVariable(uint32_t globalVariableIndex, const Value &value, RuntimeContext *runtimeContext) {
+    if (!isInboundValue(value)) {
+        return false;
+    }
+    uint32_t position;
+    auto event = beginPost(runtimeContext->inboundQueue, position);
+    if (!event) {
+        return false;
+    }
+    event->type = INBOUND_EVENT_SET_GLOBAL_VARIABLE;
+    event->componentIndex = globalVariableIndex;
+    event->value = value;
+    endPost(event, position);
+    return true;
+}
+static InboundEvent *peekInboundEvent(InboundQueue &inboundQueue) {
+    auto position = inboundQueue.dequeuePosition;
+    auto event = &inboundQueue.events[position & (INBOUND_QUEUE_SIZE - 1)];
+    auto sequence = event->sequence.load(std::memory_order_acquire);
+    if ((int32_t)(sequence - (position + 1)) < 0) {
+        return nullptr;
+    }
+    return event;
+}
+static void releaseInboundEvent(InboundQueue &inboundQueue, InboundEvent *event) {
+    event->value = Value();
+    event->sequence.store(inboundQueue.dequeuePosition + INBOUND_QUEUE_SIZE, std::memory_order_release);
+    inboundQueue.dequeuePosition++;
+}
+void inboundQueueReset() {
+    auto &inboundQueue = g_runtimeContext->inboundQueue;
+    while (auto event = peekInboundEvent(inboundQueue)) {
+        if (event->type == INBOUND_EVENT_END_ASYNC_ACTION) {
+            eez::free(event->asyncAction);
+        }
+        releaseInboundEvent(inboundQueue, event);
+    }
+}
+void removeInboundEventsForFlowState(FlowState *flowState) {
+    auto &inboundQueue = g_runtimeContext->inboundQueue;
+    for (uint32_t i = 0; i < INBOUND_QUEUE_SIZE; i++) {
+        auto position = inboundQueue.dequeuePosition + i;
+        auto event = &inboundQueue.events[position & (INBOUND_QUEUE_SIZE - 1)];
+        if ((int32_t)(event->sequence.load(std::memory_order_acquire) - (position + 1)) < 0) {
+            break;
+        }
+        if (event->type == INBOUND_EVENT_END_ASYNC_ACTION) {
+            if (event->asyncAction->flowState == flowState) {
+                eez::free(event->asyncAction);
+                event->type = INBOUND_EVENT_CANCELLED;
+            }
+        } else if (event->type == INBOUND_EVENT_END_ASYNC_EXECUTION || event->type == INBOUND_EVENT_PROPAGATE_VALUE) {
+            if (event->flowState == flowState) {
+                event->type = INBOUND_EVENT_CANCELLED;
+            }
+        }
+    }
+}
+void drainInboundQueue() {
+    auto &inboundQueue = g_runtimeContext->inboundQueue;
+    for (uint32_t i = 0; i < INBOUND_QUEUE_SIZE; i++) {
+        auto event = peekInboundEvent(inboundQueue);
+        if (!event) {
+            break;
+        }
+        if (event->type == INBOUND_EVENT_END_ASYNC_ACTION) {
+            endAsyncExecution(event->asyncAction);
+        } else if (event->type == INBOUND_EVENT_END_ASYNC_EXECUTION) {
+            endAsyncExecution(event->flowState, event->componentIndex);
+        } else if (event->type == INBOUND_EVENT_PROPAGATE_VALUE) {
+            propagateValue(event->flowState, event->componentIndex, event->outputIndex, event->value);
+        } else if (event->type == INBOUND_EVENT_SET_GLOBAL_VARIABLE) {
+            setGlobalVariable(event->componentIndex, event->value);
+        }
+        releaseInboundEvent(inboundQueue, event);
+        if (isFlowStopped() || g_runtimeContext->isStopping) {
+            break;
+        }
+    }
+}
+#endif
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -6731,7 +9047,9 @@ extern "C" void eez_flow_init(const uint8_t *assets, uint32_t assetsSize, lv_obj
     g_numImages = numImages;
     g_actions = actions;
     eez::initAssetsMemory();
-    eez::loadMainAssets(assets, assetsSize);
+    if (!eez::loadMainAssets(assets, assetsSize)) {
+        return;
+    }
     eez::initOtherMemory();
     eez::initAllocHeap(eez::ALLOC_BUFFER, eez::ALLOC_BUFFER_SIZE);
     eez::flow::replacePageHook = replacePageHook;
@@ -6746,7 +9064,7 @@ extern "C" void eez_flow_init(const uint8_t *assets, uint32_t assetsSize, lv_obj
     eez::flow::executeLvglActionHook = executeLvglAction;
     eez::flow::getLvglGroupFromIndexHook = getLvglGroupFromIndex;
     eez::flow::lvglSetColorThemeHook = eez_flow_set_theme;
-    eez::flow::start(eez::g_mainAssets);
+    eez::flow::start(eez::flow::g_runtimeContext->loadedAssets);
     create_screens();
     replacePageHook(1, 0, 0, 0);
 }
@@ -6798,7 +9116,7 @@ void replacePageHook(int16_t pageId, uint32_t animType, uint32_t speed, uint32_t
     lv_scr_load_anim(screen, (lv_scr_load_anim_t)animType, speed, delay, false);
 }
 extern "C" void flowOnPageLoaded(unsigned pageIndex) {
-    eez::flow::getPageFlowState(eez::g_mainAssets, pageIndex);
+    eez::flow::getPageFlowState(eez::flow::g_runtimeContext->loadedAssets, pageIndex);
 }
 extern "C" void flowPropagateValue(void *flowState, unsigned componentIndex, unsigned outputIndex) {
     eez::flow::propagateValue((eez::flow::FlowState *)flowState, componentIndex, outputIndex);
@@ -6817,6 +9135,7 @@ EM_PORT_API(void) flowPropagateValueLVGLEvent(void *flowState, unsigned componen
     void *userDataPointer = lv_event_get_user_data(event);
     int32_t userData = (intptr_t)userDataPointer;
     uint32_t key = 0;
+    bool coalesce = event_code == LV_EVENT_VALUE_CHANGED || event_code == LV_EVENT_PRESSING || event_code == LV_EVENT_SCROLL;
     if (event_code == LV_EVENT_KEY || (event_code == LV_EVENT_VALUE_CHANGED &&
 #if LVGL_VERSION_MAJOR >= 9
         lv_obj_check_type((lv_obj_t*)target, &lv_buttonmatrix_class)
@@ -6826,6 +9145,7 @@ EM_PORT_API(void) flowPropagateValueLVGLEvent(void *flowState, unsigned componen
     )) {
         uint32_t *param = (uint32_t *)lv_event_get_param(event);
         key = param ? *param : 0;
+        coalesce = false;
     }
     int32_t gestureDir = (int32_t)LV_DIR_NONE;
     if (event_code == LV_EVENT_GESTURE) {
@@ -6848,12 +9168,15 @@ EM_PORT_API(void) flowPropagateValueLVGLEvent(void *flowState, unsigned componen
         rotaryDiff = lv_event_get_rotary_diff(event);
     }
 #endif
-    eez::flow::propagateValue(
-        (eez::flow::FlowState *)flowState, componentIndex, outputIndex,
-        eez::Value::makeLVGLEventRef(
-            code, currentTarget, target, userData, key, gestureDir, rotaryDiff, 0xe7f23624
-        )
+    auto eventValue = eez::Value::makeLVGLEventRef(
+        code, currentTarget, target, userData, key, gestureDir, rotaryDiff, 0xe7f23624
     );
+    if (coalesce) {
+        eez::flow::propagateValueCoalesced((eez::flow::FlowState *)flowState, componentIndex, outputIndex, eventValue, code);
+    } else {
+        eez::flow::flushCoalescedEvents();
+        eez::flow::propagateValue((eez::flow::FlowState *)flowState, componentIndex, outputIndex, eventValue);
+    }
     g_lastLVGLEvent = *event;
 }
 #ifndef EEZ_LVGL_TEMP_STRING_BUFFER_SIZE
@@ -6964,7 +9287,7 @@ extern "C" float getTimelinePosition(void *flowState) {
 }
 void *getFlowState(void *flowState, unsigned userWidgetComponentIndexOrPageIndex) {
     if (!flowState) {
-        return eez::flow::getPageFlowState(eez::g_mainAssets, userWidgetComponentIndexOrPageIndex);
+        return eez::flow::getPageFlowState(eez::flow::g_runtimeContext->loadedAssets, userWidgetComponentIndexOrPageIndex);
     }
     auto executionState = (eez::flow::LVGLUserWidgetExecutionState *)((eez::flow::FlowState *)flowState)->componenentExecutionStates[userWidgetComponentIndexOrPageIndex];
     if (!executionState) {
@@ -6973,7 +9296,7 @@ void *getFlowState(void *flowState, unsigned userWidgetComponentIndexOrPageIndex
     return executionState->flowState;
 }
 void deletePageFlowState(unsigned pageIndex) {
-    eez::flow::deletePageFlowState(eez::g_mainAssets, (int16_t)pageIndex);
+    eez::flow::deletePageFlowState(eez::flow::g_runtimeContext->loadedAssets, (int16_t)pageIndex);
 }
 extern "C" int compareRollerOptions(lv_roller_t *roller, const char *new_val, const char *cur_val, lv_roller_mode_t mode) {
     EEZ_UNUSED(mode);
@@ -7745,14 +10068,14 @@ static void do_OPERATION_TYPE_FLOW_TRANSLATE(EvalStack &stack) {
         stack.push(Value::makeError());
         return;
     }
-    int languageIndex = g_selectedLanguage;
-    auto &languages = stack.flowState->assets->languages;
-    if (languageIndex >= 0 && languageIndex < (int)languages.count) {
-        auto &translations = languages[languageIndex]->translations;
-        if (textResourceIndex >= 0 && textResourceIndex < (int)translations.count) {
-            stack.push(translations[textResourceIndex]);
-            return;
-        }
+    if (stack.flowState->assets != g_runtimeContext->translationsAssets && !loadTranslations(stack.flowState->assets)) {
+        stack.push(Value::makeError());
+        return;
+    }
+    auto array = g_runtimeContext->translations.getArray();
+    if (textResourceIndex >= 0 && textResourceIndex < (int)array->arraySize) {
+        stack.push(array->values[textResourceIndex]);
+        return;
     }
     stack.push("");
 }
@@ -9185,6 +11508,7 @@ EvalOperation g_evalOperations[] = {
     do_OPERATION_TYPE_LVGL_COLOR_DARKEN,
     do_OPERATION_TYPE_LVGL_COLOR_LIGHTEN,
 };
+const uint32_t g_numEvalOperations = sizeof(g_evalOperations) / sizeof(EvalOperation);
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -9194,9 +11518,7 @@ EvalOperation g_evalOperations[] = {
 #include <string.h>
 namespace eez {
 namespace flow {
-GlobalVariables *g_globalVariables = nullptr;
 static const unsigned NO_COMPONENT_INDEX = 0xFFFFFFFF;
-static bool g_enableThrowError = true;
 inline bool isInputEmpty(const Value& inputValue) {
     return inputValue.type == VALUE_TYPE_UNDEFINED && inputValue.int32Value > 0;
 }
@@ -9205,20 +11527,29 @@ inline Value getEmptyInputValue() {
     emptyInputValue.int32Value = 1;
     return emptyInputValue;
 }
+static Value getInitialValue(Value *value) {
+    if (value->options & VALUE_OPTIONS_SHARED) {
+        Value sharedValue = *value;
+        sharedValue.options &= ~VALUE_OPTIONS_SHARED;
+        return sharedValue;
+    }
+    return value->clone();
+}
 void initGlobalVariables(Assets *assets) {
-    if (assets->external || g_mainAssetsAreMutable) {
+    if (assets->external || (assets == g_runtimeContext->loadedAssets && g_runtimeContext->loadedAssetsAreMutable)) {
         return;
     }
 	auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
     auto numVars = flowDefinition->globalVariables.count;
-    g_globalVariables = (GlobalVariables *) alloc(
+    g_runtimeContext->globalVariables = (GlobalVariables *) alloc(
         sizeof(GlobalVariables) +
         (numVars > 0 ? numVars - 1 : 0) * sizeof(Value),
         0xcc34ca8e
     );
+    g_runtimeContext->globalVariables->count = numVars;
     for (uint32_t i = 0; i < numVars; i++) {
-		new (g_globalVariables->values + i) Value();
-        g_globalVariables->values[i] = flowDefinition->globalVariables[i]->clone();
+		new (g_runtimeContext->globalVariables->values + i) Value();
+        g_runtimeContext->globalVariables->values[i] = getInitialValue(flowDefinition->globalVariables[i]);
 	}
 }
 static bool isComponentReadyToRun(FlowState *flowState, unsigned componentIndex) {
@@ -9278,31 +11609,57 @@ static bool pingComponent(FlowState *flowState, unsigned componentIndex, int sou
 	}
 	return false;
 }
-static FlowState *initFlowState(Assets *assets, int flowIndex, FlowState *parentFlowState, int parentComponentIndex, const Value& inputValue) {
+#if EEZ_FLOW_INLINE_ACTIONS
+static void *allocInlineFrameMemory(size_t size) {
+    auto position = (g_runtimeContext->inlineFrameArenaPosition + 7) & ~7;
+    if (position + size > EEZ_FLOW_INLINE_FRAME_ARENA_SIZE) {
+        return nullptr;
+    }
+    g_runtimeContext->inlineFrameArenaPosition = position + size;
+    return g_runtimeContext->inlineFrameArena + position;
+}
+#endif
+static FlowState *initFlowState(Assets *assets, int flowIndex, FlowState *parentFlowState, int parentComponentIndex, const Value& inputValue, InlineFrame *inlineFrame = nullptr) {
 	auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
 	auto flow = flowDefinition->flows[flowIndex];
 	auto nValues = flow->componentInputs.count + flow->localVariables.count;
-	FlowState *flowState = new (
-		alloc(
-			sizeof(FlowState) +
-			nValues * sizeof(Value) +
-			flow->components.count * sizeof(ComponenentExecutionState *) +
-			flow->components.count * sizeof(bool),
-			0x4c3b6ef5
-		)
-	) FlowState;
+    auto flowStateSize =
+        sizeof(FlowState) +
+        nValues * sizeof(Value) +
+        flow->components.count * sizeof(ComponenentExecutionState *) +
+        flow->components.count * sizeof(bool);
+    void *flowStateMemory;
+#if EEZ_FLOW_INLINE_ACTIONS
+    if (inlineFrame) {
+        flowStateMemory = allocInlineFrameMemory(flowStateSize);
+        if (!flowStateMemory) {
+            return nullptr;
+        }
+    } else
+#endif
+    flowStateMemory = alloc(flowStateSize, 0x4c3b6ef5);
+	FlowState *flowState = new (flowStateMemory) FlowState;
 	flowState->assets = assets;
     flowState->flowStateIndex = (int)((uint8_t *)flowState - ALLOC_BUFFER);
 	flowState->flow = flowDefinition->flows[flowIndex];
 	flowState->flowIndex = flowIndex;
 	flowState->error = false;
     flowState->deleteOnNextTick = false;
+    flowState->debuggerAnnounced = false;
+    flowState->previousScheduledForDeletion = nullptr;
+    flowState->nextScheduledForDeletion = nullptr;
 	flowState->refCounter = 0;
 	flowState->parentFlowState = parentFlowState;
     flowState->executingComponentIndex = NO_COMPONENT_INDEX;
     flowState->timelinePosition = 0;
     flowState->lvglWidgetStartIndex = 0;
-    if (parentFlowState) {
+    flowState->inlineFrame = inlineFrame;
+    flowState->breakpoints = getFlowBreakpoints(assets, flowIndex);
+    if (inlineFrame) {
+        flowState->previousSibling = nullptr;
+		flowState->parentComponentIndex = parentComponentIndex;
+		flowState->parentComponent = parentComponentIndex == -1 ? nullptr : parentFlowState->flow->components[parentComponentIndex];
+    } else if (parentFlowState) {
         if (parentFlowState->lastChild) {
             parentFlowState->lastChild->nextSibling = flowState;
             flowState->previousSibling = parentFlowState->lastChild;
@@ -9315,14 +11672,14 @@ static FlowState *initFlowState(Assets *assets, int flowIndex, FlowState *parent
 		flowState->parentComponentIndex = parentComponentIndex;
 		flowState->parentComponent = parentComponentIndex == -1 ? nullptr : parentFlowState->flow->components[parentComponentIndex];
 	} else {
-        if (g_lastFlowState) {
-            g_lastFlowState->nextSibling = flowState;
-            flowState->previousSibling = g_lastFlowState;
-            g_lastFlowState = flowState;
+        if (g_runtimeContext->lastFlowState) {
+            g_runtimeContext->lastFlowState->nextSibling = flowState;
+            flowState->previousSibling = g_runtimeContext->lastFlowState;
+            g_runtimeContext->lastFlowState = flowState;
         } else {
             flowState->previousSibling = nullptr;
-            g_firstFlowState = flowState;
-            g_lastFlowState = flowState;
+            g_runtimeContext->firstFlowState = flowState;
+            g_runtimeContext->lastFlowState = flowState;
         }
 		flowState->parentComponentIndex = -1;
 		flowState->parentComponent = nullptr;
@@ -9342,15 +11699,22 @@ static FlowState *initFlowState(Assets *assets, int flowIndex, FlowState *parent
 		flowState->values[i] = emptyInputValue;
 	}
 	for (unsigned i = 0; i < flow->localVariables.count; i++) {
-		auto value = flow->localVariables[i];
-		flowState->values[flow->componentInputs.count + i] = value->clone();
+		flowState->values[flow->componentInputs.count + i] = getInitialValue(flow->localVariables[i]);
 	}
 	for (unsigned i = 0; i < flow->components.count; i++) {
 		flowState->componenentExecutionStates[i] = nullptr;
 		flowState->componenentAsyncStates[i] = false;
 	}
-	onFlowStateCreated(flowState);
+    if (!inlineFrame) {
+	    onFlowStateCreated(flowState);
+    }
 	for (unsigned componentIndex = 0; componentIndex < flow->components.count; componentIndex++) {
+        if (
+            g_runtimeContext->skipComponentPings ||
+            (g_runtimeContext->skipStartActions && flow->components[componentIndex]->type == defs_v3::COMPONENT_TYPE_START_ACTION)
+        ) {
+            continue;
+        }
 		pingComponent(flowState, componentIndex);
 	}
 	return flowState;
@@ -9360,8 +11724,29 @@ FlowState *initActionFlowState(int flowIndex, FlowState *parentFlowState, int pa
 	if (flowState) {
 		flowState->isAction = true;
 	}
-	return flowState;
+	return flowState;
+}
+#if EEZ_FLOW_INLINE_ACTIONS
+FlowState *initInlineActionFlowState(int flowIndex, FlowState *parentFlowState, int parentComponentIndex, const Value &inputValue, InlineFrame *inlineFrame) {
+	auto flowState = initFlowState(parentFlowState->assets, flowIndex, parentFlowState, parentComponentIndex, inputValue, inlineFrame);
+	if (flowState) {
+		flowState->isAction = true;
+	}
+	return flowState;
+}
+void freeInlineActionFlowState(FlowState *flowState) {
+	auto flow = flowState->flow;
+	auto valuesCount = flow->componentInputs.count + flow->localVariables.count;
+	for (unsigned int i = 0; i < valuesCount; i++) {
+		(flowState->values + i)->~Value();
+	}
+	for (unsigned i = 0; i < flow->components.count; i++) {
+        deallocateComponentExecutionState(flowState, i);
+	}
+	flowState->~FlowState();
+    g_runtimeContext->inlineFrameArenaPosition = (uint32_t)((uint8_t *)flowState - g_runtimeContext->inlineFrameArena);
 }
+#endif
 FlowState *initPageFlowState(Assets *assets, int flowIndex, FlowState *parentFlowState, int parentComponentIndex) {
 	auto flowState = initFlowState(assets, flowIndex, parentFlowState, parentComponentIndex, Value());
 	if (flowState) {
@@ -9413,11 +11798,11 @@ void freeFlowState(FlowState *flowState) {
             parentFlowState->lastChild = flowState->previousSibling;
         }
     } else {
-        if (g_firstFlowState == flowState) {
-            g_firstFlowState = flowState->nextSibling;
+        if (g_runtimeContext->firstFlowState == flowState) {
+            g_runtimeContext->firstFlowState = flowState->nextSibling;
         }
-        if (g_lastFlowState == flowState) {
-            g_lastFlowState = flowState->previousSibling;
+        if (g_runtimeContext->lastFlowState == flowState) {
+            g_runtimeContext->lastFlowState = flowState->previousSibling;
         }
     }
     if (flowState->previousSibling) {
@@ -9426,6 +11811,7 @@ void freeFlowState(FlowState *flowState) {
     if (flowState->nextSibling) {
         flowState->nextSibling->previousSibling = flowState->previousSibling;
     }
+    cancelFlowStateDeletion(flowState);
 	auto flow = flowState->flow;
 	auto valuesCount = flow->componentInputs.count + flow->localVariables.count;
 	for (unsigned int i = 0; i < valuesCount; i++) {
@@ -9436,6 +11822,10 @@ void freeFlowState(FlowState *flowState) {
 	}
     removeTasksFromQueueForFlowState(flowState);
     removeWatchesForFlowState(flowState);
+    removeCoalescedEventsForFlowState(flowState);
+#if EEZ_OPTION_THREADS
+    removeInboundEventsForFlowState(flowState);
+#endif
     freeAllChildrenFlowStates(flowState->firstChild);
 	onFlowStateDestroyed(flowState);
 	flowState->~FlowState();
@@ -9450,6 +11840,41 @@ void freeAllChildrenFlowStates(FlowState *firstChildFlowState) {
         flowState = nextFlowState;
     }
 }
+void scheduleFlowStateDeletion(FlowState *flowState) {
+    if (flowState->deleteOnNextTick) {
+        return;
+    }
+    flowState->deleteOnNextTick = true;
+    auto first = g_runtimeContext->firstFlowStateScheduledForDeletion;
+    flowState->previousScheduledForDeletion = nullptr;
+    flowState->nextScheduledForDeletion = first;
+    if (first) {
+        first->previousScheduledForDeletion = flowState;
+    }
+    g_runtimeContext->firstFlowStateScheduledForDeletion = flowState;
+}
+void cancelFlowStateDeletion(FlowState *flowState) {
+    if (!flowState->deleteOnNextTick) {
+        return;
+    }
+    flowState->deleteOnNextTick = false;
+    if (flowState->previousScheduledForDeletion) {
+        flowState->previousScheduledForDeletion->nextScheduledForDeletion = flowState->nextScheduledForDeletion;
+    } else {
+        g_runtimeContext->firstFlowStateScheduledForDeletion = flowState->nextScheduledForDeletion;
+    }
+    if (flowState->nextScheduledForDeletion) {
+        flowState->nextScheduledForDeletion->previousScheduledForDeletion = flowState->previousScheduledForDeletion;
+    }
+    flowState->previousScheduledForDeletion = nullptr;
+    flowState->nextScheduledForDeletion = nullptr;
+}
+void freeFlowStatesScheduledForDeletion() {
+    while (auto flowState = g_runtimeContext->firstFlowStateScheduledForDeletion) {
+        cancelFlowStateDeletion(flowState);
+        freeFlowState(flowState);
+    }
+}
 void deallocateComponentExecutionState(FlowState *flowState, unsigned componentIndex) {
     auto executionState = flowState->componenentExecutionStates[componentIndex];
     if (executionState) {
@@ -9473,7 +11898,7 @@ void resetSequenceInputs(FlowState *flowState) {
                     auto pValue = &flowState->values[inputIndex];
                     if (!isInputEmpty(*pValue)) {
                         *pValue = getEmptyInputValue();
-                        onValueChanged(pValue);
+                        onValueChanged(flowState, pValue);
                     }
                 }
             }
@@ -9495,7 +11920,7 @@ void propagateValue(FlowState *flowState, unsigned componentIndex, unsigned outp
 		auto pValue = &flowState->values[connection->targetInputIndex];
 		if (*pValue != value2) {
 			*pValue = value2;
-				onValueChanged(pValue);
+				onValueChanged(flowState, pValue);
 		}
 		pingComponent(flowState, connection->targetComponentIndex, componentIndex, outputIndex, connection->targetInputIndex);
 	}
@@ -9542,6 +11967,10 @@ void assignValue(FlowState *flowState, int componentIndex, Value &dstValue, cons
                 }
                 return;
             } else {
+                if (arrayElementValue->arrayValue.type == VALUE_TYPE_ARRAY_ASSET && !g_runtimeContext->loadedAssetsAreMutable) {
+                    throwError(flowState, componentIndex, FlowError::Plain("Can not assign, array is constant"));
+                    return;
+                }
                 auto array = arrayElementValue->arrayValue.getArray();
                 if (arrayElementValue->elementIndex < 0 || arrayElementValue->elementIndex >= (int)array->arraySize) {
                     throwError(flowState, componentIndex, FlowError::Plain("Can not assign, array element index out of bounds"));
@@ -9581,6 +12010,7 @@ void assignValue(FlowState *flowState, int componentIndex, Value &dstValue, cons
         }
         if (assignValue(*pDstValue, srcValue, dstValueType)) {
             onValueChanged(pDstValue);
+            markWatchesDirtyForValue(flowState, pDstValue);
         } else {
             char errorMessage[100];
             snprintf(errorMessage, sizeof(errorMessage), "Can not assign %s to %s\n",
@@ -9592,7 +12022,7 @@ void assignValue(FlowState *flowState, int componentIndex, Value &dstValue, cons
 }
 void clearInputValue(FlowState *flowState, int inputIndex) {
     flowState->values[inputIndex] = Value();
-    onValueChanged(flowState->values + inputIndex);
+    onValueChanged(flowState, flowState->values + inputIndex);
 }
 void startAsyncExecution(FlowState *flowState, int componentIndex) {
     if (!flowState->componenentAsyncStates[componentIndex]) {
@@ -9602,7 +12032,7 @@ void startAsyncExecution(FlowState *flowState, int componentIndex) {
     }
 }
 void endAsyncExecution(FlowState *flowState, int componentIndex) {
-    if (!g_firstFlowState) {
+    if (!g_runtimeContext->firstFlowState) {
         return;
     }
     if (flowState->componenentAsyncStates[componentIndex]) {
@@ -9640,6 +12070,66 @@ void onEvent(FlowState *flowState, FlowEvent flowEvent, Value eventValue) {
         }
     }
 }
+void propagateValueCoalesced(FlowState *flowState, unsigned componentIndex, unsigned outputIndex, const Value &value, uint32_t eventCode) {
+    auto coalescedEvents = g_runtimeContext->coalescedEvents;
+    for (unsigned i = 0; i < g_runtimeContext->numCoalescedEvents; i++) {
+        auto &coalescedEvent = coalescedEvents[i];
+        if (
+            coalescedEvent.flowState == flowState &&
+            coalescedEvent.componentIndex == componentIndex &&
+            coalescedEvent.outputIndex == outputIndex &&
+            coalescedEvent.eventCode == eventCode
+        ) {
+            coalescedEvent.value = value;
+            return;
+        }
+    }
+    if (g_runtimeContext->numCoalescedEvents == EEZ_FLOW_COALESCED_EVENTS_SIZE) {
+        propagateValue(flowState, componentIndex, outputIndex, value);
+        return;
+    }
+    auto &coalescedEvent = coalescedEvents[g_runtimeContext->numCoalescedEvents++];
+    coalescedEvent.flowState = flowState;
+    coalescedEvent.componentIndex = (uint16_t)componentIndex;
+    coalescedEvent.outputIndex = (uint16_t)outputIndex;
+    coalescedEvent.eventCode = eventCode;
+    coalescedEvent.value = value;
+}
+void flushCoalescedEvents() {
+    auto coalescedEvents = g_runtimeContext->coalescedEvents;
+    for (unsigned i = 0; i < g_runtimeContext->numCoalescedEvents; i++) {
+        auto &coalescedEvent = coalescedEvents[i];
+        Value value = coalescedEvent.value;
+        coalescedEvent.value = Value();
+        propagateValue(coalescedEvent.flowState, coalescedEvent.componentIndex, coalescedEvent.outputIndex, value);
+        if (isFlowStopped() || g_runtimeContext->isStopping) {
+            break;
+        }
+    }
+    resetCoalescedEvents();
+}
+void removeCoalescedEventsForFlowState(FlowState *flowState) {
+    auto coalescedEvents = g_runtimeContext->coalescedEvents;
+    unsigned j = 0;
+    for (unsigned i = 0; i < g_runtimeContext->numCoalescedEvents; i++) {
+        if (coalescedEvents[i].flowState != flowState) {
+            if (i != j) {
+                coalescedEvents[j] = coalescedEvents[i];
+            }
+            j++;
+        }
+    }
+    for (unsigned i = j; i < g_runtimeContext->numCoalescedEvents; i++) {
+        coalescedEvents[i].value = Value();
+    }
+    g_runtimeContext->numCoalescedEvents = j;
+}
+void resetCoalescedEvents() {
+    for (unsigned i = 0; i < g_runtimeContext->numCoalescedEvents; i++) {
+        g_runtimeContext->coalescedEvents[i].value = Value();
+    }
+    g_runtimeContext->numCoalescedEvents = 0;
+}
 static bool findCatchErrorComponent(FlowState *flowState, FlowState *&catchErrorFlowState, int &catchErrorComponentIndex) {
     if (!flowState) {
         return false;
@@ -9661,10 +12151,11 @@ static bool findCatchErrorComponent(FlowState *flowState, FlowState *&catchError
 }
 void throwError(FlowState *flowState, int componentIndex, const char *errorMessage) {
     auto component = flowState->flow->components[componentIndex];
-    if (!g_enableThrowError) {
+    if (!g_runtimeContext->enableThrowError) {
         return;
     }
     LV_LOG_ERROR("EEZ-FLOW error: %s", errorMessage);
+    EEZ_FLOW_TRACE_EVENT(TRACE_EVENT_ERROR, flowState, componentIndex, component->type);
 	if (component->errorCatchOutput != -1) {
 		propagateValue(
 			flowState,
@@ -9808,7 +12299,7 @@ void throwError(FlowState *flowState, int componentIndex, const FlowError &error
     throwError(flowState, componentIndex, errorMessage);
 }
 void enableThrowError(bool enable) {
-    g_enableThrowError = enable;
+    g_runtimeContext->enableThrowError = enable;
 }
 } 
 } 
@@ -9817,110 +12308,107 @@ void enableThrowError(bool enable) {
 // -----------------------------------------------------------------------------
 namespace eez {
 namespace flow {
-#if !defined(EEZ_FLOW_QUEUE_SIZE)
-#define EEZ_FLOW_QUEUE_SIZE 1000
-#endif
-static const unsigned QUEUE_SIZE = EEZ_FLOW_QUEUE_SIZE;
-static EXTRAM_DATA struct {
-	FlowState *flowState;
-	unsigned componentIndex;
-    bool continuousTask;
-} g_queue[QUEUE_SIZE];
-static unsigned g_queueHead;
-static unsigned g_queueTail;
-static unsigned g_queueMax;
-static bool g_queueIsFull = false;
-unsigned g_numNonContinuousTaskInQueue;
 void queueReset() {
-	g_queueHead = 0;
-	g_queueTail = 0;
-	g_queueMax  = 0;
-	g_queueIsFull = false;
-    g_numNonContinuousTaskInQueue = 0;
+	g_runtimeContext->queueHead = 0;
+	g_runtimeContext->queueTail = 0;
+	g_runtimeContext->queueMax  = 0;
+	g_runtimeContext->queueIsFull = false;
+    g_runtimeContext->numNonContinuousTaskInQueue = 0;
 }
 size_t getQueueSize() {
-	if (g_queueHead == g_queueTail) {
-		if (g_queueIsFull) {
+	if (g_runtimeContext->queueHead == g_runtimeContext->queueTail) {
+		if (g_runtimeContext->queueIsFull) {
 			return QUEUE_SIZE;
 		}
 		return 0;
 	}
-	if (g_queueHead < g_queueTail) {
-		return g_queueTail - g_queueHead;
+	if (g_runtimeContext->queueHead < g_runtimeContext->queueTail) {
+		return g_runtimeContext->queueTail - g_runtimeContext->queueHead;
 	}
-	return QUEUE_SIZE - g_queueHead + g_queueTail;
+	return QUEUE_SIZE - g_runtimeContext->queueHead + g_runtimeContext->queueTail;
 }
 size_t getMaxQueueSize() {
-	return g_queueMax;
+	return g_runtimeContext->queueMax;
 }
 bool addToQueue(FlowState *flowState, unsigned componentIndex, int sourceComponentIndex, int sourceOutputIndex, int targetInputIndex, bool continuousTask) {
-	if (g_queueIsFull) {
+#if EEZ_FLOW_INLINE_ACTIONS
+    if (flowState && flowState->inlineFrame) {
+        return addToInlineFrame(flowState, componentIndex);
+    }
+#endif
+	if (g_runtimeContext->queueIsFull) {
         throwError(flowState, componentIndex, "Execution queue is full\n");
 		return false;
 	}
-	g_queue[g_queueTail].flowState = flowState;
-	g_queue[g_queueTail].componentIndex = componentIndex;
-    g_queue[g_queueTail].continuousTask = continuousTask;
-	g_queueTail = (g_queueTail + 1) % QUEUE_SIZE;
-	if (g_queueHead == g_queueTail) {
-		g_queueIsFull = true;
+	g_runtimeContext->queue[g_runtimeContext->queueTail].flowState = flowState;
+	g_runtimeContext->queue[g_runtimeContext->queueTail].componentIndex = componentIndex;
+    g_runtimeContext->queue[g_runtimeContext->queueTail].continuousTask = continuousTask;
+    g_runtimeContext->queue[g_runtimeContext->queueTail].debuggerNotified = false;
+    auto task = &g_runtimeContext->queue[g_runtimeContext->queueTail];
+	g_runtimeContext->queueTail = (g_runtimeContext->queueTail + 1) % QUEUE_SIZE;
+	if (g_runtimeContext->queueHead == g_runtimeContext->queueTail) {
+		g_runtimeContext->queueIsFull = true;
 	}
 	size_t queueSize = getQueueSize();
-	g_queueMax = g_queueMax < queueSize ? queueSize : g_queueMax;
+	g_runtimeContext->queueMax = g_runtimeContext->queueMax < queueSize ? queueSize : g_runtimeContext->queueMax;
+    EEZ_FLOW_TRACE_EVENT(TRACE_EVENT_ADD_TO_QUEUE, flowState, componentIndex, (uint32_t)sourceComponentIndex);
     if (!continuousTask) {
-        ++g_numNonContinuousTaskInQueue;
-	    onAddToQueue(flowState, sourceComponentIndex, sourceOutputIndex, componentIndex, targetInputIndex);
+        ++g_runtimeContext->numNonContinuousTaskInQueue;
+	    task->debuggerNotified = onAddToQueue(flowState, sourceComponentIndex, sourceOutputIndex, componentIndex, targetInputIndex);
     }
     incRefCounterForFlowState(flowState);
 	return true;
 }
 bool peekNextTaskFromQueue(FlowState *&flowState, unsigned &componentIndex, bool &continuousTask) {
-	if (g_queueHead == g_queueTail && !g_queueIsFull) {
+	if (g_runtimeContext->queueHead == g_runtimeContext->queueTail && !g_runtimeContext->queueIsFull) {
 		return false;
 	}
-	flowState = g_queue[g_queueHead].flowState;
-	componentIndex = g_queue[g_queueHead].componentIndex;
-    continuousTask = g_queue[g_queueHead].continuousTask;
+	flowState = g_runtimeContext->queue[g_runtimeContext->queueHead].flowState;
+	componentIndex = g_runtimeContext->queue[g_runtimeContext->queueHead].componentIndex;
+    continuousTask = g_runtimeContext->queue[g_runtimeContext->queueHead].continuousTask;
 	return true;
 }
 void removeNextTaskFromQueue() {
-	auto flowState = g_queue[g_queueHead].flowState;
+	auto flowState = g_runtimeContext->queue[g_runtimeContext->queueHead].flowState;
     decRefCounterForFlowState(flowState);
-    auto continuousTask = g_queue[g_queueHead].continuousTask;
-	g_queueHead = (g_queueHead + 1) % QUEUE_SIZE;
-	g_queueIsFull = false;
+    auto continuousTask = g_runtimeContext->queue[g_runtimeContext->queueHead].continuousTask;
+    auto debuggerNotified = g_runtimeContext->queue[g_runtimeContext->queueHead].debuggerNotified;
+	g_runtimeContext->queueHead = (g_runtimeContext->queueHead + 1) % QUEUE_SIZE;
+	g_runtimeContext->queueIsFull = false;
     if (!continuousTask) {
-        --g_numNonContinuousTaskInQueue;
-	    onRemoveFromQueue();
+        --g_runtimeContext->numNonContinuousTaskInQueue;
+        if (debuggerNotified) {
+	        onRemoveFromQueue();
+        }
     }
 }
 bool isInQueue(FlowState *flowState, unsigned componentIndex) {
-	if (g_queueHead == g_queueTail && !g_queueIsFull) {
+	if (g_runtimeContext->queueHead == g_runtimeContext->queueTail && !g_runtimeContext->queueIsFull) {
 		return false;
 	}
-    unsigned int it = g_queueHead;
+    unsigned int it = g_runtimeContext->queueHead;
     while (true) {
-		if (g_queue[it].flowState == flowState && g_queue[it].componentIndex == componentIndex) {
+		if (g_runtimeContext->queue[it].flowState == flowState && g_runtimeContext->queue[it].componentIndex == componentIndex) {
             return true;
 		}
         it = (it + 1) % QUEUE_SIZE;
-        if (it == g_queueTail) {
+        if (it == g_runtimeContext->queueTail) {
             break;
         }
 	}
     return false;
 }
 void removeTasksFromQueueForFlowState(FlowState *flowState) {
-	if (g_queueHead == g_queueTail && !g_queueIsFull) {
+	if (g_runtimeContext->queueHead == g_runtimeContext->queueTail && !g_runtimeContext->queueIsFull) {
 		return;
 	}
-    unsigned int it = g_queueHead;
+    unsigned int it = g_runtimeContext->queueHead;
     while (true) {
-		if (g_queue[it].flowState == flowState) {
-            g_queue[it].flowState = 0;
+		if (g_runtimeContext->queue[it].flowState == flowState) {
+            g_runtimeContext->queue[it].flowState = 0;
 		}
         it = (it + 1) % QUEUE_SIZE;
-        if (it == g_queueTail) {
+        if (it == g_runtimeContext->queueTail) {
             break;
         }
 	}
@@ -9928,78 +12416,804 @@ void removeTasksFromQueueForFlowState(FlowState *flowState) {
 } 
 } 
 // -----------------------------------------------------------------------------
+// flow/runtime_context.cpp
+// -----------------------------------------------------------------------------
+namespace eez {
+namespace flow {
+static void initRuntimeContext(RuntimeContext *runtimeContext) {
+    runtimeContext->loadedAssets = nullptr;
+    runtimeContext->loadedAssetsMemory = nullptr;
+    runtimeContext->loadedAssetsAreMutable = false;
+#if EEZ_FLOW_SNAPSHOT
+    runtimeContext->loadedAssetsCrc32 = 0;
+#endif
+    runtimeContext->numLazyAssetsSections = 0;
+    runtimeContext->releasedAssets = nullptr;
+    runtimeContext->releasedAssetsMemory = nullptr;
+    runtimeContext->mainAssets = nullptr;
+    runtimeContext->mainAssetsMemory = nullptr;
+    runtimeContext->pendingAssets = nullptr;
+    runtimeContext->pendingAssetsMemory = nullptr;
+    runtimeContext->previousAssets = nullptr;
+    runtimeContext->previousAssetsMemory = nullptr;
+#if EEZ_FLOW_SNAPSHOT
+    runtimeContext->mainAssetsCrc32 = 0;
+    runtimeContext->pendingAssetsCrc32 = 0;
+#endif
+    runtimeContext->firstFlowState = nullptr;
+    runtimeContext->lastFlowState = nullptr;
+    runtimeContext->firstFlowStateScheduledForDeletion = nullptr;
+    runtimeContext->globalVariables = nullptr;
+    runtimeContext->selectedLanguage = 0;
+    runtimeContext->translationsAssets = nullptr;
+    runtimeContext->translations = Value();
+    runtimeContext->isStopping = false;
+    runtimeContext->skipStartActions = false;
+    runtimeContext->skipComponentPings = false;
+    runtimeContext->isStopped = true;
+    runtimeContext->tickMaxDurationCount = 0;
+    runtimeContext->enableThrowError = true;
+    runtimeContext->executeActionFlowState = nullptr;
+    runtimeContext->executeActionComponentIndex = 0;
+    runtimeContext->queueHead = 0;
+    runtimeContext->queueTail = 0;
+    runtimeContext->queueMax = 0;
+    runtimeContext->queueIsFull = false;
+    runtimeContext->numNonContinuousTaskInQueue = 0;
+    runtimeContext->watchList.first = nullptr;
+    runtimeContext->watchList.last = nullptr;
+    runtimeContext->watchList.size = 0;
+    runtimeContext->watchList.numAlwaysVisited = 0;
+    runtimeContext->watchList.dirtyMask = 0;
+    runtimeContext->numCoalescedEvents = 0;
+    for (unsigned i = 0; i < EEZ_FLOW_NATIVE_VAR_CACHE_SIZE; i++) {
+        runtimeContext->nativeVarCache[i].id = -1;
+        runtimeContext->nativeVarCache[i].epoch = 0;
+    }
+    runtimeContext->nativeVarCacheEpoch = 1;
+    runtimeContext->nativeVarsBatchFetched = false;
+    runtimeContext->numNativeVarWrites = 0;
+    runtimeContext->debuggerIsConnected = false;
+    runtimeContext->messageSubsciptionFilter = 0xFFFFFFFF;
+    runtimeContext->numDebuggerFlowFilters = 0;
+    runtimeContext->debuggerState = DEBUGGER_STATE_RESUMED;
+    runtimeContext->skipNextBreakpoint = false;
+    runtimeContext->stepGateArmed = false;
+    runtimeContext->breakpoints = nullptr;
+    runtimeContext->numArmedBreakpoints = 0;
+    runtimeContext->inputFromDebuggerPosition = 0;
+    runtimeContext->debuggerMode = DEBUGGER_MODE_RUN;
+#if EEZ_FLOW_TRACE
+    runtimeContext->traceEnabled = false;
+    runtimeContext->traceTimestampFrequency = 1000;
+    runtimeContext->traceHead = 0;
+#endif
+    runtimeContext->outputBufferHead.store(0, std::memory_order_relaxed);
+    runtimeContext->outputBufferTail.store(0, std::memory_order_relaxed);
+    runtimeContext->outputBufferWritePosition = 0;
+    runtimeContext->logBufferHead = 0;
+    runtimeContext->logBufferTail = 0;
+    runtimeContext->numPendingFlowStateDestroyedRecords = 0;
+    runtimeContext->logLevel = LOG_ITEM_TYPE_DEBUG;
+    runtimeContext->debuggerValueRateLimit = 0;
+    runtimeContext->debuggerComponentRateLimit = 0;
+    runtimeContext->numDebuggerRateLimits = 0;
+    for (unsigned i = 0; i < EEZ_FLOW_DEBUGGER_SAMPLES_SIZE; i++) {
+        runtimeContext->debuggerSamples[i].key = nullptr;
+        runtimeContext->debuggerSamples[i].pending = false;
+    }
+    runtimeContext->numPendingDebuggerSamples = 0;
+    runtimeContext->allocHook = nullptr;
+    runtimeContext->freeHook = nullptr;
+#if EEZ_OPTION_THREADS
+    inboundQueueInit(runtimeContext->inboundQueue);
+#endif
+#if EEZ_FLOW_INLINE_ACTIONS
+    runtimeContext->inlinableActionFlows = nullptr;
+    runtimeContext->inlineFrameArenaPosition = 0;
+#endif
+}
+struct DefaultRuntimeContext : public RuntimeContext {
+    DefaultRuntimeContext() {
+        initRuntimeContext(this);
+    }
+};
+static EXTRAM_DATA DefaultRuntimeContext g_defaultRuntimeContext;
+EEZ_FLOW_THREAD_LOCAL RuntimeContext *g_runtimeContext = &g_defaultRuntimeContext;
+RuntimeContext *createRuntimeContext(void *(*allocHook)(size_t size, uint32_t id), void (*freeHook)(void *ptr)) {
+    if (!allocHook != !freeHook) {
+        return nullptr;
+    }
+    auto ptr = allocHook ? allocHook(sizeof(RuntimeContext), 0x1f3a62c0) : alloc(sizeof(RuntimeContext), 0x1f3a62c0);
+    if (!ptr) {
+        return nullptr;
+    }
+    auto runtimeContext = new (ptr) RuntimeContext;
+    initRuntimeContext(runtimeContext);
+    runtimeContext->allocHook = allocHook;
+    runtimeContext->freeHook = freeHook;
+    return runtimeContext;
+}
+void destroyRuntimeContext(RuntimeContext *runtimeContext) {
+    if (!runtimeContext || runtimeContext == &g_defaultRuntimeContext) {
+        return;
+    }
+    auto previousRuntimeContext = g_runtimeContext;
+    g_runtimeContext = runtimeContext;
+    unloadMainAssets();
+    g_runtimeContext = previousRuntimeContext == runtimeContext ? &g_defaultRuntimeContext : previousRuntimeContext;
+    auto freeHook = runtimeContext->freeHook;
+    runtimeContext->~RuntimeContext();
+    if (freeHook) {
+        freeHook(runtimeContext);
+    } else {
+        free(runtimeContext);
+    }
+}
+void setRuntimeContext(RuntimeContext *runtimeContext) {
+    g_runtimeContext = runtimeContext ? runtimeContext : &g_defaultRuntimeContext;
+}
+RuntimeContext *getRuntimeContext() {
+    return g_runtimeContext;
+}
+} 
+} 
+// -----------------------------------------------------------------------------
+// flow/snapshot.cpp
+// -----------------------------------------------------------------------------
+namespace eez {
+namespace flow {
+#if EEZ_FLOW_SNAPSHOT
+static const uint32_t SNAPSHOT_NO_PARENT = 0xFFFFFFFF;
+static const uint32_t SNAPSHOT_END_OF_STATES = 0xFFFFFFFF;
+enum SnapshotValueTag {
+    SNAPSHOT_VALUE_KEEP,
+    SNAPSHOT_VALUE_PLAIN,
+    SNAPSHOT_VALUE_STRING,
+    SNAPSHOT_VALUE_ARRAY,
+    SNAPSHOT_VALUE_BLOB
+};
+static bool isPlainValueType(uint8_t type) {
+    switch (type) {
+    case VALUE_TYPE_UNDEFINED:
+    case VALUE_TYPE_NULL:
+    case VALUE_TYPE_BOOLEAN:
+    case VALUE_TYPE_INT8:
+    case VALUE_TYPE_UINT8:
+    case VALUE_TYPE_INT16:
+    case VALUE_TYPE_UINT16:
+    case VALUE_TYPE_INT32:
+    case VALUE_TYPE_UINT32:
+    case VALUE_TYPE_INT64:
+    case VALUE_TYPE_UINT64:
+    case VALUE_TYPE_FLOAT:
+    case VALUE_TYPE_DOUBLE:
+    case VALUE_TYPE_DATE:
+    case VALUE_TYPE_ERROR:
+    case VALUE_TYPE_RANGE:
+    case VALUE_TYPE_ENUM:
+    case VALUE_TYPE_IP_ADDRESS:
+    case VALUE_TYPE_TIME_ZONE:
+        return true;
+    }
+    return false;
+}
+void SnapshotWriter::write(const void *data, uint32_t size) {
+    if (buffer && position + size <= bufferSize) {
+        memcpy(buffer + position, data, size);
+    }
+    position += size;
+}
+void SnapshotWriter::patchUint32(uint32_t atPosition, uint32_t value) {
+    if (buffer && atPosition + sizeof(value) <= bufferSize) {
+        memcpy(buffer + atPosition, &value, sizeof(value));
+    }
+}
+void SnapshotWriter::writeValue(const Value &value) {
+    if (isPlainValueType(value.type)) {
+        writeUint8(SNAPSHOT_VALUE_PLAIN);
+        write(&value.type, sizeof(value.type));
+        write(&value.unit, sizeof(value.unit));
+        write(&value.options, sizeof(value.options));
+        write(&value.dstValueType, sizeof(value.dstValueType));
+        write(&value.uint64Value, sizeof(value.uint64Value));
+    } else if (value.type == VALUE_TYPE_STRING || value.type == VALUE_TYPE_STRING_ASSET || value.type == VALUE_TYPE_STRING_REF) {
+        const char *str = value.getString();
+        uint32_t length = str ? strlen(str) : 0;
+        writeUint8(SNAPSHOT_VALUE_STRING);
+        writeUint32(length);
+        write(str, length);
+    } else if (value.type == VALUE_TYPE_ARRAY || value.type == VALUE_TYPE_ARRAY_ASSET || value.type == VALUE_TYPE_ARRAY_REF) {
+        auto array = value.getArray();
+        writeUint8(SNAPSHOT_VALUE_ARRAY);
+        writeUint32(array->arraySize);
+        writeUint32(array->arrayType);
+        for (uint32_t i = 0; i < array->arraySize; i++) {
+            writeValue(array->values[i]);
+        }
+    } else if (value.type == VALUE_TYPE_BLOB_REF) {
+        auto blobRef = value.getBlob();
+        writeUint8(SNAPSHOT_VALUE_BLOB);
+        writeUint32(blobRef->len);
+        write(blobRef->blob, blobRef->len);
+    } else {
+        writeUint8(SNAPSHOT_VALUE_KEEP);
+    }
+}
+const uint8_t *SnapshotReader::read(uint32_t size) {
+    if (error || size > bufferSize - position) {
+        error = true;
+        return nullptr;
+    }
+    auto data = buffer + position;
+    position += size;
+    return data;
+}
+uint8_t SnapshotReader::readUint8() {
+    auto data = read(1);
+    return data ? *data : 0;
+}
+uint32_t SnapshotReader::readUint32() {
+    uint32_t value = 0;
+    auto data = read(sizeof(value));
+    if (data) {
+        memcpy(&value, data, sizeof(value));
+    }
+    return value;
+}
+void SnapshotReader::readValue(Value &value) {
+    auto tag = readUint8();
+    if (error) {
+        return;
+    }
+    if (tag == SNAPSHOT_VALUE_KEEP) {
+        return;
+    }
+    if (tag == SNAPSHOT_VALUE_PLAIN) {
+        auto data = read(16);
+        if (!data || !isPlainValueType(data[0])) {
+            error = true;
+            return;
+        }
+        if (construct) {
+            Value plainValue;
+            plainValue.type = data[0];
+            plainValue.unit = data[1];
+            memcpy(&plainValue.options, data + 2, sizeof(plainValue.options));
+            memcpy(&plainValue.dstValueType, data + 4, sizeof(plainValue.dstValueType));
+            memcpy(&plainValue.uint64Value, data + 8, sizeof(plainValue.uint64Value));
+            value = plainValue;
+        }
+    } else if (tag == SNAPSHOT_VALUE_STRING) {
+        auto length = readUint32();
+        auto data = read(length);
+        if (data && construct) {
+            value = Value::makeStringRef((const char *)data, length, 0x3a5e91c2);
+        }
+    } else if (tag == SNAPSHOT_VALUE_ARRAY) {
+        auto arraySize = readUint32();
+        auto arrayType = readUint32();
+        if (error || arraySize > bufferSize - position) {
+            error = true;
+            return;
+        }
+        Value arrayValue = construct ? Value::makeArrayRef(arraySize, arrayType, 0x7d0c44b9) : Value();
+        ArrayValue *array = arrayValue.isArray() ? arrayValue.getArray() : nullptr;
+        for (uint32_t i = 0; i < arraySize && !error; i++) {
+            if (array) {
+                readValue(array->values[i]);
+            } else {
+                Value elementValue;
+                readValue(elementValue);
+            }
+        }
+        if (construct) {
+            value = arrayValue;
+        }
+    } else if (tag == SNAPSHOT_VALUE_BLOB) {
+        auto length = readUint32();
+        auto data = read(length);
+        if (data && construct) {
+            value = Value::makeBlobRef(data, length, 0x1b6f02e8);
+        }
+    } else {
+        error = true;
+    }
+}
+static uint32_t getAssetsFingerprint(Assets *assets) {
+    if (g_runtimeContext->mainAssetsCrc32) {
+        return g_runtimeContext->mainAssetsCrc32;
+    }
+	auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
+    uint32_t fingerprint = 2166136261u;
+    fingerprint = (fingerprint ^ flowDefinition->globalVariables.count) * 16777619u;
+    for (uint32_t i = 0; i < flowDefinition->flows.count; i++) {
+        auto flow = flowDefinition->flows[i];
+        fingerprint = (fingerprint ^ flow->components.count) * 16777619u;
+        fingerprint = (fingerprint ^ flow->componentInputs.count) * 16777619u;
+        fingerprint = (fingerprint ^ flow->localVariables.count) * 16777619u;
+    }
+    return fingerprint;
+}
+static uint32_t getNumFlowStateValues(FlowState *flowState) {
+    return flowState->flow->componentInputs.count + flowState->flow->localVariables.count;
+}
+static uint32_t countSnapshotFlowStates(FlowState *firstFlowState) {
+    uint32_t count = 0;
+    for (auto flowState = firstFlowState; flowState; flowState = flowState->nextSibling) {
+        if (!flowState->deleteOnNextTick) {
+            count += 1 + countSnapshotFlowStates(flowState->firstChild);
+        }
+    }
+    return count;
+}
+static bool findSnapshotFlowStateOrdinal(FlowState *firstFlowState, FlowState *target, uint32_t &ordinal) {
+    for (auto flowState = firstFlowState; flowState; flowState = flowState->nextSibling) {
+        if (flowState->deleteOnNextTick) {
+            continue;
+        }
+        if (flowState == target) {
+            return true;
+        }
+        ordinal++;
+        if (findSnapshotFlowStateOrdinal(flowState->firstChild, target, ordinal)) {
+            return true;
+        }
+    }
+    return false;
+}
+static void saveFlowStates(SnapshotWriter &writer, FlowState *firstFlowState, uint32_t parentOrdinal, uint32_t &ordinal) {
+    for (auto flowState = firstFlowState; flowState; flowState = flowState->nextSibling) {
+        if (flowState->deleteOnNextTick) {
+            continue;
+        }
+        uint32_t flowStateOrdinal = ordinal++;
+        writer.writeUint32(parentOrdinal);
+        writer.writeUint32((uint32_t)flowState->parentComponentIndex);
+        writer.writeUint32(flowState->flowIndex);
+        writer.writeUint8(flowState->isAction ? 1 : 0);
+        writer.writeUint8(flowState->error ? 1 : 0);
+        writer.write(&flowState->timelinePosition, sizeof(flowState->timelinePosition));
+        writer.writeUint32((uint32_t)flowState->lvglWidgetStartIndex);
+        writer.writeValue(flowState->inputValue);
+        uint32_t numValues = getNumFlowStateValues(flowState);
+        writer.writeUint32(numValues);
+        for (uint32_t i = 0; i < numValues; i++) {
+            writer.writeValue(flowState->values[i]);
+        }
+        for (uint32_t componentIndex = 0; componentIndex < flowState->flow->components.count; componentIndex++) {
+            auto executionState = flowState->componenentExecutionStates[componentIndex];
+            if (!executionState) {
+                continue;
+            }
+            auto recordPosition = writer.position;
+            writer.writeUint32(componentIndex);
+            writer.writeUint32(0);
+            auto payloadPosition = writer.position;
+            if (executionState->saveSnapshot(writer)) {
+                writer.patchUint32(payloadPosition - sizeof(uint32_t), writer.position - payloadPosition);
+            } else {
+                writer.position = recordPosition;
+            }
+        }
+        writer.writeUint32(SNAPSHOT_END_OF_STATES);
+        saveFlowStates(writer, flowState->firstChild, flowStateOrdinal, ordinal);
+    }
+}
+static void saveSnapshot(SnapshotWriter &writer) {
+    auto assets = g_runtimeContext->mainAssets;
+    writer.writeUint32(SNAPSHOT_MAGIC);
+    writer.writeUint32(SNAPSHOT_VERSION);
+    writer.writeUint32(getAssetsFingerprint(assets));
+	auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
+    writer.writeUint32(flowDefinition->globalVariables.count);
+    for (uint32_t i = 0; i < flowDefinition->globalVariables.count; i++) {
+        writer.writeValue(getGlobalVariable(i));
+    }
+    writer.writeUint32(countSnapshotFlowStates(g_runtimeContext->firstFlowState));
+    uint32_t ordinal = 0;
+    saveFlowStates(writer, g_runtimeContext->firstFlowState, SNAPSHOT_NO_PARENT, ordinal);
+    auto numTasksPosition = writer.position;
+    writer.writeUint32(0);
+    uint32_t numTasks = 0;
+    size_t queueSize = getQueueSize();
+    for (size_t i = 0; i < queueSize; i++) {
+        auto &task = g_runtimeContext->queue[(g_runtimeContext->queueHead + i) % QUEUE_SIZE];
+        uint32_t flowStateOrdinal = 0;
+        if (!task.flowState || !findSnapshotFlowStateOrdinal(g_runtimeContext->firstFlowState, task.flowState, flowStateOrdinal)) {
+            continue;
+        }
+        writer.writeUint32(flowStateOrdinal);
+        writer.writeUint32(task.componentIndex);
+        writer.writeUint8(task.continuousTask ? 1 : 0);
+        numTasks++;
+    }
+    writer.patchUint32(numTasksPosition, numTasks);
+}
+uint32_t getSnapshotSize() {
+    if (isFlowStopped() || !g_runtimeContext->mainAssets) {
+        return 0;
+    }
+    SnapshotWriter writer = { nullptr, 0, 0 };
+    saveSnapshot(writer);
+    return writer.position;
+}
+uint32_t saveSnapshot(uint8_t *buffer, uint32_t bufferSize) {
+    if (isFlowStopped() || !g_runtimeContext->mainAssets) {
+        return 0;
+    }
+    SnapshotWriter writer = { buffer, bufferSize, 0 };
+    saveSnapshot(writer);
+    return writer.position <= bufferSize ? writer.position : 0;
+}
+struct SnapshotFlowStateEntry {
+    FlowState *flowState;
+    uint16_t flowIndex;
+};
+static FlowState *restoreFlowState(Assets *assets, FlowState *parentFlowState, int parentComponentIndex, int flowIndex, bool isAction, const Value &inputValue) {
+    if (!parentFlowState) {
+        return initPageFlowState(assets, flowIndex, nullptr, 0);
+    }
+    if (isAction) {
+        return initActionFlowState(flowIndex, parentFlowState, parentComponentIndex, inputValue);
+    }
+    if (parentFlowState->flow->components[parentComponentIndex]->type == defs_v3::COMPONENT_TYPE_LVGL_USER_WIDGET_WIDGET) {
+        return createUserWidgetFlowState(parentFlowState, parentComponentIndex)->flowState;
+    }
+    return initPageFlowState(assets, flowIndex, parentFlowState, parentComponentIndex);
+}
+static void loadSnapshot(SnapshotReader &reader, Assets *assets) {
+	auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
+    if (
+        reader.readUint32() != SNAPSHOT_MAGIC ||
+        reader.readUint32() != SNAPSHOT_VERSION ||
+        reader.readUint32() != getAssetsFingerprint(assets) ||
+        reader.readUint32() != flowDefinition->globalVariables.count
+    ) {
+        reader.error = true;
+        return;
+    }
+    for (uint32_t i = 0; i < flowDefinition->globalVariables.count && !reader.error; i++) {
+        Value value = reader.construct ? getGlobalVariable(i) : Value();
+        reader.readValue(value);
+        if (reader.construct && !reader.error) {
+            setGlobalVariable(i, value);
+        }
+    }
+    auto numFlowStates = reader.readUint32();
+    if (reader.error || numFlowStates > reader.bufferSize - reader.position) {
+        reader.error = true;
+        return;
+    }
+    SnapshotFlowStateEntry *entries = nullptr;
+    if (numFlowStates > 0) {
+        entries = (SnapshotFlowStateEntry *)alloc(numFlowStates * sizeof(SnapshotFlowStateEntry), 0x58e1d7a3);
+        if (!entries) {
+            reader.error = true;
+            return;
+        }
+    }
+    for (uint32_t ordinal = 0; ordinal < numFlowStates && !reader.error; ordinal++) {
+        auto parentOrdinal = reader.readUint32();
+        auto parentComponentIndex = (int)reader.readUint32();
+        auto flowIndex = reader.readUint32();
+        bool isAction = reader.readUint8() != 0;
+        bool hasError = reader.readUint8() != 0;
+        float timelinePosition = 0;
+        auto timelinePositionData = reader.read(sizeof(timelinePosition));
+        if (timelinePositionData) {
+            memcpy(&timelinePosition, timelinePositionData, sizeof(timelinePosition));
+        }
+        auto lvglWidgetStartIndex = (int32_t)reader.readUint32();
+        Value inputValue;
+        reader.readValue(inputValue);
+        if (reader.error || flowIndex >= flowDefinition->flows.count) {
+            reader.error = true;
+            break;
+        }
+        if (parentOrdinal != SNAPSHOT_NO_PARENT) {
+            if (
+                parentOrdinal >= ordinal ||
+                parentComponentIndex < 0 ||
+                (uint32_t)parentComponentIndex >= flowDefinition->flows[entries[parentOrdinal].flowIndex]->components.count
+            ) {
+                reader.error = true;
+                break;
+            }
+        }
+        auto flow = flowDefinition->flows[flowIndex];
+        FlowState *flowState = nullptr;
+        if (reader.construct) {
+            flowState = restoreFlowState(
+                assets,
+                parentOrdinal != SNAPSHOT_NO_PARENT ? entries[parentOrdinal].flowState : nullptr,
+                parentComponentIndex,
+                flowIndex,
+                isAction,
+                inputValue
+            );
+            if (!flowState) {
+                reader.error = true;
+                break;
+            }
+            flowState->error = hasError;
+            flowState->timelinePosition = timelinePosition;
+            flowState->lvglWidgetStartIndex = lvglWidgetStartIndex;
+        }
+        entries[ordinal].flowState = flowState;
+        entries[ordinal].flowIndex = (uint16_t)flowIndex;
+        auto numValues = reader.readUint32();
+        if (numValues != flow->componentInputs.count + flow->localVariables.count) {
+            reader.error = true;
+            break;
+        }
+        for (uint32_t i = 0; i < numValues && !reader.error; i++) {
+            if (flowState) {
+                reader.readValue(flowState->values[i]);
+            } else {
+                Value value;
+                reader.readValue(value);
+            }
+        }
+        while (!reader.error) {
+            auto componentIndex = reader.readUint32();
+            if (componentIndex == SNAPSHOT_END_OF_STATES) {
+                break;
+            }
+            auto length = reader.readUint32();
+            if (reader.error || componentIndex >= flow->components.count || length > reader.bufferSize - reader.position) {
+                reader.error = true;
+                break;
+            }
+            auto payloadEnd = reader.position + length;
+            if (flowState) {
+                SnapshotReader stateReader = { reader.buffer, payloadEnd, reader.position, true, false };
+                restoreComponentExecutionState(flowState, componentIndex, stateReader);
+            }
+            reader.position = payloadEnd;
+        }
+    }
+    auto numTasks = reader.readUint32();
+    for (uint32_t i = 0; i < numTasks && !reader.error; i++) {
+        auto flowStateOrdinal = reader.readUint32();
+        auto componentIndex = reader.readUint32();
+        bool continuousTask = reader.readUint8() != 0;
+        if (
+            reader.error ||
+            flowStateOrdinal >= numFlowStates ||
+            componentIndex >= flowDefinition->flows[entries[flowStateOrdinal].flowIndex]->components.count
+        ) {
+            reader.error = true;
+            break;
+        }
+        if (reader.construct) {
+            addToQueue(entries[flowStateOrdinal].flowState, componentIndex, -1, -1, -1, continuousTask);
+        }
+    }
+    if (entries) {
+        free(entries);
+    }
+}
+bool restoreSnapshot(const uint8_t *buffer, uint32_t bufferSize) {
+    auto assets = g_runtimeContext->mainAssets;
+    if (!assets || isFlowStopped() || g_runtimeContext->firstFlowState) {
+        return false;
+    }
+    SnapshotReader validator = { buffer, bufferSize, 0, false, false };
+    loadSnapshot(validator, assets);
+    if (validator.error) {
+        return false;
+    }
+    SnapshotReader reader = { buffer, bufferSize, 0, true, false };
+    g_runtimeContext->skipComponentPings = true;
+    loadSnapshot(reader, assets);
+    g_runtimeContext->skipComponentPings = false;
+    return !reader.error;
+}
+#endif
+} 
+} 
+// -----------------------------------------------------------------------------
+// flow/trace.cpp
+// -----------------------------------------------------------------------------
+namespace eez {
+namespace flow {
+#if EEZ_FLOW_TRACE
+void startTrace(uint32_t timestampFrequency) {
+    g_runtimeContext->traceTimestampFrequency = timestampFrequency;
+    g_runtimeContext->traceHead = 0;
+    g_runtimeContext->traceEnabled = true;
+}
+void stopTrace() {
+    g_runtimeContext->traceEnabled = false;
+}
+bool isTraceEnabled() {
+    return g_runtimeContext->traceEnabled;
+}
+void traceEvent(TraceEventType type, FlowState *flowState, int componentIndex, uint32_t data) {
+    auto &event = g_runtimeContext->traceEvents[g_runtimeContext->traceHead & (TRACE_BUFFER_SIZE - 1)];
+    event.timestamp = getTraceTimestampHook();
+    event.flowStateIndex = flowState ? flowState->flowStateIndex : 0xFFFFFFFF;
+    event.componentIndex = (uint16_t)componentIndex;
+    event.type = (uint8_t)type;
+    event.reserved = 0;
+    size_t queueDepth = getQueueSize();
+    event.queueDepth = queueDepth < 0xFFFF ? (uint16_t)queueDepth : 0xFFFF;
+    event.reserved2 = 0;
+    event.data = data;
+    g_runtimeContext->traceHead++;
+}
+static uint32_t getNumTraceEvents() {
+    return g_runtimeContext->traceHead < TRACE_BUFFER_SIZE ? g_runtimeContext->traceHead : TRACE_BUFFER_SIZE;
+}
+uint32_t getTraceDumpSize() {
+    return sizeof(TraceDumpHeader) + getNumTraceEvents() * sizeof(TraceEvent);
+}
+uint32_t dumpTrace(uint8_t *buffer, uint32_t bufferSize) {
+    if (bufferSize < sizeof(TraceDumpHeader)) {
+        return 0;
+    }
+    uint32_t numEvents = getNumTraceEvents();
+    uint32_t maxEvents = (bufferSize - sizeof(TraceDumpHeader)) / sizeof(TraceEvent);
+    if (numEvents > maxEvents) {
+        numEvents = maxEvents;
+    }
+    TraceDumpHeader header;
+    header.magic = TRACE_DUMP_MAGIC;
+    header.version = TRACE_DUMP_VERSION;
+    header.eventSize = sizeof(TraceEvent);
+    header.timestampFrequency = g_runtimeContext->traceTimestampFrequency;
+    header.numEvents = numEvents;
+    header.numDroppedEvents = g_runtimeContext->traceHead - numEvents;
+    memcpy(buffer, &header, sizeof(TraceDumpHeader));
+    uint8_t *p = buffer + sizeof(TraceDumpHeader);
+    for (uint32_t i = g_runtimeContext->traceHead - numEvents; i != g_runtimeContext->traceHead; i++) {
+        memcpy(p, &g_runtimeContext->traceEvents[i & (TRACE_BUFFER_SIZE - 1)], sizeof(TraceEvent));
+        p += sizeof(TraceEvent);
+    }
+    return p - buffer;
+}
+#endif
+} 
+} 
+// -----------------------------------------------------------------------------
 // flow/watch_list.cpp
 // -----------------------------------------------------------------------------
 namespace eez {
 namespace flow {
 void executeWatchVariableComponent(FlowState *flowState, unsigned componentIndex);
+static const uint32_t WATCH_LOCAL_VARIABLES_MASK = 1u << 31;
+static const uint32_t WATCH_ALL_MASK = 0xFFFFFFFF;
 struct WatchListNode {
     FlowState *flowState;
     unsigned componentIndex;
+    uint32_t dependencyMask;
+    bool alwaysVisit;
     WatchListNode *prev;
     WatchListNode *next;
 };
-struct WatchList {
-    WatchListNode *first;
-    WatchListNode *last;
-    unsigned       size;
-};
-static WatchList g_watchList;
+static inline uint32_t getGlobalVariableWatchMask(uint32_t globalVariableIndex) {
+    return 1u << (globalVariableIndex % 31);
+}
+static bool isVolatileOperation(uint16_t operation) {
+    switch (operation) {
+    case defs_v3::OPERATION_TYPE_SYSTEM_GET_TICK:
+    case defs_v3::OPERATION_TYPE_FLOW_IS_PAGE_ACTIVE:
+    case defs_v3::OPERATION_TYPE_FLOW_PAGE_TIMELINE_POSITION:
+    case defs_v3::OPERATION_TYPE_FLOW_LANGUAGES:
+    case defs_v3::OPERATION_TYPE_FLOW_TRANSLATE:
+    case defs_v3::OPERATION_TYPE_DATE_NOW:
+    case defs_v3::OPERATION_TYPE_LVGL_METER_TICK_INDEX:
+    case defs_v3::OPERATION_TYPE_JSON_GET:
+        return true;
+    default:
+        return operation >= defs_v3::OPERATION_TYPE_FLOW_THEMES;
+    }
+}
+static bool getWatchDependencies(FlowState *flowState, unsigned componentIndex, uint32_t &dependencyMask) {
+    auto flowDefinition = static_cast<FlowDefinition *>(flowState->assets->flowDefinition);
+    auto component = flowState->flow->components[componentIndex];
+    auto instructions = component->properties[defs_v3::WATCH_VARIABLE_ACTION_COMPONENT_PROPERTY_VARIABLE]->evalInstructions;
+    dependencyMask = 0;
+    for (int i = 0; ; i += 2) {
+		uint16_t instruction = instructions[i] + (instructions[i + 1] << 8);
+		auto instructionType = instruction & EXPR_EVAL_INSTRUCTION_TYPE_MASK;
+		auto instructionArg = instruction & EXPR_EVAL_INSTRUCTION_PARAM_MASK;
+        if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_INPUT) {
+            return false;
+        } else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_LOCAL_VAR) {
+            if ((uint32_t)instructionArg < flowState->flow->userPropertiesAssignable.count) {
+                return false;
+            }
+            dependencyMask |= WATCH_LOCAL_VARIABLES_MASK;
+        } else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_GLOBAL_VAR) {
+            if ((uint32_t)instructionArg >= flowDefinition->globalVariables.count) {
+                return false;
+            }
+            dependencyMask |= getGlobalVariableWatchMask(instructionArg);
+        } else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_OPERATION) {
+            if (isVolatileOperation(instructionArg)) {
+                return false;
+            }
+        } else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_END) {
+            return true;
+        }
+    }
+}
 WatchListNode *watchListAdd(FlowState *flowState, unsigned componentIndex) {
     auto node = (WatchListNode *)alloc(sizeof(WatchListNode), 0x00864d67);
-    node->prev = g_watchList.last;
-    if (g_watchList.last != 0) {
-        g_watchList.last->next = node;
+    node->prev = g_runtimeContext->watchList.last;
+    if (g_runtimeContext->watchList.last != 0) {
+        g_runtimeContext->watchList.last->next = node;
     }
-    g_watchList.last = node;
-    if (g_watchList.first == 0) {
-        g_watchList.first = node;
+    g_runtimeContext->watchList.last = node;
+    if (g_runtimeContext->watchList.first == 0) {
+        g_runtimeContext->watchList.first = node;
     }
     node->next = 0;
     node->flowState = flowState;
     node->componentIndex = componentIndex;
+    node->alwaysVisit = !getWatchDependencies(flowState, componentIndex, node->dependencyMask) || flowState->isAction;
+    if (node->alwaysVisit) {
+        g_runtimeContext->watchList.numAlwaysVisited++;
+    }
     incRefCounterForFlowState(flowState);
-    (g_watchList.size)++;
+    (g_runtimeContext->watchList.size)++;
     return node;
 }
 void watchListRemove(WatchListNode *node) {
     if (node->prev) {
         node->prev->next = node->next;
     } else {
-        g_watchList.first = node->next;
+        g_runtimeContext->watchList.first = node->next;
     }
     if (node->next) {
         node->next->prev = node->prev;
     } else {
-        g_watchList.last = node->prev;
+        g_runtimeContext->watchList.last = node->prev;
+    }
+    if (node->alwaysVisit) {
+        g_runtimeContext->watchList.numAlwaysVisited--;
     }
     free(node);
-    g_watchList.size > 0 ? (g_watchList.size)-- : 0;
+    g_runtimeContext->watchList.size > 0 ? (g_runtimeContext->watchList.size)-- : 0;
 }
 void visitWatchList() {
-    for (auto node = g_watchList.first; node; ) {
+    auto dirtyMask = g_runtimeContext->debuggerIsConnected ? WATCH_ALL_MASK : g_runtimeContext->watchList.dirtyMask;
+    if (!dirtyMask && !g_runtimeContext->watchList.numAlwaysVisited) {
+        return;
+    }
+    g_runtimeContext->watchList.dirtyMask = 0;
+    for (auto node = g_runtimeContext->watchList.first; node; ) {
         auto nextNode = node->next;
-        if (canExecuteStep(node->flowState, node->componentIndex)) {
-            executeWatchVariableComponent(node->flowState, node->componentIndex);
+        if (node->alwaysVisit || (node->dependencyMask & dirtyMask)) {
+            if (canExecuteStep(node->flowState, node->componentIndex)) {
+                executeWatchVariableComponent(node->flowState, node->componentIndex);
+            } else {
+                g_runtimeContext->watchList.dirtyMask |= node->dependencyMask;
+            }
         }
-        decRefCounterForFlowState(node->flowState);
-        if (canFreeFlowState(node->flowState)) {
-            freeFlowState(node->flowState);
-        } else {
-            incRefCounterForFlowState(node->flowState);
+        if (node->flowState->isAction) {
+            decRefCounterForFlowState(node->flowState);
+            if (canFreeFlowState(node->flowState)) {
+                freeFlowState(node->flowState);
+            } else {
+                incRefCounterForFlowState(node->flowState);
+            }
         }
         node = nextNode;
     }
 }
 void watchListReset() {
-    for (auto node = g_watchList.first; node;) {
+    for (auto node = g_runtimeContext->watchList.first; node;) {
         auto nextNode = node->next;
         watchListRemove(node);
         node = nextNode;
     }
+    g_runtimeContext->watchList.dirtyMask = 0;
 }
 void removeWatchesForFlowState(FlowState *flowState) {
-    for (auto node = g_watchList.first; node;) {
+    for (auto node = g_runtimeContext->watchList.first; node;) {
         auto nextNode = node->next;
         if (node->flowState == flowState) {
             watchListRemove(node);
@@ -10007,8 +13221,21 @@ void removeWatchesForFlowState(FlowState *flowState) {
         node = nextNode;
     }
 }
+void markWatchesDirtyForGlobalVariable(uint32_t globalVariableIndex) {
+    g_runtimeContext->watchList.dirtyMask |= getGlobalVariableWatchMask(globalVariableIndex);
+}
+void markWatchesDirtyForValue(FlowState *flowState, const Value *pValue) {
+    auto globalVariables = g_runtimeContext->globalVariables;
+    if (globalVariables && pValue >= globalVariables->values && pValue < globalVariables->values + globalVariables->count) {
+        markWatchesDirtyForGlobalVariable((uint32_t)(pValue - globalVariables->values));
+    } else if (pValue >= flowState->values && pValue < flowState->values + flowState->flow->componentInputs.count + flowState->flow->localVariables.count) {
+        g_runtimeContext->watchList.dirtyMask |= WATCH_LOCAL_VARIABLES_MASK;
+    } else {
+        g_runtimeContext->watchList.dirtyMask = WATCH_ALL_MASK;
+    }
+}
 unsigned getWatchListSize() {
-    return g_watchList.size;
+    return g_runtimeContext->watchList.size;
 }
 } 
 } 
\ No newline at end of file
@@ -63,6 +63,33 @@
 #ifndef EEZ_FOR_LVGL_SHA256_OPTION
     #define EEZ_FOR_LVGL_SHA256_OPTION 1
 #endif
+#ifndef EEZ_FLOW_MULTI_INSTANCE
+    #define EEZ_FLOW_MULTI_INSTANCE 0
+#endif
+#ifndef EEZ_FLOW_INLINE_ACTIONS
+    #define EEZ_FLOW_INLINE_ACTIONS 0
+#endif
+#ifndef EEZ_FLOW_TRACE
+    #define EEZ_FLOW_TRACE 0
+#endif
+#ifndef EEZ_FLOW_SNAPSHOT
+    #define EEZ_FLOW_SNAPSHOT 0
+#endif
+#ifndef EEZ_FLOW_VERIFY_ASSETS
+    #define EEZ_FLOW_VERIFY_ASSETS 1
+#endif
+#ifndef EEZ_ALLOC_TRACKING
+    #define EEZ_ALLOC_TRACKING 0
+#endif
+#ifndef EEZ_OPTION_ASSETS_ABSOLUTE_POINTERS
+    #define EEZ_OPTION_ASSETS_ABSOLUTE_POINTERS 0
+#endif
+#ifndef EEZ_MAX_LAZY_ASSETS_SECTIONS
+    #define EEZ_MAX_LAZY_ASSETS_SECTIONS 16
+#endif
+#ifndef EEZ_ALLOC_TRACKING_TABLE_SIZE
+    #define EEZ_ALLOC_TRACKING_TABLE_SIZE 128
+#endif
 #define EEZ_UNUSED(x) (void)(x)
 #if defined(__clang__)
     #define DIAG_PRAGMA(x) _Pragma(#x)
@@ -87,6 +114,11 @@
 #ifndef EXTRAM_DATA
 #define EXTRAM_DATA
 #endif
+#if EEZ_OPTION_ASSETS_ABSOLUTE_POINTERS
+    #define EEZ_ASSETS_PTR(field) ((uint8_t *)(uintptr_t)(uint32_t)(field))
+#else
+    #define EEZ_ASSETS_PTR(field) ((uint8_t *)&(field) + (field))
+#endif
 #ifdef __cplusplus
 
 // -----------------------------------------------------------------------------
@@ -222,6 +254,20 @@ template<class T> struct ObjectAllocator {
 	}
 };
 void getAllocInfo(uint32_t &free, uint32_t &alloc);
+#if EEZ_ALLOC_TRACKING
+static const uint32_t ALLOC_TAG_OVERFLOW = 0xFFFFFFFF;
+struct AllocTagInfo {
+    uint32_t id;
+    uint32_t liveCount;
+    uint32_t peakCount;
+    uint32_t liveBytes;
+    uint32_t peakBytes;
+    uint32_t totalCount;
+    uint64_t cumulativeBytes;
+};
+uint32_t getAllocInfo(AllocTagInfo *tagInfos, uint32_t maxTagInfos, uint32_t firstTagInfo = 0);
+void resetAllocTagPeaks();
+#endif
 } 
 // -----------------------------------------------------------------------------
 // flow/flow_defs_v3.h
@@ -882,6 +928,7 @@ struct EnumValue {
     uint16_t enumDefinition;
 };
 #define VALUE_OPTIONS_REF (1 << 0)
+#define VALUE_OPTIONS_SHARED (1 << 15)
 #define STRING_OPTIONS_FILE_ELLIPSIS (1 << 1)
 #define FLOAT_OPTIONS_LESS_THEN (1 << 1)
 #define FLOAT_OPTIONS_FIXED_DECIMALS (1 << 2)
@@ -1029,7 +1076,7 @@ struct Value {
             options = 0;
             DIAG_PUSH
             DIAG_IGNORE("-Wdangling-pointer")
-            strValue = (const char *)((uint8_t *)&value.int32Value + value.int32Value);
+            strValue = (const char *)EEZ_ASSETS_PTR(value.int32Value);
             DIAG_POP
         } else if (value.type == VALUE_TYPE_ARRAY_ASSET) {
             type = VALUE_TYPE_ARRAY;
@@ -1037,7 +1084,7 @@ struct Value {
             options = 0;
             DIAG_PUSH
             DIAG_IGNORE("-Wdangling-pointer")
-            arrayValue = (ArrayValue *)((uint8_t *)&value.int32Value + value.int32Value);
+            arrayValue = (ArrayValue *)EEZ_ASSETS_PTR(value.int32Value);
             DIAG_POP
         } else {
             type = value.type;
@@ -1316,6 +1363,9 @@ struct JsonMemberValue : public Ref {
 };
 Value getVar(int16_t id);
 void setVar(int16_t id, const Value& value);
+void setNativeVarCachedValue(int16_t id, const Value& value);
+void beginNativeVarsTick();
+void flushNativeVarWrites();
 inline Value Value::getValue() const {
     if (type == VALUE_TYPE_VALUE_PTR) {
         return pValueValue->getValue();
@@ -1477,6 +1527,7 @@ void executeActionFunction(int actionId);
 namespace eez {
 static const uint32_t HEADER_TAG = 0x5A45457E; 
 static const uint32_t HEADER_TAG_COMPRESSED = 0x7A65657E; 
+static const uint32_t HEADER_TAG_SECTIONED = 0x535A457E; 
 static const uint8_t PROJECT_VERSION_V2 = 2;
 static const uint8_t PROJECT_VERSION_V3 = 3;
 static const uint8_t ASSETS_TYPE_FIRMWARE = 1;
@@ -1492,16 +1543,48 @@ struct Header {
     uint8_t reserved;
 	uint32_t decompressedSize;
 };
+static const uint16_t ASSETS_SECTION_CORE = 0;
+static const uint16_t ASSETS_SECTION_FLOWS = 1;
+static const uint16_t ASSETS_SECTION_TRANSLATIONS = 2;
+static const uint16_t ASSETS_SECTION_RELOCATIONS = 3;
+static const uint16_t ASSETS_SECTION_LANGUAGE_TRANSLATIONS = 0x100;
+static const uint16_t ASSETS_SECTION_FLAG_LAZY = 1 << 0;
+static const uint16_t ASSETS_SECTION_FLAG_RELOCATIONS = 1 << 1;
+struct AssetsSection {
+    uint16_t id;
+    uint16_t flags;
+    uint32_t offset;
+    uint32_t size;
+    uint32_t compressedOffset;
+    uint32_t compressedSize;
+    uint32_t rootFieldOffset;
+};
+struct AssetsBlock {
+    uint32_t compressedOffset;
+    uint32_t compressedSize;
+};
+struct LazyAssetsSection {
+    const uint8_t *assetsData;
+    uint32_t assetsDataSize;
+    const AssetsSection *section;
+    int32_t rootFieldValue;
+    uint8_t *buffer;
+};
 struct Assets;
-extern Assets *g_mainAssets;
-extern bool g_mainAssetsAreMutable;
+#if EEZ_OPTION_ASSETS_ABSOLUTE_POINTERS
+static_assert(sizeof(void *) == sizeof(int32_t), "absolute assets pointers require 32-bit addresses");
+#endif
 template<typename T>
 struct AssetsPtr {
     AssetsPtr() : offset(0) {}
     AssetsPtr(const AssetsPtr<T> &rhs) = delete;
 	void operator=(T* ptr) {
 		if (ptr != nullptr) {
+#if EEZ_OPTION_ASSETS_ABSOLUTE_POINTERS
+            offset = (int32_t)(uintptr_t)ptr;
+#else
             offset = (uint8_t *)ptr - (uint8_t *)&offset;
+#endif
 		} else {
 			offset = 0;
 		}
@@ -1513,10 +1596,10 @@ struct AssetsPtr {
 private:
     int32_t offset;
     T* ptr() {
-        return offset ? (T *)((uint8_t *)&offset + offset) : nullptr;
+        return offset ? (T *)EEZ_ASSETS_PTR(offset) : nullptr;
     }
 	const T* ptr() const {
-		return offset ? (const T *)((uint8_t *)&offset + offset) : nullptr;
+		return offset ? (const T *)EEZ_ASSETS_PTR(offset) : nullptr;
 	}
 };
 template<typename T>
@@ -1615,6 +1698,7 @@ struct FlowDefinition {
 	ListOfAssetsPtr<Flow> flows;
 	ListOfAssetsPtr<Value> constants;
 	ListOfAssetsPtr<Value> globalVariables;
+    ListOfFundamentalType<uint32_t> globalVariableIds;
 };
 struct Language {
     AssetsPtr<const char> languageID;
@@ -1634,7 +1718,14 @@ struct Assets {
     ListOfAssetsPtr<Language> languages;
 };
 bool decompressAssetsData(const uint8_t *assetsData, uint32_t assetsDataSize, Assets *decompressedAssets, uint32_t maxDecompressedAssetsSize, int *err);
-void loadMainAssets(const uint8_t *assets, uint32_t assetsSize);
+bool loadMainAssets(const uint8_t *assets, uint32_t assetsSize);
+bool loadAssetsSection(Assets *assets, uint16_t sectionId);
+void unloadAssetsSection(Assets *assets, uint16_t sectionId);
+Assets *loadAssets(const uint8_t *assetsData, uint32_t assetsDataSize, uint8_t *&assetsMemory);
+void unloadAssets(uint8_t *assetsMemory);
+uint8_t *releaseMainAssetsMemory();
+void unloadMainAssets();
+extern void (*parallelForHook)(uint32_t count, void (*task)(void *context, uint32_t index), void *context);
 int getThemesCount();
 const char *getThemeName(int i);
 uint32_t getThemeColorsCount(int themeIndex);
@@ -1798,6 +1889,10 @@ void stringAppendPower(char *str, size_t maxStrLength, float value);
 void stringAppendDuration(char *str, size_t maxStrLength, float value);
 void stringAppendLoad(char *str, size_t maxStrLength, float value);
 uint32_t crc32(const uint8_t *message, size_t size);
+uint32_t crc32Init();
+uint32_t crc32Update(uint32_t crc, const uint8_t *message, size_t size);
+uint32_t crc32Final(uint32_t crc);
+extern uint32_t (*crc32UpdateHook)(uint32_t crc, const uint8_t *message, size_t size);
 uint8_t toBCD(uint8_t bin);
 uint8_t fromBCD(uint8_t bcd);
 float roundPrec(float a, float prec);
@@ -1899,7 +1994,6 @@ struct GlobalVariables {
     uint32_t count;
     Value values[1];
 };
-extern struct GlobalVariables *g_globalVariables;
 void initGlobalVariables(Assets *assets);
 static const int UNDEFINED_VALUE_INDEX = 0;
 static const int NULL_VALUE_INDEX = 1;
@@ -1910,11 +2004,25 @@ static const int NULL_VALUE_INDEX = 1;
         component->type == defs_v3::COMPONENT_TYPE_COUNTER_ACTION || \
         component->type == defs_v3::COMPONENT_TYPE_WATCH_VARIABLE_ACTION \
     )
+struct InlineFrame;
+#if EEZ_FLOW_SNAPSHOT
+struct SnapshotWriter;
+#endif
 struct ComponenentExecutionState {
 	virtual ~ComponenentExecutionState() {}
+    virtual bool canMigrate() { return false; }
+    virtual void migrate() {}
+#if EEZ_FLOW_SNAPSHOT
+    virtual bool saveSnapshot(SnapshotWriter &) { return false; }
+#endif
 };
 struct CatchErrorComponenentExecutionState : public ComponenentExecutionState {
 	Value message;
+    bool canMigrate() override { return true; }
+    void migrate() override { message = message.clone(); }
+#if EEZ_FLOW_SNAPSHOT
+    bool saveSnapshot(SnapshotWriter &writer) override;
+#endif
 };
 struct FlowState {
 	Assets *assets;
@@ -1924,6 +2032,7 @@ struct FlowState {
 	bool isAction;
 	bool error;
     bool deleteOnNextTick;
+    bool debuggerAnnounced;
     uint32_t refCounter;
     FlowState *parentFlowState;
 	Component *parentComponent;
@@ -1940,17 +2049,25 @@ struct FlowState {
     FlowState *lastChild;
     FlowState *previousSibling;
     FlowState *nextSibling;
+    FlowState *previousScheduledForDeletion;
+    FlowState *nextScheduledForDeletion;
+    InlineFrame *inlineFrame;
+    uint32_t *breakpoints;
 };
-extern int g_selectedLanguage;
-extern FlowState *g_firstFlowState;
-extern FlowState *g_lastFlowState;
 FlowState *initActionFlowState(int flowIndex, FlowState *parentFlowState, int parentComponentIndex, const Value &value);
+#if EEZ_FLOW_INLINE_ACTIONS
+FlowState *initInlineActionFlowState(int flowIndex, FlowState *parentFlowState, int parentComponentIndex, const Value &value, InlineFrame *inlineFrame);
+void freeInlineActionFlowState(FlowState *flowState);
+#endif
 FlowState *initPageFlowState(Assets *assets, int flowIndex, FlowState *parentFlowState, int parentComponentIndex);
 void incRefCounterForFlowState(FlowState *flowState);
 void decRefCounterForFlowState(FlowState *flowState);
 bool canFreeFlowState(FlowState *flowState);
 void freeFlowState(FlowState *flowState);
 void freeAllChildrenFlowStates(FlowState *flowState);
+void scheduleFlowStateDeletion(FlowState *flowState);
+void cancelFlowStateDeletion(FlowState *flowState);
+void freeFlowStatesScheduledForDeletion();
 void deallocateComponentExecutionState(FlowState *flowState, unsigned componentIndex);
 extern void onComponentExecutionStateChanged(FlowState *flowState, int componentIndex);
 template<class T>
@@ -1976,14 +2093,16 @@ void clearInputValue(FlowState *flowState, int inputIndex);
 void startAsyncExecution(FlowState *flowState, int componentIndex);
 void endAsyncExecution(FlowState *flowState, int componentIndex);
 void executeCallAction(FlowState *flowState, unsigned componentIndex, int flowIndex, const Value& value);
-extern FlowState *g_executeActionFlowState;
-extern unsigned g_executeActionComponentIndex;
 enum FlowEvent {
     FLOW_EVENT_OPEN_PAGE,
     FLOW_EVENT_CLOSE_PAGE,
     FLOW_EVENT_KEYDOWN
 };
 void onEvent(FlowState *flowState, FlowEvent flowEvent, Value eventValue);
+void propagateValueCoalesced(FlowState *flowState, unsigned componentIndex, unsigned outputIndex, const Value &value, uint32_t eventCode);
+void flushCoalescedEvents();
+void removeCoalescedEventsForFlowState(FlowState *flowState);
+void resetCoalescedEvents();
 enum FlowErrorType {
     FLOW_ERROR_PLAIN,
     FLOW_ERROR_PROPERTY,
@@ -2086,6 +2205,7 @@ typedef void (*ExecuteComponentFunctionType)(FlowState *flowState, unsigned comp
 void registerComponent(ComponentTypes componentType, ExecuteComponentFunctionType executeComponentFunction);
 void executeComponent(FlowState *flowState, unsigned componentIndex);
 bool hasExecFunc(FlowState *flowState, unsigned componentIndex);
+bool isValidComponentType(uint16_t componentType);
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -2124,18 +2244,37 @@ Date localToUtc(Date local);
 // -----------------------------------------------------------------------------
 namespace eez {
 namespace flow {
-extern bool g_debuggerIsConnected;
 enum {
     DEBUGGER_MODE_RUN,
     DEBUGGER_MODE_DEBUG,
 };
-extern int g_debuggerMode;
+enum DebuggerState {
+    DEBUGGER_STATE_RESUMED,
+    DEBUGGER_STATE_PAUSED,
+    DEBUGGER_STATE_SINGLE_STEP,
+    DEBUGGER_STATE_STOPPED,
+};
+enum LogItemType {
+	LOG_ITEM_TYPE_FATAL,
+	LOG_ITEM_TYPE_ERROR,
+    LOG_ITEM_TYPE_WARNING ,
+    LOG_ITEM_TYPE_SCPI,
+    LOG_ITEM_TYPE_INFO,
+    LOG_ITEM_TYPE_DEBUG
+};
 bool canExecuteStep(FlowState *&flowState, unsigned &componentIndex);
+void initBreakpoints(Assets *assets);
+void freeBreakpoints();
+uint32_t *getFlowBreakpoints(Assets *assets, int flowIndex);
 void onStarted(Assets *assets);
 void onStopped();
-void onAddToQueue(FlowState *flowState, int sourceComponentIndex, int sourceOutputIndex, unsigned targetComponentIndex, int targetInputIndex);
+bool onAddToQueue(FlowState *flowState, int sourceComponentIndex, int sourceOutputIndex, unsigned targetComponentIndex, int targetInputIndex);
 void onRemoveFromQueue();
+void flushDebuggerSamples();
+void notifyDebuggerOutput();
+void notifyLog();
 void onValueChanged(const Value *pValue);
+void onValueChanged(FlowState *flowState, const Value *pValue);
 void onFlowStateCreated(FlowState *flowState);
 void onFlowStateDestroyed(FlowState *flowState);
 void onFlowStateTimelineChanged(FlowState *flowState);
@@ -2209,6 +2348,10 @@ struct FlowState;
 unsigned start(Assets *assets);
 void tick();
 void stop(Assets* assets = nullptr);
+bool hotSwapAssets(const uint8_t *assets, uint32_t assetsSize);
+bool loadTranslations(Assets *assets);
+void resetTranslations();
+void releaseUnusedTranslations();
 bool isFlowStopped();
 unsigned getTickMaxDurationCounter();
 FlowState *getPageFlowState(Assets *assets, int16_t pageIndex);
@@ -2229,7 +2372,21 @@ AsyncAction *beginAsyncExecution();
 void endAsyncExecution(AsyncAction *asyncAction);
 Value getUserPropertyAsync(AsyncAction *asyncAction, unsigned propertyIndex);
 void setUserPropertyAsync(AsyncAction *asyncAction, unsigned propertyIndex, const Value &value);
+#if EEZ_OPTION_THREADS
+struct RuntimeContext;
+bool postEndAsyncExecution(AsyncAction *asyncAction, RuntimeContext *runtimeContext);
+bool postEndAsyncExecution(FlowState *flowState, int componentIndex, RuntimeContext *runtimeContext);
+bool postPropagateValue(FlowState *flowState, unsigned componentIndex, unsigned outputIndex, const Value &value, RuntimeContext *runtimeContext);
+bool postSetGlobalVariable(uint32_t globalVariableIndex, const Value &value, RuntimeContext *runtimeContext);
+#endif
 void setDebuggerMessageSubsciptionFilter(uint32_t filter);
+uint32_t peekDebuggerOutput(const char *&span1, uint32_t &length1, const char *&span2, uint32_t &length2);
+void consumeDebuggerOutput(uint32_t length);
+void drainDebuggerOutput();
+void setLogLevel(uint8_t logLevel);
+void drainLog();
+bool addDebuggerFlowSubscriptionFilter(int16_t flowIndex, uint16_t firstComponentIndex = 0, uint16_t lastComponentIndex = 0xFFFF);
+void clearDebuggerFlowSubscriptionFilters();
 void onDebuggerClientConnected();
 void onDebuggerClientDisconnected();
 void onArrayValueFree(ArrayValue *arrayValue);
@@ -2253,6 +2410,8 @@ extern void (*scpiComponentInitHook)();
 extern void (*startToDebuggerMessageHook)();
 extern void (*writeDebuggerBufferHook)(const char *buffer, uint32_t length);
 extern void (*finishToDebuggerMessageHook)();
+extern void (*debuggerOutputAvailableHook)();
+extern void (*logAvailableHook)();
 extern void (*onDebuggerInputAvailableHook)();
 extern lv_obj_t *(*getLvglObjectFromIndexHook)(int32_t index);
 extern lv_group_t *(*getLvglGroupFromIndexHook)(int32_t index);
@@ -2269,6 +2428,10 @@ extern void (*lvglObjRemoveStyleHook)(lv_obj_t *object, int32_t styleIndex);
 extern void (*lvglSetColorThemeHook)(const char *themeName);
 extern double (*getDateNowHook)();
 extern void (*onFlowErrorHook)(FlowState *flowState, int componentIndex, const char *errorMessage);
+extern void (*getNativeVarsBatchHook)();
+#if EEZ_FLOW_TRACE
+extern uint32_t (*getTraceTimestampHook)();
+#endif
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -2278,6 +2441,7 @@ namespace eez {
 namespace flow {
 typedef void (*EvalOperation)(EvalStack &);
 extern EvalOperation g_evalOperations[];
+extern const uint32_t g_numEvalOperations;
 Value op_add(const Value& a1, const Value& b1);
 Value op_sub(const Value& a1, const Value& b1);
 Value op_mul(const Value& a1, const Value& b1);
@@ -2304,7 +2468,6 @@ namespace flow {
 void queueReset();
 size_t getQueueSize();
 size_t getMaxQueueSize();
-extern unsigned g_numNonContinuousTaskInQueue;
 bool addToQueue(FlowState *flowState, unsigned componentIndex,
     int sourceComponentIndex, int sourceOutputIndex, int targetInputIndex,
     bool continuousTask);
@@ -2326,6 +2489,350 @@ void visitWatchList();
 void watchListReset();
 void removeWatchesForFlowState(FlowState *flowState);
 unsigned getWatchListSize();
+void markWatchesDirtyForGlobalVariable(uint32_t globalVariableIndex);
+void markWatchesDirtyForValue(FlowState *flowState, const Value *pValue);
+} 
+} 
+// -----------------------------------------------------------------------------
+// flow/inbound_queue.h
+// -----------------------------------------------------------------------------
+#if EEZ_OPTION_THREADS
+#include <atomic>
+#endif
+#if !defined(EEZ_FLOW_INBOUND_QUEUE_SIZE)
+#define EEZ_FLOW_INBOUND_QUEUE_SIZE 64
+#endif
+namespace eez {
+namespace flow {
+#if EEZ_OPTION_THREADS
+static const uint32_t INBOUND_QUEUE_SIZE = EEZ_FLOW_INBOUND_QUEUE_SIZE;
+static_assert((INBOUND_QUEUE_SIZE & (INBOUND_QUEUE_SIZE - 1)) == 0, "EEZ_FLOW_INBOUND_QUEUE_SIZE must be a power of two");
+enum InboundEventType {
+    INBOUND_EVENT_END_ASYNC_ACTION,
+    INBOUND_EVENT_END_ASYNC_EXECUTION,
+    INBOUND_EVENT_PROPAGATE_VALUE,
+    INBOUND_EVENT_SET_GLOBAL_VARIABLE,
+    INBOUND_EVENT_CANCELLED
+};
+struct InboundEvent {
+    std::atomic<uint32_t> sequence;
+    InboundEventType type;
+    AsyncAction *asyncAction;
+    FlowState *flowState;
+    unsigned componentIndex;
+    unsigned outputIndex;
+    Value value;
+};
+struct InboundQueue {
+    InboundEvent events[INBOUND_QUEUE_SIZE];
+    std::atomic<uint32_t> enqueuePosition;
+    uint32_t dequeuePosition;
+};
+void inboundQueueInit(InboundQueue &inboundQueue);
+void inboundQueueReset();
+void removeInboundEventsForFlowState(FlowState *flowState);
+void drainInboundQueue();
+#endif
+} 
+} 
+// -----------------------------------------------------------------------------
+// flow/snapshot.h
+// -----------------------------------------------------------------------------
+namespace eez {
+namespace flow {
+#if EEZ_FLOW_SNAPSHOT
+static const uint32_t SNAPSHOT_MAGIC = 0x4E535A45;
+static const uint16_t SNAPSHOT_VERSION = 2;
+struct SnapshotWriter {
+    uint8_t *buffer;
+    uint32_t bufferSize;
+    uint32_t position;
+    void write(const void *data, uint32_t size);
+    void writeUint8(uint8_t value) { write(&value, sizeof(value)); }
+    void writeUint32(uint32_t value) { write(&value, sizeof(value)); }
+    void patchUint32(uint32_t atPosition, uint32_t value);
+    void writeValue(const Value &value);
+};
+struct SnapshotReader {
+    const uint8_t *buffer;
+    uint32_t bufferSize;
+    uint32_t position;
+    bool construct;
+    bool error;
+    const uint8_t *read(uint32_t size);
+    uint8_t readUint8();
+    uint32_t readUint32();
+    void readValue(Value &value);
+};
+uint32_t getSnapshotSize();
+uint32_t saveSnapshot(uint8_t *buffer, uint32_t bufferSize);
+bool restoreSnapshot(const uint8_t *buffer, uint32_t bufferSize);
+bool restoreComponentExecutionState(FlowState *flowState, unsigned componentIndex, SnapshotReader &reader);
+#endif
+} 
+} 
+// -----------------------------------------------------------------------------
+// flow/trace.h
+// -----------------------------------------------------------------------------
+#if !defined(EEZ_FLOW_TRACE_BUFFER_SIZE)
+#define EEZ_FLOW_TRACE_BUFFER_SIZE 512
+#endif
+namespace eez {
+namespace flow {
+#if EEZ_FLOW_TRACE
+static const uint32_t TRACE_BUFFER_SIZE = EEZ_FLOW_TRACE_BUFFER_SIZE;
+static_assert((TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) == 0, "EEZ_FLOW_TRACE_BUFFER_SIZE must be a power of two");
+static const uint32_t TRACE_DUMP_MAGIC = 0x52545A45;
+static const uint16_t TRACE_DUMP_VERSION = 2;
+enum TraceEventType {
+    TRACE_EVENT_TICK_START,
+    TRACE_EVENT_TICK_END,
+    TRACE_EVENT_TASK_START,
+    TRACE_EVENT_TASK_END,
+    TRACE_EVENT_ADD_TO_QUEUE,
+    TRACE_EVENT_ERROR
+};
+struct TraceEvent {
+    uint32_t timestamp;
+    uint32_t flowStateIndex;
+    uint16_t componentIndex;
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t queueDepth;
+    uint16_t reserved2;
+    uint32_t data;
+};
+static_assert(sizeof(TraceEvent) == 20, "TraceEvent must be 20 bytes");
+struct TraceDumpHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t eventSize;
+    uint32_t timestampFrequency;
+    uint32_t numEvents;
+    uint32_t numDroppedEvents;
+};
+void startTrace(uint32_t timestampFrequency = 1000);
+void stopTrace();
+bool isTraceEnabled();
+uint32_t getTraceDumpSize();
+uint32_t dumpTrace(uint8_t *buffer, uint32_t bufferSize);
+void traceEvent(TraceEventType type, FlowState *flowState, int componentIndex, uint32_t data);
+#define EEZ_FLOW_TRACE_EVENT(type, flowState, componentIndex, data) \
+    do { \
+        if (g_runtimeContext->traceEnabled) { \
+            traceEvent(type, flowState, componentIndex, data); \
+        } \
+    } while (0)
+#else
+#define EEZ_FLOW_TRACE_EVENT(type, flowState, componentIndex, data) do {} while (0)
+#endif
+} 
+} 
+// -----------------------------------------------------------------------------
+// flow/runtime_context.h
+// -----------------------------------------------------------------------------
+#include <atomic>
+#if EEZ_FLOW_MULTI_INSTANCE
+#define EEZ_FLOW_THREAD_LOCAL thread_local
+#else
+#define EEZ_FLOW_THREAD_LOCAL
+#endif
+#if !defined(EEZ_FLOW_QUEUE_SIZE)
+#define EEZ_FLOW_QUEUE_SIZE 1000
+#endif
+#if !defined(EEZ_FLOW_DEBUGGER_OUTPUT_BUFFER_SIZE)
+#if defined(__EMSCRIPTEN__)
+#define EEZ_FLOW_DEBUGGER_OUTPUT_BUFFER_SIZE (1024 * 1024)
+#else
+#define EEZ_FLOW_DEBUGGER_OUTPUT_BUFFER_SIZE 4096
+#endif
+#endif
+static_assert((EEZ_FLOW_DEBUGGER_OUTPUT_BUFFER_SIZE & (EEZ_FLOW_DEBUGGER_OUTPUT_BUFFER_SIZE - 1)) == 0, "EEZ_FLOW_DEBUGGER_OUTPUT_BUFFER_SIZE must be a power of two");
+#if !defined(EEZ_FLOW_LOG_BUFFER_SIZE)
+#if defined(__EMSCRIPTEN__)
+#define EEZ_FLOW_LOG_BUFFER_SIZE (64 * 1024)
+#else
+#define EEZ_FLOW_LOG_BUFFER_SIZE 2048
+#endif
+#endif
+static_assert((EEZ_FLOW_LOG_BUFFER_SIZE & (EEZ_FLOW_LOG_BUFFER_SIZE - 1)) == 0, "EEZ_FLOW_LOG_BUFFER_SIZE must be a power of two");
+#if !defined(EEZ_FLOW_LOG_MAX_MESSAGE_LENGTH)
+#define EEZ_FLOW_LOG_MAX_MESSAGE_LENGTH 0xFFFF
+#endif
+static_assert(EEZ_FLOW_LOG_MAX_MESSAGE_LENGTH <= 0xFFFF, "EEZ_FLOW_LOG_MAX_MESSAGE_LENGTH must fit in 16 bits");
+#if !defined(EEZ_FLOW_COALESCED_EVENTS_SIZE)
+#define EEZ_FLOW_COALESCED_EVENTS_SIZE 16
+#endif
+#if !defined(EEZ_FLOW_NATIVE_VAR_CACHE_SIZE)
+#define EEZ_FLOW_NATIVE_VAR_CACHE_SIZE 16
+#endif
+#if !defined(EEZ_FLOW_NATIVE_VAR_WRITES_SIZE)
+#define EEZ_FLOW_NATIVE_VAR_WRITES_SIZE 8
+#endif
+#if !defined(EEZ_FLOW_DEBUGGER_RATE_LIMITS_SIZE)
+#define EEZ_FLOW_DEBUGGER_RATE_LIMITS_SIZE 8
+#endif
+#if !defined(EEZ_FLOW_DEBUGGER_SAMPLES_SIZE)
+#define EEZ_FLOW_DEBUGGER_SAMPLES_SIZE 32
+#endif
+#if !defined(EEZ_FLOW_DEBUGGER_FLOW_FILTERS_SIZE)
+#define EEZ_FLOW_DEBUGGER_FLOW_FILTERS_SIZE 8
+#endif
+#if !defined(EEZ_FLOW_INLINE_FRAME_ARENA_SIZE)
+#define EEZ_FLOW_INLINE_FRAME_ARENA_SIZE 2048
+#endif
+#if !defined(EEZ_FLOW_INLINE_QUEUE_SIZE)
+#define EEZ_FLOW_INLINE_QUEUE_SIZE 32
+#endif
+namespace eez {
+namespace flow {
+static const unsigned QUEUE_SIZE = EEZ_FLOW_QUEUE_SIZE;
+struct QueueTask {
+	FlowState *flowState;
+	unsigned componentIndex;
+    bool continuousTask;
+    bool debuggerNotified;
+};
+struct WatchList {
+    WatchListNode *first;
+    WatchListNode *last;
+    unsigned       size;
+    unsigned       numAlwaysVisited;
+    uint32_t       dirtyMask;
+};
+struct NativeVarCacheEntry {
+    int16_t id;
+    uint32_t epoch;
+    Value value;
+};
+struct NativeVarWrite {
+    int16_t id;
+    Value value;
+};
+struct DebuggerFlowFilter {
+    int16_t flowIndex;
+    uint16_t firstComponentIndex;
+    uint16_t lastComponentIndex;
+};
+struct DebuggerRateLimit {
+    int32_t flowIndex;
+    uint32_t index;
+    uint32_t intervalMs;
+};
+struct DebuggerSample {
+    const void *key;
+    uint32_t index;
+    uint32_t intervalMs;
+    uint32_t lastSentTime;
+    bool pending;
+};
+struct CoalescedEvent {
+    FlowState *flowState;
+    uint16_t componentIndex;
+    uint16_t outputIndex;
+    uint32_t eventCode;
+    Value value;
+};
+struct RuntimeContext {
+    Assets *loadedAssets;
+    uint8_t *loadedAssetsMemory;
+    bool loadedAssetsAreMutable;
+#if EEZ_FLOW_SNAPSHOT
+    uint32_t loadedAssetsCrc32;
+#endif
+    LazyAssetsSection lazyAssetsSections[EEZ_MAX_LAZY_ASSETS_SECTIONS];
+    uint32_t numLazyAssetsSections;
+    Assets *releasedAssets;
+    uint8_t *releasedAssetsMemory;
+    Assets *mainAssets;
+    uint8_t *mainAssetsMemory;
+    Assets *pendingAssets;
+    uint8_t *pendingAssetsMemory;
+    Assets *previousAssets;
+    uint8_t *previousAssetsMemory;
+#if EEZ_FLOW_SNAPSHOT
+    uint32_t mainAssetsCrc32;
+    uint32_t pendingAssetsCrc32;
+#endif
+    FlowState *firstFlowState;
+    FlowState *lastFlowState;
+    FlowState *firstFlowStateScheduledForDeletion;
+    GlobalVariables *globalVariables;
+    int selectedLanguage;
+    Assets *translationsAssets;
+    Value translations;
+    bool isStopping;
+    bool skipStartActions;
+    bool skipComponentPings;
+    bool isStopped;
+    unsigned tickMaxDurationCount;
+    bool enableThrowError;
+    FlowState *executeActionFlowState;
+    unsigned executeActionComponentIndex;
+    EvalStack stack;
+    QueueTask queue[QUEUE_SIZE];
+    unsigned queueHead;
+    unsigned queueTail;
+    unsigned queueMax;
+    bool queueIsFull;
+    unsigned numNonContinuousTaskInQueue;
+    WatchList watchList;
+    CoalescedEvent coalescedEvents[EEZ_FLOW_COALESCED_EVENTS_SIZE];
+    unsigned numCoalescedEvents;
+    NativeVarCacheEntry nativeVarCache[EEZ_FLOW_NATIVE_VAR_CACHE_SIZE];
+    uint32_t nativeVarCacheEpoch;
+    bool nativeVarsBatchFetched;
+    NativeVarWrite nativeVarWrites[EEZ_FLOW_NATIVE_VAR_WRITES_SIZE];
+    unsigned numNativeVarWrites;
+    bool debuggerIsConnected;
+    uint32_t messageSubsciptionFilter;
+    DebuggerFlowFilter debuggerFlowFilters[EEZ_FLOW_DEBUGGER_FLOW_FILTERS_SIZE];
+    unsigned numDebuggerFlowFilters;
+    DebuggerState debuggerState;
+    bool skipNextBreakpoint;
+    bool stepGateArmed;
+    uint32_t *breakpoints;
+    uint32_t numArmedBreakpoints;
+    char inputFromDebugger[64];
+    unsigned inputFromDebuggerPosition;
+    int debuggerMode;
+#if EEZ_FLOW_TRACE
+    bool traceEnabled;
+    uint32_t traceTimestampFrequency;
+    uint32_t traceHead;
+    TraceEvent traceEvents[TRACE_BUFFER_SIZE];
+#endif
+    char outputBuffer[EEZ_FLOW_DEBUGGER_OUTPUT_BUFFER_SIZE];
+    std::atomic<uint32_t> outputBufferHead;
+    std::atomic<uint32_t> outputBufferTail;
+    uint32_t outputBufferWritePosition;
+    char logBuffer[EEZ_FLOW_LOG_BUFFER_SIZE];
+    uint32_t logBufferHead;
+    uint32_t logBufferTail;
+    uint32_t numPendingFlowStateDestroyedRecords;
+    uint8_t logLevel;
+    uint32_t debuggerValueRateLimit;
+    uint32_t debuggerComponentRateLimit;
+    DebuggerRateLimit debuggerRateLimits[EEZ_FLOW_DEBUGGER_RATE_LIMITS_SIZE];
+    unsigned numDebuggerRateLimits;
+    DebuggerSample debuggerSamples[EEZ_FLOW_DEBUGGER_SAMPLES_SIZE];
+    unsigned numPendingDebuggerSamples;
+    void *(*allocHook)(size_t size, uint32_t id);
+    void (*freeHook)(void *ptr);
+#if EEZ_OPTION_THREADS
+    InboundQueue inboundQueue;
+#endif
+#if EEZ_FLOW_INLINE_ACTIONS
+    uint8_t *inlinableActionFlows;
+    alignas(8) uint8_t inlineFrameArena[EEZ_FLOW_INLINE_FRAME_ARENA_SIZE];
+    uint32_t inlineFrameArenaPosition;
+#endif
+};
+extern EEZ_FLOW_THREAD_LOCAL RuntimeContext *g_runtimeContext;
+RuntimeContext *createRuntimeContext(void *(*allocHook)(size_t size, uint32_t id) = nullptr, void (*freeHook)(void *ptr) = nullptr);
+void destroyRuntimeContext(RuntimeContext *runtimeContext);
+void setRuntimeContext(RuntimeContext *runtimeContext);
+RuntimeContext *getRuntimeContext();
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -2338,6 +2845,19 @@ struct CallActionActionComponent : public Component {
 	uint8_t inputsStartIndex;
 	uint8_t outputsStartIndex;
 };
+#if EEZ_FLOW_INLINE_ACTIONS
+struct InlineFrame {
+    uint16_t *tasks;
+    unsigned capacity;
+    unsigned head;
+    unsigned tail;
+    bool isFull;
+    uint16_t inlineTasks[EEZ_FLOW_INLINE_QUEUE_SIZE];
+};
+void classifyInlinableActionFlows(Assets *assets);
+void freeInlinableActionFlows();
+bool addToInlineFrame(FlowState *flowState, unsigned componentIndex);
+#endif
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -2350,6 +2870,11 @@ struct InputActionComponent : public Component {
 };
 struct InputActionComponentExecutionState : public ComponenentExecutionState {
 	Value value;
+    bool canMigrate() override { return true; }
+    void migrate() override { value = value.clone(); }
+#if EEZ_FLOW_SNAPSHOT
+    bool saveSnapshot(SnapshotWriter &writer) override;
+#endif
 };
 bool getCallActionValue(FlowState *flowState, unsigned componentIndex, Value &value);
 } 
@@ -2460,6 +2985,7 @@ namespace eez {
 namespace flow {
 struct LVGLUserWidgetExecutionState : public ComponenentExecutionState {
     FlowState *flowState;
+    bool canMigrate() override { return true; }
     ~LVGLUserWidgetExecutionState() {
         freeFlowState(flowState);
     }
@@ -2569,10 +3095,13 @@ typedef enum {
     NATIVE_VAR_TYPE_DOUBLE,
     NATIVE_VAR_TYPE_STRING,
 } NativeVarType;
+#define NATIVE_VAR_FLAG_TICK_STABLE (1 << 0)
+#define NATIVE_VAR_FLAG_COALESCE_WRITES (1 << 1)
 typedef struct _native_var_t {
     NativeVarType type;
     void *get;
     void *set;
+    uint32_t flags;
 } native_var_t;
 #ifdef __cplusplus
 extern "C" {
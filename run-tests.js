@@ -0,0 +1,20 @@
+const path = require("path");
+const { spawnSync } = require("child_process");
+
+// compiled tests import project modules by their "project-editor/..." path,
+// wasm helpers (e.g. lz4.js) are loaded straight from the packages folder
+const env = {
+    ...process.env,
+    NODE_PATH: [
+        path.join(__dirname, "build-test"),
+        path.join(__dirname, "packages")
+    ].join(path.delimiter)
+};
+
+const result = spawnSync(
+    process.execPath,
+    ["--test", path.join(__dirname, "build-test")],
+    { env, stdio: "inherit" }
+);
+
+process.exit(result.status ?? 1);